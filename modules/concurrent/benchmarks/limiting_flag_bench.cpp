@@ -0,0 +1,133 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <mutex>
+#include <simcoe/concurrent/keyed_limiter.hpp>
+#include <simcoe/concurrent/limiting_flag.hpp>
+#include <unordered_map>
+
+namespace {
+using namespace std::chrono_literals;
+
+sm::concurrent::AtMostEvery gFlag{1ms};
+
+/**
+ * @brief Every thread polls the same flag, the usual result is that the flag is not active.
+ */
+void BM_AtMostEveryIsActive(benchmark::State& state) {
+    size_t activations = 0;
+    for (auto _ : state) {
+        if (gFlag.isActive()) {
+            activations += 1;
+        }
+    }
+
+    state.counters["activations"] = benchmark::Counter(static_cast<double>(activations), benchmark::Counter::kIsRate);
+}
+
+template <typename Clock>
+sm::concurrent::BasicAtMostEvery<Clock> gClockFlag{1ms};
+
+/**
+ * @brief The same as BM_AtMostEveryIsActive with the given clock policy.
+ */
+template <typename Clock>
+void BM_BasicAtMostEveryIsActive(benchmark::State& state) {
+    auto& flag = gClockFlag<Clock>;
+
+    size_t activations = 0;
+    for (auto _ : state) {
+        if (flag.isActive()) {
+            activations += 1;
+        }
+    }
+
+    state.counters["activations"] = benchmark::Counter(static_cast<double>(activations), benchmark::Counter::kIsRate);
+}
+
+sm::concurrent::FrameCounter gFrameCounter;
+sm::concurrent::BasicAtMostEvery<sm::concurrent::FrameClock> gFrameFlag{1ms, sm::concurrent::FrameClock{gFrameCounter, 1ms}};
+
+void BM_FrameClockIsActive(benchmark::State& state) {
+    size_t activations = 0;
+    for (auto _ : state) {
+        if (gFrameFlag.isActive()) {
+            activations += 1;
+        }
+    }
+
+    state.counters["activations"] = benchmark::Counter(static_cast<double>(activations), benchmark::Counter::kIsRate);
+}
+
+sm::concurrent::TokenBucket gBucket{1000, 1s, 100};
+
+/**
+ * @brief Every thread polls the same token bucket.
+ */
+void BM_TokenBucketIsActive(benchmark::State& state) {
+    size_t activations = 0;
+    for (auto _ : state) {
+        if (gBucket.isActive()) {
+            activations += 1;
+        }
+    }
+
+    state.counters["activations"] = benchmark::Counter(static_cast<double>(activations), benchmark::Counter::kIsRate);
+}
+
+constexpr uint64_t kKeyCount = 64;
+
+sm::concurrent::KeyedLimiter<1024> gKeyedLimiter{1ms};
+
+/**
+ * @brief Every thread polls a rotating set of keys in the same table.
+ */
+void BM_KeyedLimiterIsActive(benchmark::State& state) {
+    size_t activations = 0;
+    uint64_t key = static_cast<uint64_t>(state.thread_index());
+    for (auto _ : state) {
+        if (gKeyedLimiter.isActive(key++ % kKeyCount)) {
+            activations += 1;
+        }
+    }
+
+    state.counters["activations"] = benchmark::Counter(static_cast<double>(activations), benchmark::Counter::kIsRate);
+}
+
+std::mutex gMapMutex;
+std::unordered_map<uint64_t, std::unique_ptr<sm::concurrent::AtMostEvery>> gMapLimiter;
+
+/**
+ * @brief The same as BM_KeyedLimiterIsActive with a map of flags behind a mutex.
+ */
+void BM_MutexMapIsActive(benchmark::State& state) {
+    size_t activations = 0;
+    uint64_t key = static_cast<uint64_t>(state.thread_index());
+    for (auto _ : state) {
+        std::lock_guard guard(gMapMutex);
+        auto& flag = gMapLimiter[key++ % kKeyCount];
+        if (flag == nullptr) {
+            flag = std::make_unique<sm::concurrent::AtMostEvery>(1ms);
+        }
+
+        if (flag->isActive()) {
+            activations += 1;
+        }
+    }
+
+    state.counters["activations"] = benchmark::Counter(static_cast<double>(activations), benchmark::Counter::kIsRate);
+}
+} // namespace
+
+BENCHMARK(BM_AtMostEveryIsActive)->ThreadRange(1, 16)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_BasicAtMostEveryIsActive, sm::concurrent::HighResolutionClock)->ThreadRange(1, 16)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_BasicAtMostEveryIsActive, sm::concurrent::CoarseMonotonicClock)->ThreadRange(1, 16)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_BasicAtMostEveryIsActive, sm::concurrent::TscClock)->ThreadRange(1, 16)->UseRealTime();
+BENCHMARK(BM_FrameClockIsActive)->ThreadRange(1, 16)->UseRealTime();
+BENCHMARK(BM_TokenBucketIsActive)->ThreadRange(1, 32)->UseRealTime();
+BENCHMARK(BM_KeyedLimiterIsActive)->ThreadRange(1, 32)->UseRealTime();
+BENCHMARK(BM_MutexMapIsActive)->ThreadRange(1, 32)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,160 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <memory>
+#include <mutex>
+#include <simcoe/concurrent/mailbox.hpp>
+
+namespace {
+using Payload = std::array<uint64_t, 4>;
+
+template <typename Layout>
+sm::concurrent::AtomicMailbox<Payload, Layout> gMailbox;
+
+// The writer can be waiting for one more unlock when the reader runs out of iterations,
+// so the reader keeps reading until the writer has finished.
+std::atomic<bool> gWriterDone{false};
+
+/**
+ * @brief Thread 0 reads while thread 1 writes, measuring the cost of sharing the mailbox across cores.
+ */
+template <typename Layout>
+void BM_MailboxCrossCore(benchmark::State& state) {
+    auto& mailbox = gMailbox<Layout>;
+
+    if (state.thread_index() == 0) {
+        for (auto _ : state) {
+            std::lock_guard guard(mailbox);
+            benchmark::DoNotOptimize(mailbox.read());
+        }
+
+        while (!gWriterDone.exchange(false)) {
+            std::lock_guard guard(mailbox);
+            benchmark::DoNotOptimize(mailbox.read());
+        }
+    } else {
+        Payload payload{};
+        for (auto _ : state) {
+            payload[0] += 1;
+            mailbox.write(payload);
+        }
+
+        gWriterDone.store(true);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+template <typename Layout>
+sm::concurrent::TripleBufferMailbox<Payload, Layout> gTripleBufferMailbox;
+
+/**
+ * @brief The same as BM_MailboxCrossCore for the triple buffered mailbox, neither side ever waits.
+ */
+template <typename Layout>
+void BM_TripleBufferCrossCore(benchmark::State& state) {
+    auto& mailbox = gTripleBufferMailbox<Layout>;
+
+    if (state.thread_index() == 0) {
+        for (auto _ : state) {
+            std::lock_guard guard(mailbox);
+            benchmark::DoNotOptimize(mailbox.read());
+        }
+    } else {
+        Payload payload{};
+        for (auto _ : state) {
+            payload[0] += 1;
+            mailbox.write(payload);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+sm::concurrent::BroadcastMailbox<Payload> gBroadcastMailbox;
+
+/**
+ * @brief Thread 0 writes while every other thread reads the same mailbox.
+ */
+void BM_BroadcastReaders(benchmark::State& state) {
+    auto& mailbox = gBroadcastMailbox;
+
+    if (state.thread_index() == 0) {
+        Payload payload{};
+        for (auto _ : state) {
+            payload[0] += 1;
+            mailbox.write(payload);
+        }
+    } else {
+        Payload payload{};
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(mailbox.read(payload));
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+/**
+ * @brief A write followed by a read on a single thread, the cost of the mailbox without contention.
+ */
+void BM_MailboxRoundTrip(benchmark::State& state) {
+    sm::concurrent::AtomicMailbox<Payload> mailbox;
+
+    Payload payload{};
+    for (auto _ : state) {
+        payload[0] += 1;
+        mailbox.write(payload);
+
+        std::lock_guard guard(mailbox);
+        benchmark::DoNotOptimize(mailbox.read());
+    }
+}
+
+using Frame = std::array<uint64_t, 0x2000>;
+
+/**
+ * @brief Building a 64KB frame and writing it by value.
+ */
+void BM_MailboxLargeWrite(benchmark::State& state) {
+    auto mailbox = std::make_unique<sm::concurrent::AtomicMailbox<Frame>>();
+
+    uint64_t next = 0;
+    for (auto _ : state) {
+        Frame frame;
+        frame.fill(next++);
+        mailbox->write(frame);
+
+        std::lock_guard guard(*mailbox);
+        benchmark::DoNotOptimize(mailbox->read()[0]);
+    }
+}
+
+/**
+ * @brief Filling a 64KB frame directly in the back slot.
+ */
+void BM_MailboxLargeWriteInPlace(benchmark::State& state) {
+    auto mailbox = std::make_unique<sm::concurrent::AtomicMailbox<Frame>>();
+
+    uint64_t next = 0;
+    for (auto _ : state) {
+        mailbox->writeInPlace([&](Frame& frame) noexcept { frame.fill(next++); });
+
+        std::lock_guard guard(*mailbox);
+        benchmark::DoNotOptimize(mailbox->read()[0]);
+    }
+}
+} // namespace
+
+BENCHMARK(BM_MailboxRoundTrip);
+BENCHMARK(BM_MailboxLargeWrite);
+BENCHMARK(BM_MailboxLargeWriteInPlace);
+BENCHMARK_TEMPLATE(BM_MailboxCrossCore, sm::concurrent::CompactLayout)->Threads(2)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_MailboxCrossCore, sm::concurrent::CacheAlignedLayout)->Threads(2)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_TripleBufferCrossCore, sm::concurrent::CompactLayout)->Threads(2)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_TripleBufferCrossCore, sm::concurrent::CacheAlignedLayout)->Threads(2)->UseRealTime();
+BENCHMARK(BM_BroadcastReaders)->ThreadRange(2, 16)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,588 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <simcoe/concurrent/inline_ring_buffer.hpp>
+#include <simcoe/concurrent/latency_histogram.hpp>
+#include <simcoe/concurrent/lossy_ring_buffer.hpp>
+#include <simcoe/concurrent/mpmc_ring_buffer.hpp>
+#include <simcoe/concurrent/page_allocator.hpp>
+#include <simcoe/concurrent/ring_buffer.hpp>
+#include <simcoe/concurrent/segmented_queue.hpp>
+#include <simcoe/concurrent/sharded_ring_buffer.hpp>
+#include <simcoe/concurrent/spsc_ring_buffer.hpp>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace detail = sm::concurrent::detail;
+
+namespace {
+constexpr size_t kBitsetCapacity = 0x10000;
+
+/**
+ * @brief A bitset shared by every thread of a benchmark run.
+ *
+ * The first @p fillPercent of the bitset is allocated up front, which is the worst case
+ * for a scan that always starts from the first word.
+ */
+struct SharedBitset {
+    std::unique_ptr<std::atomic<uint64_t>[]> bits;
+    std::unique_ptr<std::atomic<uint64_t>[]> summary;
+
+    void reset(size_t capacity, size_t fillPercent) {
+        size_t words = detail::requiredBitsetSize(capacity);
+        size_t summaryWords = detail::requiredSummarySize(capacity);
+
+        bits = std::make_unique<std::atomic<uint64_t>[]>(words);
+        summary = std::make_unique<std::atomic<uint64_t>[]>(summaryWords);
+        std::uninitialized_fill_n(bits.get(), words, 0);
+        std::uninitialized_fill_n(summary.get(), summaryWords, 0);
+
+        size_t filled = capacity * fillPercent / 100;
+        for (size_t i = 0; i < filled; i++) {
+            bits[i / detail::kBitsPerWord] |= uint64_t{1} << (i % detail::kBitsPerWord);
+        }
+
+        for (size_t word = 0; word < words; word++) {
+            if (bits[word].load() == detail::validWordMask(capacity, word)) {
+                detail::markWordFull(summary.get(), word);
+            }
+        }
+    }
+};
+
+SharedBitset gBitset;
+
+void BM_BitsetAllocateLinear(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        gBitset.reset(kBitsetCapacity, state.range(0));
+    }
+
+    for (auto _ : state) {
+        size_t index = detail::atomicScanAndSet(gBitset.bits.get(), kBitsetCapacity);
+        benchmark::DoNotOptimize(index);
+        if (index != (std::numeric_limits<size_t>::max)()) {
+            detail::atomicClearBit(gBitset.bits.get(), index);
+        }
+    }
+}
+
+void BM_BitsetAllocateHinted(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        gBitset.reset(kBitsetCapacity, state.range(0));
+    }
+
+    size_t hint = static_cast<size_t>(state.thread_index()) * 1021;
+    for (auto _ : state) {
+        size_t index = detail::atomicScanAndSet(gBitset.bits.get(), gBitset.summary.get(), kBitsetCapacity, hint++);
+        benchmark::DoNotOptimize(index);
+        if (index != (std::numeric_limits<size_t>::max)()) {
+            detail::atomicClearBit(gBitset.bits.get(), gBitset.summary.get(), kBitsetCapacity, index);
+        }
+    }
+}
+
+void BM_RingBufferPushPopFilled(benchmark::State& state) {
+    using Queue = sm::concurrent::RingBuffer<size_t>;
+    Queue queue = Queue::create(kBitsetCapacity).value();
+
+    size_t filled = kBitsetCapacity * state.range(0) / 100;
+    for (size_t i = 0; i < filled; i++) {
+        (void)queue.tryPush(i);
+    }
+
+    size_t value = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(queue.tryPush(value));
+        benchmark::DoNotOptimize(queue.tryPop(value));
+    }
+}
+
+template <typename Capacity>
+void BM_RingBufferPushPop(benchmark::State& state) {
+    using Queue = sm::concurrent::RingBuffer<size_t, std::allocator<size_t>, Capacity>;
+    Queue queue = Queue::create(static_cast<uint32_t>(state.range(0))).value();
+
+    size_t value = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(queue.tryPush(value));
+        benchmark::DoNotOptimize(queue.tryPop(value));
+    }
+}
+
+/**
+ * @brief The cost of recording counters on the uncontended push and pop path.
+ */
+template <typename Stats>
+void BM_RingBufferStatsPushPop(benchmark::State& state) {
+    using Queue = sm::concurrent::RingBuffer<size_t, std::allocator<size_t>, sm::concurrent::DynamicCapacity, sm::concurrent::CompactLayout, Stats>;
+    Queue queue = Queue::create(1024).value();
+
+    size_t value = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(queue.tryPush(value));
+        benchmark::DoNotOptimize(queue.tryPop(value));
+    }
+}
+
+template <typename Queue>
+void BM_PointerPushPop(benchmark::State& state) {
+    Queue queue = Queue::create(static_cast<uint32_t>(state.range(0))).value();
+
+    void* value = &queue;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(queue.tryPush(value));
+        benchmark::DoNotOptimize(queue.tryPop(value));
+    }
+}
+
+/**
+ * @brief Push and pop through a large queue that is kept half full, so every operation touches a different page.
+ */
+template <typename Allocator>
+void BM_RingBufferLargePushPop(benchmark::State& state) {
+    using Queue = sm::concurrent::RingBuffer<size_t, Allocator>;
+    Queue queue = Queue::create(1 << 20).value();
+
+    for (size_t i = 0; i < queue.capacity() / 2; i++) {
+        (void)queue.tryPush(i);
+    }
+
+    size_t value = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(queue.tryPush(value));
+        benchmark::DoNotOptimize(queue.tryPop(value));
+    }
+}
+
+/**
+ * @brief Push a burst and then drain it, the segmented queue grows past a single segment while the ring buffer is sized for the burst.
+ */
+template <typename Queue>
+void BM_BurstPushPop(benchmark::State& state) {
+    size_t burst = static_cast<size_t>(state.range(0));
+    Queue queue = Queue::create(std::is_same_v<Queue, sm::concurrent::RingBuffer<size_t>> ? uint32_t(burst) : 256).value();
+
+    size_t value = 0;
+    for (auto _ : state) {
+        for (size_t i = 0; i < burst; i++) {
+            benchmark::DoNotOptimize(queue.tryPush(value));
+        }
+
+        for (size_t i = 0; i < burst; i++) {
+            benchmark::DoNotOptimize(queue.tryPop(value));
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * burst);
+}
+
+/**
+ * @brief Push into a full queue, the lossy queue overwrites while the ring buffer falls back to dropping the oldest and retrying.
+ */
+template <typename Queue>
+void BM_FullQueuePush(benchmark::State& state) {
+    Queue queue = Queue::create(1024).value();
+
+    size_t value = 0;
+    if constexpr (std::is_same_v<Queue, sm::concurrent::RingBuffer<size_t>>) {
+        while (queue.tryPush(value)) {
+        }
+
+        for (auto _ : state) {
+            while (!queue.tryPush(value)) {
+                benchmark::DoNotOptimize(queue.tryPop(value));
+            }
+        }
+    } else {
+        for (auto _ : state) {
+            queue.push(value);
+        }
+    }
+}
+
+/**
+ * @brief A frame scoped queue that is recycled every iteration, either by creating a new queue or by resetting it.
+ */
+template <bool Reset>
+void BM_RingBufferRecycle(benchmark::State& state) {
+    using Queue = sm::concurrent::RingBuffer<size_t>;
+    constexpr Queue::size_type kCapacity = 0x4000;
+    Queue queue = Queue::create(kCapacity).value();
+
+    size_t pushes = static_cast<size_t>(state.range(0));
+    for (auto _ : state) {
+        for (size_t i = 0; i < pushes; i++) {
+            benchmark::DoNotOptimize(queue.tryPush(i));
+        }
+
+        if constexpr (Reset) {
+            queue.reset();
+        } else {
+            queue = Queue::create(kCapacity).value();
+        }
+    }
+}
+
+struct Event {
+    uint64_t id;
+    std::byte payload[248];
+};
+
+void BM_RingBufferEventPushPop(benchmark::State& state) {
+    using Queue = sm::concurrent::RingBuffer<Event>;
+    Queue queue = Queue::create(1024).value();
+
+    Event event{};
+    for (auto _ : state) {
+        event.id += 1;
+        benchmark::DoNotOptimize(queue.tryPush(event));
+        benchmark::DoNotOptimize(queue.tryPop(event));
+    }
+}
+
+void BM_RingBufferEventEmplaceConsume(benchmark::State& state) {
+    using Queue = sm::concurrent::RingBuffer<Event>;
+    Queue queue = Queue::create(1024).value();
+
+    uint64_t id = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(queue.tryEmplace(Event{id++, {}}));
+        benchmark::DoNotOptimize(queue.tryConsume([](Event& event) noexcept { benchmark::DoNotOptimize(event.id); }));
+    }
+}
+
+template <typename Layout>
+using LayoutQueue = sm::concurrent::RingBuffer<size_t, std::allocator<size_t>, sm::concurrent::Pow2Capacity, Layout>;
+
+template <typename Layout>
+LayoutQueue<Layout> gLayoutQueue;
+
+/**
+ * @brief Thread 0 consumes while thread 1 produces, measuring the cost of moving each element across cores.
+ */
+template <typename Layout>
+void BM_RingBufferCrossCore(benchmark::State& state) {
+    auto& queue = gLayoutQueue<Layout>;
+    if (state.thread_index() == 0) {
+        queue = LayoutQueue<Layout>::create(1024).value();
+    }
+
+    size_t value = 0;
+    if (state.thread_index() == 0) {
+        for (auto _ : state) {
+            while (!queue.tryPop(value)) {
+                std::this_thread::yield();
+            }
+        }
+    } else {
+        for (auto _ : state) {
+            while (!queue.tryPush(value)) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+sm::concurrent::SpscRingBuffer<size_t> gSpscQueue;
+
+/**
+ * @brief The same as BM_RingBufferCrossCore for the single producer queue.
+ */
+void BM_SpscRingBufferCrossCore(benchmark::State& state) {
+    auto& queue = gSpscQueue;
+    if (state.thread_index() == 0) {
+        queue = sm::concurrent::SpscRingBuffer<size_t>::create(1024).value();
+    }
+
+    size_t value = 0;
+    if (state.thread_index() == 0) {
+        for (auto _ : state) {
+            while (!queue.tryPop(value)) {
+                std::this_thread::yield();
+            }
+        }
+    } else {
+        for (auto _ : state) {
+            while (!queue.tryPush(value)) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+using ThroughputQueue = sm::concurrent::RingBuffer<size_t, std::allocator<size_t>, sm::concurrent::Pow2Capacity>;
+
+ThroughputQueue gThroughputQueue;
+
+/**
+ * @brief Thread 0 consumes while every other thread produces.
+ *
+ * Each iteration the consumer drains one element per producer, so items processed is the
+ * total number of elements that went through the queue.
+ */
+void BM_RingBufferThroughput(benchmark::State& state) {
+    using size_type = ThroughputQueue::size_type;
+
+    auto& queue = gThroughputQueue;
+    if (state.thread_index() == 0) {
+        queue = ThroughputQueue::create(4096).value();
+    }
+
+    if (state.thread_index() == 0) {
+        size_type producers = static_cast<size_type>(state.threads() - 1);
+        auto visitor = [](size_t& value) noexcept { benchmark::DoNotOptimize(value); };
+        for (auto _ : state) {
+            size_type consumed = 0;
+            while (consumed < producers) {
+                size_type popped = queue.drain(visitor, producers - consumed);
+                if (popped == 0) {
+                    std::this_thread::yield();
+                }
+                consumed += popped;
+            }
+        }
+
+        state.SetItemsProcessed(state.iterations() * producers);
+    } else {
+        size_t value = 0;
+        for (auto _ : state) {
+            while (!queue.tryPush(value)) {
+                std::this_thread::yield();
+            }
+        }
+    }
+}
+
+using ShardedThroughputQueue = sm::concurrent::ShardedRingBuffer<size_t>;
+
+ShardedThroughputQueue gShardedThroughputQueue;
+
+/**
+ * @brief The same as BM_RingBufferThroughput with the producers spread across shards.
+ */
+void BM_ShardedRingBufferThroughput(benchmark::State& state) {
+    using size_type = ShardedThroughputQueue::size_type;
+
+    auto& queue = gShardedThroughputQueue;
+    if (state.thread_index() == 0) {
+        queue = ShardedThroughputQueue::create(16, 512).value();
+    }
+
+    if (state.thread_index() == 0) {
+        size_type producers = static_cast<size_type>(state.threads() - 1);
+        auto visitor = [](size_t& value) noexcept { benchmark::DoNotOptimize(value); };
+        for (auto _ : state) {
+            size_type consumed = 0;
+            while (consumed < producers) {
+                size_type popped = queue.drain(visitor, producers - consumed);
+                if (popped == 0) {
+                    std::this_thread::yield();
+                }
+                consumed += popped;
+            }
+        }
+
+        state.SetItemsProcessed(state.iterations() * producers);
+    } else {
+        size_t value = 0;
+        for (auto _ : state) {
+            while (!queue.tryPush(value)) {
+                std::this_thread::yield();
+            }
+        }
+    }
+}
+
+/**
+ * @brief A RingBuffer shared by several consumers, which must serialize their pops.
+ */
+struct LockedRingBuffer {
+    ThroughputQueue queue = ThroughputQueue::create(4096).value();
+    std::mutex mutex;
+
+    bool tryPush(size_t& value) noexcept {
+        return queue.tryPush(value);
+    }
+
+    bool tryPop(size_t& value) noexcept {
+        std::lock_guard guard(mutex);
+        return queue.tryPop(value);
+    }
+};
+
+struct MpmcQueue {
+    sm::concurrent::MpmcRingBuffer<size_t, std::allocator<size_t>, sm::concurrent::Pow2Capacity> queue = decltype(queue)::create(4096).value();
+
+    bool tryPush(size_t& value) noexcept {
+        return queue.tryPush(value);
+    }
+
+    bool tryPop(size_t& value) noexcept {
+        return queue.tryPop(value);
+    }
+};
+
+template <typename Queue>
+std::unique_ptr<Queue> gSharedQueue;
+
+/**
+ * @brief Even threads produce and odd threads consume, each thread moves one element per iteration.
+ */
+template <typename Queue>
+void BM_SharedQueueThroughput(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        gSharedQueue<Queue> = std::make_unique<Queue>();
+    }
+
+    auto& queue = *gSharedQueue<Queue>;
+    bool producer = (state.thread_index() % 2) == 0;
+
+    size_t value = 0;
+    for (auto _ : state) {
+        if (producer) {
+            while (!queue.tryPush(value)) {
+                std::this_thread::yield();
+            }
+        } else {
+            while (!queue.tryPop(value)) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+/**
+ * @brief Latency percentiles of a single push and a single pop.
+ */
+void BM_RingBufferLatency(benchmark::State& state) {
+    using Clock = std::chrono::steady_clock;
+
+    ThroughputQueue queue = ThroughputQueue::create(1024).value();
+
+    auto pushLatency = std::make_unique<sm::concurrent::LatencyHistogram>();
+    auto popLatency = std::make_unique<sm::concurrent::LatencyHistogram>();
+
+    size_t value = 0;
+    for (auto _ : state) {
+        auto start = Clock::now();
+        benchmark::DoNotOptimize(queue.tryPush(value));
+        auto pushed = Clock::now();
+        benchmark::DoNotOptimize(queue.tryPop(value));
+        auto popped = Clock::now();
+
+        pushLatency->record(static_cast<uint64_t>(std::chrono::nanoseconds(pushed - start).count()));
+        popLatency->record(static_cast<uint64_t>(std::chrono::nanoseconds(popped - pushed).count()));
+    }
+
+    auto pushes = pushLatency->snapshot();
+    auto pops = popLatency->snapshot();
+    for (auto [name, p] : {std::pair{"p50", 0.5}, std::pair{"p99", 0.99}, std::pair{"p999", 0.999}}) {
+        state.counters[std::string("push_") + name] = static_cast<double>(pushes.percentile(p));
+        state.counters[std::string("pop_") + name] = static_cast<double>(pops.percentile(p));
+    }
+}
+
+/**
+ * @brief Time from push to pop with a producer and a consumer thread, in high resolution clock ticks.
+ */
+void BM_RingBufferResidency(benchmark::State& state) {
+    using Element = sm::concurrent::Timestamped<size_t>;
+
+    static std::unique_ptr<sm::concurrent::RingBuffer<Element>> sQueue;
+    static std::unique_ptr<sm::concurrent::LatencyHistogram> sResidency;
+
+    if (state.thread_index() == 0) {
+        sQueue = std::make_unique<sm::concurrent::RingBuffer<Element>>(sm::concurrent::RingBuffer<Element>::create(1024).value());
+        sResidency = std::make_unique<sm::concurrent::LatencyHistogram>();
+    }
+
+    sm::concurrent::LatencyRecorder recorder{*sResidency};
+    bool producer = state.thread_index() == 0;
+
+    Element element{};
+    for (auto _ : state) {
+        if (producer) {
+            while (!sQueue->tryEmplace(recorder.stamp(size_t{0}))) {
+                std::this_thread::yield();
+            }
+        } else {
+            while (!sQueue->tryPop(element)) {
+                std::this_thread::yield();
+            }
+            recorder.record(element);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    if (!producer) {
+        auto residency = sResidency->snapshot();
+        for (auto [name, p] : {std::pair{"p50", 0.5}, std::pair{"p99", 0.99}, std::pair{"p999", 0.999}}) {
+            state.counters[std::string("residency_") + name] = static_cast<double>(residency.percentile(p));
+        }
+    }
+}
+
+/**
+ * @brief The cost of recording into a shared latency histogram.
+ */
+void BM_LatencyHistogramRecord(benchmark::State& state) {
+    static std::unique_ptr<sm::concurrent::LatencyHistogram> sHistogram;
+    if (state.thread_index() == 0) {
+        sHistogram = std::make_unique<sm::concurrent::LatencyHistogram>();
+    }
+
+    uint64_t value = static_cast<uint64_t>(state.thread_index()) * 977;
+    for (auto _ : state) {
+        sHistogram->record(value);
+        value = value * 6364136223846793005u + 1442695040888963407u;
+        value >>= 40;
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+} // namespace
+
+BENCHMARK(BM_BitsetAllocateLinear)->ArgName("fill%")->Arg(0)->Arg(50)->Arg(90)->Arg(99)->ThreadRange(1, 16)->UseRealTime();
+BENCHMARK(BM_BitsetAllocateHinted)->ArgName("fill%")->Arg(0)->Arg(50)->Arg(90)->Arg(99)->ThreadRange(1, 16)->UseRealTime();
+BENCHMARK(BM_RingBufferPushPopFilled)->ArgName("fill%")->Arg(0)->Arg(50)->Arg(90)->Arg(99);
+BENCHMARK_TEMPLATE(BM_RingBufferPushPop, sm::concurrent::DynamicCapacity)->Arg(1024)->Arg(kBitsetCapacity);
+BENCHMARK_TEMPLATE(BM_RingBufferPushPop, sm::concurrent::Pow2Capacity)->Arg(1024)->Arg(kBitsetCapacity);
+BENCHMARK_TEMPLATE(BM_RingBufferStatsPushPop, sm::concurrent::NoStats);
+BENCHMARK_TEMPLATE(BM_RingBufferStatsPushPop, sm::concurrent::AtomicStats);
+BENCHMARK_TEMPLATE(BM_PointerPushPop, sm::concurrent::RingBuffer<void*>)->Arg(1024)->Arg(kBitsetCapacity);
+BENCHMARK_TEMPLATE(BM_PointerPushPop, sm::concurrent::InlineRingBuffer<void*>)->Arg(1024)->Arg(kBitsetCapacity);
+BENCHMARK_TEMPLATE(BM_RingBufferLargePushPop, std::allocator<size_t>);
+BENCHMARK_TEMPLATE(BM_RingBufferLargePushPop, sm::concurrent::HugePageAllocator<size_t>);
+BENCHMARK_TEMPLATE(BM_RingBufferLargePushPop, sm::concurrent::NumaAllocator<size_t>);
+BENCHMARK_TEMPLATE(BM_RingBufferRecycle, false)->ArgName("pushes")->Arg(16)->Arg(1024);
+BENCHMARK_TEMPLATE(BM_RingBufferRecycle, true)->ArgName("pushes")->Arg(16)->Arg(1024);
+BENCHMARK_TEMPLATE(BM_BurstPushPop, sm::concurrent::RingBuffer<size_t>)->ArgName("burst")->Arg(64)->Arg(4096);
+BENCHMARK_TEMPLATE(BM_BurstPushPop, sm::concurrent::SegmentedQueue<size_t>)->ArgName("burst")->Arg(64)->Arg(4096);
+BENCHMARK_TEMPLATE(BM_FullQueuePush, sm::concurrent::RingBuffer<size_t>);
+BENCHMARK_TEMPLATE(BM_FullQueuePush, sm::concurrent::LossyRingBuffer<size_t>);
+BENCHMARK(BM_RingBufferEventPushPop);
+BENCHMARK(BM_RingBufferEventEmplaceConsume);
+BENCHMARK(BM_RingBufferThroughput)->DenseThreadRange(2, 9)->UseRealTime();
+BENCHMARK(BM_ShardedRingBufferThroughput)->DenseThreadRange(2, 9)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_SharedQueueThroughput, LockedRingBuffer)->ThreadRange(2, 16)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_SharedQueueThroughput, MpmcQueue)->ThreadRange(2, 16)->UseRealTime();
+BENCHMARK(BM_RingBufferLatency);
+BENCHMARK(BM_RingBufferResidency)->Threads(2)->UseRealTime();
+BENCHMARK(BM_LatencyHistogramRecord)->ThreadRange(1, 16)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_RingBufferCrossCore, sm::concurrent::CompactLayout)->Threads(2)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_RingBufferCrossCore, sm::concurrent::CacheAlignedLayout)->Threads(2)->UseRealTime();
+BENCHMARK(BM_SpscRingBufferCrossCore)->Threads(2)->UseRealTime();
+
+BENCHMARK_MAIN();
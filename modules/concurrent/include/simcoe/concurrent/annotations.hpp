@@ -5,6 +5,7 @@
 #if defined(__has_attribute)
 #    if __has_attribute(nonblocking)
 #        define SM_CLANG_NONBLOCKING [[clang::nonblocking]]
+#        define SM_CLANG_NONBLOCKING_IF(...) [[clang::nonblocking(__VA_ARGS__)]]
 #    endif
 #    if __has_attribute(blocking)
 #        define SM_CLANG_BLOCKING [[clang::blocking]]
@@ -18,6 +19,10 @@
 #    define SM_CLANG_NONBLOCKING
 #endif
 
+#if !defined(SM_CLANG_NONBLOCKING_IF)
+#    define SM_CLANG_NONBLOCKING_IF(...)
+#endif
+
 #if !defined(SM_CLANG_BLOCKING)
 #    define SM_CLANG_BLOCKING
 #endif
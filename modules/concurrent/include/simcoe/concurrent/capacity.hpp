@@ -0,0 +1,78 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <bit>
+#include <cstdint>
+
+#if __cpp_concepts >= 201907L
+#    include <concepts>
+#endif
+
+#include <simcoe/concurrent/annotations.hpp>
+
+namespace sm::concurrent {
+
+#if __cpp_concepts >= 201907L
+/**
+ * @brief A policy that maps an ever increasing position onto a slot of a fixed capacity queue.
+ */
+template <typename T>
+concept CapacityPolicy = requires(uint32_t value) {
+    { T::isValid(value) } -> std::convertible_to<bool>;
+    { T::normalize(value, value) } -> std::same_as<uint32_t>;
+};
+#endif
+
+/**
+ * @brief Capacity policy that accepts any non-zero capacity.
+ *
+ * Normalizing a position requires an integer division.
+ *
+ * @warning Positions are 32 bit and wrap around after 2^32 operations, when the capacity
+ *          does not divide 2^32 the slot sequence is discontinuous at that point.
+ */
+struct DynamicCapacity {
+    static constexpr bool isValid(uint32_t capacity) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+        return capacity != 0;
+    }
+
+    template <typename I>
+    static constexpr I normalize(I index, I capacity) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+        return index % capacity;
+    }
+};
+
+/**
+ * @brief Capacity policy that only accepts power of two capacities.
+ *
+ * Normalizing a position is a single mask, and because the capacity always divides 2^32
+ * positions wrap around correctly.
+ */
+struct Pow2Capacity {
+    static constexpr bool isValid(uint32_t capacity) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+        return std::has_single_bit(capacity);
+    }
+
+    template <typename I>
+    static constexpr I normalize(I index, I capacity) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+        return index & (capacity - 1);
+    }
+};
+
+static_assert(!DynamicCapacity::isValid(0));
+static_assert(DynamicCapacity::isValid(3));
+static_assert(!Pow2Capacity::isValid(0));
+static_assert(!Pow2Capacity::isValid(3));
+static_assert(Pow2Capacity::isValid(64));
+
+// Stepping across the 2^32 boundary continues with the next slot.
+static_assert(Pow2Capacity::normalize<uint32_t>(UINT32_MAX, 8) == 7);
+static_assert(Pow2Capacity::normalize<uint32_t>(static_cast<uint32_t>(UINT32_MAX + 1ull), 8) == 0);
+
+#if __cpp_concepts >= 201907L
+static_assert(CapacityPolicy<DynamicCapacity>);
+static_assert(CapacityPolicy<Pow2Capacity>);
+#endif
+
+} // namespace sm::concurrent
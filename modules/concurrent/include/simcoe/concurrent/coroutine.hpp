@@ -0,0 +1,73 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#if __has_include(<coroutine>)
+#    include <coroutine>
+#endif
+
+#include <type_traits>
+
+namespace sm::concurrent {
+namespace detail {
+/**
+ * @brief A coroutine suspended on a queue or mailbox.
+ *
+ * Each awaitable registers at most one waiter, the producer that takes the registration
+ * calls @p resume with the waiter, which hands the coroutine to its scheduler.
+ * Waiters live inside the awaiter, and so inside the coroutine frame, so suspending never allocates.
+ */
+struct CoroutineWaiter {
+    void (*resume)(CoroutineWaiter* self) noexcept;
+};
+} // namespace detail
+
+#if __cpp_impl_coroutine >= 201902L
+#    if __cpp_concepts >= 201907L
+/**
+ * @brief A hook that decides where a coroutine woken by a producer resumes.
+ *
+ * schedule is called on the producer's thread while it is publishing, it should hand the coroutine
+ * to an event loop or executor rather than do a lot of work itself.
+ */
+template <typename T>
+concept CoroutineScheduler = std::is_nothrow_copy_constructible_v<T> && requires(T& scheduler, std::coroutine_handle<> handle) {
+    { scheduler.schedule(handle) } noexcept;
+};
+#    endif
+
+/**
+ * @brief Resume the coroutine immediately on the thread that woke it.
+ *
+ * @warning The coroutine runs inside the producer's push, so producers must not push from a signal handler
+ *          and must tolerate the coroutine running for as long as it takes to suspend again.
+ */
+struct InlineScheduler {
+    void schedule(std::coroutine_handle<> handle) const noexcept {
+        handle.resume();
+    }
+};
+
+namespace detail {
+/**
+ * @brief A waiter that resumes its coroutine through a scheduler.
+ */
+template <typename Scheduler>
+class ScheduledWaiter : public CoroutineWaiter {
+    static void resumeWaiter(CoroutineWaiter* self) noexcept {
+        auto* waiter = static_cast<ScheduledWaiter*>(self);
+        waiter->mScheduler.schedule(waiter->mHandle);
+    }
+
+protected:
+    [[no_unique_address]] Scheduler mScheduler;
+
+    std::coroutine_handle<> mHandle{};
+
+    explicit ScheduledWaiter(Scheduler scheduler) noexcept
+        : CoroutineWaiter{&ScheduledWaiter::resumeWaiter}
+        , mScheduler(scheduler) {}
+};
+} // namespace detail
+#endif
+} // namespace sm::concurrent
@@ -0,0 +1,49 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <simcoe/concurrent/limiting_clock.hpp>
+
+#include <thread>
+
+namespace sm::concurrent::detail {
+
+inline uint64_t calibrateFrequency() noexcept {
+#if defined(__aarch64__) && !defined(_MSC_VER)
+    uint64_t frequency;
+    asm volatile("mrs %0, cntfrq_el0" : "=r"(frequency));
+    return frequency;
+#elif (defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))) || defined(__x86_64__) || defined(__i386__)
+    //
+    // Measure the counter against the steady clock, 10ms is enough to get
+    // within a fraction of a percent of the true frequency.
+    //
+    using Clock = std::chrono::steady_clock;
+
+    sm::concurrent::TscClock clock;
+    auto start = Clock::now();
+    uint64_t startTicks = clock.now();
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    auto end = Clock::now();
+    uint64_t endTicks = clock.now();
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    if (elapsed <= 0) {
+        return 1'000'000'000;
+    }
+
+    return (endTicks - startTicks) * 1'000'000'000u / static_cast<uint64_t>(elapsed);
+#else
+    using Period = std::chrono::steady_clock::period;
+    return static_cast<uint64_t>(Period::den / Period::num);
+#endif
+}
+
+} // namespace sm::concurrent::detail
+
+SM_CONCURRENT_INLINE uint64_t sm::concurrent::TscClock::frequency() noexcept {
+    static const uint64_t kFrequency = detail::calibrateFrequency();
+    return kFrequency;
+}
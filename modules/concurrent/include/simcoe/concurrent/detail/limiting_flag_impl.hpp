@@ -0,0 +1,9 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <simcoe/concurrent/limiting_flag.hpp>
+
+SM_CONCURRENT_INLINE bool sm::concurrent::AtMostEvery::isActive() noexcept SM_CLANG_NONBLOCKING {
+    return detail::tryActivate(mLastActive, HighResolutionClock{}.now(), mInterval);
+}
@@ -0,0 +1,190 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <cstdint>
+#include <new>
+#include <simcoe/concurrent/page_allocator.hpp>
+
+#if defined(__linux__)
+#    include <linux/mempolicy.h>
+#    include <sys/mman.h>
+#    include <sys/syscall.h>
+#    include <unistd.h>
+#elif defined(_WIN32)
+#    if !defined(WIN32_LEAN_AND_MEAN)
+#        define WIN32_LEAN_AND_MEAN
+#    endif
+#    include <windows.h>
+#endif
+
+namespace sm::concurrent::detail {
+
+// The smallest page size on every supported platform, used as the stride when prefaulting.
+constexpr size_t kMinPageSize = 0x1000;
+
+// The default huge page size on x86-64 and on aarch64 with 4K pages.
+constexpr size_t kHugePageSize = 0x200000;
+
+constexpr size_t roundToPage(size_t size, size_t page) noexcept {
+    return (size + page - 1) & ~(page - 1);
+}
+
+inline void touchPages(void* memory, size_t size) noexcept {
+    volatile std::byte* bytes = static_cast<std::byte*>(memory);
+    for (size_t offset = 0; offset < size; offset += kMinPageSize) {
+        bytes[offset] = std::byte{0};
+    }
+}
+
+#if defined(__linux__)
+inline size_t mappingSize(size_t size, const PageOptions& options) noexcept {
+    return roundToPage(size, options.hugePages ? kHugePageSize : static_cast<size_t>(sysconf(_SC_PAGESIZE)));
+}
+
+inline void bindNode(void* memory, size_t size, int node) noexcept {
+    constexpr size_t kBitsPerMask = sizeof(unsigned long) * 8;
+    constexpr size_t kMaxNodes = 1024;
+
+    if (node == kCurrentNumaNode) {
+        node = currentNumaNode();
+    }
+
+    if (node < 0 || static_cast<size_t>(node) >= kMaxNodes) {
+        return;
+    }
+
+    //
+    // Preferred rather than bound so that a full node falls back to another instead of failing the fault.
+    // The kernel ignores the last bit of maxnode, the same as libnuma we pass one more than the mask holds.
+    //
+    unsigned long mask[kMaxNodes / kBitsPerMask]{};
+    mask[node / kBitsPerMask] = 1ul << (node % kBitsPerMask);
+    syscall(SYS_mbind, memory, size, MPOL_PREFERRED, mask, kMaxNodes + 1, 0);
+}
+#endif
+
+} // namespace sm::concurrent::detail
+
+SM_CONCURRENT_INLINE void* sm::concurrent::allocatePages(size_t size, const PageOptions& options) noexcept {
+    if (size == 0) {
+        return nullptr;
+    }
+
+#if defined(__linux__)
+    size_t length = detail::mappingSize(size, options);
+    void* memory = MAP_FAILED;
+
+    if (options.hugePages) {
+        //
+        // The hugetlb pool is reserved up front by the administrator and is usually empty.
+        // Populating in mmap would place pages before a node is bound, so only do so without one.
+        //
+        int populate = (options.prefault && !options.bindNode) ? MAP_POPULATE : 0;
+        memory = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | populate, -1, 0);
+    }
+
+    if (memory == MAP_FAILED) {
+        memory = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (memory == MAP_FAILED) {
+            return nullptr;
+        }
+
+        if (options.hugePages) {
+            madvise(memory, length, MADV_HUGEPAGE);
+        }
+    }
+
+    //
+    // The policy only applies to pages faulted after it is set, so bind before touching anything.
+    //
+    if (options.bindNode) {
+        detail::bindNode(memory, length, options.node);
+    }
+
+    if (options.prefault) {
+        detail::touchPages(memory, length);
+    }
+
+    return memory;
+#elif defined(_WIN32)
+    DWORD type = MEM_RESERVE | MEM_COMMIT;
+    SIZE_T length = size;
+    if (options.hugePages) {
+        if (SIZE_T large = GetLargePageMinimum(); large != 0) {
+            type |= MEM_LARGE_PAGES;
+            length = detail::roundToPage(size, large);
+        }
+    }
+
+    DWORD node = NUMA_NO_PREFERRED_NODE;
+    if (options.bindNode) {
+        node = static_cast<DWORD>((options.node == kCurrentNumaNode) ? currentNumaNode() : options.node);
+    }
+
+    void* memory = VirtualAllocExNuma(GetCurrentProcess(), nullptr, length, type, PAGE_READWRITE, node);
+    if (memory == nullptr && (type & MEM_LARGE_PAGES)) {
+        //
+        // Large pages require the lock pages in memory privilege, fall back to regular pages without it.
+        //
+        memory = VirtualAllocExNuma(GetCurrentProcess(), nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE, node);
+        length = size;
+    }
+
+    // Large pages are always resident, only regular pages need to be touched.
+    if (memory != nullptr && options.prefault && !(type & MEM_LARGE_PAGES)) {
+        detail::touchPages(memory, length);
+    }
+
+    return memory;
+#else
+    void* memory = ::operator new(size, std::align_val_t{detail::kMinPageSize}, std::nothrow);
+    if (memory != nullptr && options.prefault) {
+        detail::touchPages(memory, size);
+    }
+
+    return memory;
+#endif
+}
+
+SM_CONCURRENT_INLINE void sm::concurrent::freePages(void* memory, size_t size, const PageOptions& options) noexcept {
+    if (memory == nullptr) {
+        return;
+    }
+
+#if defined(__linux__)
+    munmap(memory, detail::mappingSize(size, options));
+#elif defined(_WIN32)
+    (void)size;
+    (void)options;
+    VirtualFree(memory, 0, MEM_RELEASE);
+#else
+    (void)size;
+    (void)options;
+    ::operator delete(memory, std::align_val_t{detail::kMinPageSize});
+#endif
+}
+
+SM_CONCURRENT_INLINE int sm::concurrent::currentNumaNode() noexcept {
+#if defined(__linux__)
+    unsigned cpu = 0;
+    unsigned node = 0;
+    if (syscall(SYS_getcpu, &cpu, &node, nullptr) != 0) {
+        return 0;
+    }
+
+    return static_cast<int>(node);
+#elif defined(_WIN32)
+    PROCESSOR_NUMBER processor;
+    GetCurrentProcessorNumberEx(&processor);
+
+    USHORT node = 0;
+    if (!GetNumaProcessorNodeEx(&processor, &node)) {
+        return 0;
+    }
+
+    return static_cast<int>(node);
+#else
+    return 0;
+#endif
+}
@@ -0,0 +1,96 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <algorithm>
+#include <simcoe/concurrent/parking.hpp>
+
+#if defined(__linux__)
+#    include <linux/futex.h>
+#    include <sys/syscall.h>
+#    include <unistd.h>
+
+#    include <climits>
+#    include <ctime>
+#elif defined(_WIN32)
+#    if !defined(WIN32_LEAN_AND_MEAN)
+#        define WIN32_LEAN_AND_MEAN
+#    endif
+#    include <windows.h>
+#else
+#    include <thread>
+#endif
+
+namespace sm::concurrent::detail {
+
+#if defined(__linux__)
+inline uint32_t* wordAddress(const std::atomic<uint32_t>& word) noexcept {
+    return reinterpret_cast<uint32_t*>(const_cast<std::atomic<uint32_t>*>(&word));
+}
+
+inline long futex(uint32_t* address, int op, uint32_t value, const timespec* timeout, uint32_t mask) noexcept {
+    return syscall(SYS_futex, address, op, value, timeout, nullptr, mask);
+}
+#endif
+
+} // namespace sm::concurrent::detail
+
+SM_CONCURRENT_INLINE void sm::concurrent::park(const std::atomic<uint32_t>& word, uint32_t expected) noexcept SM_CLANG_BLOCKING {
+#if defined(__linux__)
+    detail::futex(detail::wordAddress(word), FUTEX_WAIT_PRIVATE, expected, nullptr, 0);
+#elif defined(_WIN32)
+    WaitOnAddress(const_cast<std::atomic<uint32_t>*>(&word), &expected, sizeof(expected), INFINITE);
+#else
+    word.wait(expected);
+#endif
+}
+
+SM_CONCURRENT_INLINE bool sm::concurrent::parkUntil(const std::atomic<uint32_t>& word, uint32_t expected, std::chrono::steady_clock::time_point deadline) noexcept SM_CLANG_BLOCKING {
+#if defined(__linux__)
+    //
+    // steady_clock is CLOCK_MONOTONIC, FUTEX_WAIT_BITSET takes an absolute timeout on that clock.
+    //
+    auto since = deadline.time_since_epoch();
+    auto seconds = std::chrono::duration_cast<std::chrono::seconds>(since);
+    auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(since - seconds);
+    timespec timeout{static_cast<time_t>(seconds.count()), static_cast<long>(nanoseconds.count())};
+
+    detail::futex(detail::wordAddress(word), FUTEX_WAIT_BITSET_PRIVATE, expected, &timeout, FUTEX_BITSET_MATCH_ANY);
+#elif defined(_WIN32)
+    auto now = std::chrono::steady_clock::now();
+    if (now < deadline) {
+        auto remaining = std::chrono::ceil<std::chrono::milliseconds>(deadline - now);
+        DWORD timeout = static_cast<DWORD>((std::min)(remaining.count(), static_cast<std::chrono::milliseconds::rep>(INFINITE - 1)));
+        WaitOnAddress(const_cast<std::atomic<uint32_t>*>(&word), &expected, sizeof(expected), timeout);
+    }
+#else
+    //
+    // There is no portable timed wait on an atomic, poll with a short sleep instead.
+    //
+    while (word.load() == expected && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for((std::min)(std::chrono::steady_clock::duration(std::chrono::microseconds(100)), deadline - std::chrono::steady_clock::now()));
+    }
+#endif
+
+    return std::chrono::steady_clock::now() < deadline;
+}
+
+SM_CONCURRENT_INLINE void sm::concurrent::unparkOne(std::atomic<uint32_t>& word) noexcept SM_CLANG_NONBLOCKING {
+#if defined(__linux__)
+    detail::futex(detail::wordAddress(word), FUTEX_WAKE_PRIVATE, 1, nullptr, 0);
+#elif defined(_WIN32)
+    WakeByAddressSingle(&word);
+#else
+    word.notify_one();
+#endif
+}
+
+SM_CONCURRENT_INLINE void sm::concurrent::unparkAll(std::atomic<uint32_t>& word) noexcept SM_CLANG_NONBLOCKING {
+#if defined(__linux__)
+    detail::futex(detail::wordAddress(word), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, 0);
+#elif defined(_WIN32)
+    WakeByAddressAll(&word);
+#else
+    word.notify_all();
+#endif
+}
@@ -0,0 +1,25 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <simcoe/concurrent/processor.hpp>
+
+#if defined(__linux__)
+#    include <sched.h>
+#elif defined(_WIN32)
+#    if !defined(WIN32_LEAN_AND_MEAN)
+#        define WIN32_LEAN_AND_MEAN
+#    endif
+#    include <windows.h>
+#endif
+
+SM_CONCURRENT_INLINE size_t sm::concurrent::currentProcessor() noexcept {
+#if defined(__linux__)
+    int cpu = sched_getcpu();
+    return (cpu < 0) ? 0 : static_cast<size_t>(cpu);
+#elif defined(_WIN32)
+    return static_cast<size_t>(GetCurrentProcessorNumber());
+#else
+    return 0;
+#endif
+}
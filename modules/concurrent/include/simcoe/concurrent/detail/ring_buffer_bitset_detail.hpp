@@ -2,11 +2,15 @@
 
 #pragma once
 
+#include <algorithm>
 #include <atomic>
+#include <bit>
 #include <cstddef>
 #include <cstdint>
 #include <limits>
 #include <simcoe/concurrent/annotations.hpp>
+#include <simcoe/concurrent/layout.hpp>
+#include <simcoe/concurrent/spin_wait.hpp>
 
 namespace sm::concurrent::detail {
 constexpr size_t requiredBitsetSize(size_t capacity) noexcept {
@@ -17,6 +21,22 @@ static_assert(requiredBitsetSize(1) == 1);
 static_assert(requiredBitsetSize(64) == 1);
 static_assert(requiredBitsetSize(65) == 2);
 
+/**
+ * @brief The number of summary words required for a bitset of the given capacity.
+ *
+ * Each summary bit tracks whether one word of the bitset is full, a bitset that fits
+ * in a single word has no summary.
+ */
+constexpr size_t requiredSummarySize(size_t capacity) noexcept {
+    size_t words = requiredBitsetSize(capacity);
+    return (words > 1) ? requiredBitsetSize(words) : 0;
+}
+
+static_assert(requiredSummarySize(64) == 0);
+static_assert(requiredSummarySize(65) == 1);
+static_assert(requiredSummarySize(64 * 64) == 1);
+static_assert(requiredSummarySize(64 * 64 + 1) == 2);
+
 using size_type = uint32_t;
 using BitsetWord = std::atomic<uint64_t>;
 using ElementIndex = std::atomic<size_type>;
@@ -35,7 +55,7 @@ constexpr size_t underlyingStorageElementCount(size_type capacity) noexcept {
     size_t size = sizeof(T) * (capacity + 1);
 
     size = roundup(size, alignof(BitsetWord));
-    size += sizeof(BitsetWord) * detail::requiredBitsetSize(capacity);
+    size += sizeof(BitsetWord) * (detail::requiredBitsetSize(capacity) + detail::requiredSummarySize(capacity));
 
     size = roundup(size, alignof(ElementIndex));
     size += sizeof(ElementIndex) * capacity;
@@ -47,43 +67,233 @@ constexpr size_t underlyingStorageElementCount(size_type capacity) noexcept {
 static_assert(underlyingStorageElementCount<uint8_t>(1) == (2 + 6 + 8 + sizeof(size_type)));
 static_assert(underlyingStorageElementCount<uint64_t>(1) == (2 + 1 + 1));
 static_assert(underlyingStorageElementCount<uint32_t>(1) == 5);
+static_assert(underlyingStorageElementCount<uint64_t>(128) == (129 + 2 + 1 + 64));
 
-inline size_t atomicScanAndSet(std::atomic<uint64_t>* bits, size_t size) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
-    constexpr size_t kBitsPerElement = std::numeric_limits<uint64_t>::digits;
+constexpr size_t kBitsPerWord = std::numeric_limits<uint64_t>::digits;
 
-    for (size_t i = 0; i < requiredBitsetSize(size); i++) {
-        uint64_t oldValue = bits[i].load(std::memory_order_acquire);
+// Number of bitset words that share a cache line, allocation hints are spread
+// by this much so that concurrent producers start on different lines.
+constexpr size_t kWordsPerLine = kCacheLineSize / sizeof(BitsetWord);
 
-        for (size_t bit = 0; bit < kBitsPerElement; bit++) {
-            if ((i * kBitsPerElement + bit) >= size) {
-                break;
-            }
+/**
+ * @brief Get the mask of valid bits in a word of the bitset.
+ */
+constexpr uint64_t validWordMask(size_t size, size_t word) noexcept {
+    size_t remaining = size - (word * kBitsPerWord);
+    return (remaining >= kBitsPerWord) ? ~uint64_t{0} : ((uint64_t{1} << remaining) - 1);
+}
+
+static_assert(validWordMask(64, 0) == ~uint64_t{0});
+static_assert(validWordMask(65, 1) == 1);
+static_assert(validWordMask(3, 0) == 7);
+
+inline void markWordFull(std::atomic<uint64_t>* summary, size_t word) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+    if (summary != nullptr) {
+        summary[word / kBitsPerWord].fetch_or(uint64_t{1} << (word % kBitsPerWord), std::memory_order_relaxed);
+    }
+}
+
+inline void markWordAvailable(std::atomic<uint64_t>* summary, size_t word) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+    if (summary != nullptr) {
+        summary[word / kBitsPerWord].fetch_and(~(uint64_t{1} << (word % kBitsPerWord)), std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Claim up to @p count free bits from a single word.
+ *
+ * @param retries Incremented once for every failed compare exchange, may be null.
+ *
+ * @return The mask of bits claimed, 0 if the word was full.
+ */
+inline uint64_t atomicClaimWord(std::atomic<uint64_t>* bits, std::atomic<uint64_t>* summary, size_t size, size_t word, size_t count, size_t* retries = nullptr) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+    uint64_t validMask = validWordMask(size, word);
+    uint64_t oldValue = bits[word].load(std::memory_order_acquire);
+    uint64_t mask = 0;
+
+    SpinWait spin{kRetrySpin};
+    while (true) {
+        uint64_t available = ~oldValue & validMask;
+        if (available == 0) {
+            markWordFull(summary, word);
+            return 0;
+        }
 
-            uint64_t mask = uint64_t{1} << bit;
-            if ((oldValue & mask) == 0) {
-                uint64_t newValue = oldValue | mask;
-                if (bits[i].compare_exchange_strong(oldValue, newValue)) {
-                    return i * kBitsPerElement + bit;
-                } else {
-                    //
-                    // CAS failed, retry with updated oldValue
-                    //
-                    bit--;
+        mask = 0;
+        for (size_t n = 0; n < count && available != 0; n++) {
+            uint64_t lowest = available & (~available + 1);
+            mask |= lowest;
+            available ^= lowest;
+        }
+
+        if (bits[word].compare_exchange_weak(oldValue, oldValue | mask)) {
+            break;
+        }
+
+        if (retries != nullptr) {
+            *retries += 1;
+        }
+
+        spin.pause();
+    }
+
+    if ((oldValue | mask) == validMask) {
+        markWordFull(summary, word);
+    }
+
+    return mask;
+}
+
+/**
+ * @brief Find the next word at or after @p word that the summary does not mark as full.
+ *
+ * @return The index of the word, or @p words if every remaining word is marked full.
+ */
+inline size_t nextAvailableWord(const std::atomic<uint64_t>* summary, size_t word, size_t words) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+    while (word < words) {
+        uint64_t available = ~summary[word / kBitsPerWord].load(std::memory_order_relaxed) >> (word % kBitsPerWord);
+        if (available != 0) {
+            return (std::min)(word + std::countr_zero(available), words);
+        }
+
+        word = (word / kBitsPerWord + 1) * kBitsPerWord;
+    }
+
+    return words;
+}
+
+/**
+ * @brief Claim up to @p count free bits from the bitset.
+ *
+ * Scanning starts at the word selected by @p hint and wraps around, words that the summary marks
+ * as full are skipped. The summary is only a hint, if it claims every word is full the bitset is
+ * scanned again without it so that a stale summary never causes an allocation to fail.
+ *
+ * @param bits The bitset to allocate from.
+ * @param summary The summary of full words, may be null.
+ * @param size The number of valid bits in the bitset.
+ * @param hint Any value, used to spread concurrent callers across the bitset.
+ * @param indices Output array that receives the claimed indices, must hold at least @p count elements.
+ * @param count The maximum number of bits to claim.
+ * @param retries Incremented once for every failed compare exchange, may be null.
+ *
+ * @return The number of bits claimed, may be less than @p count if the bitset is full.
+ */
+inline size_t atomicScanAndSetMany(std::atomic<uint64_t>* bits, std::atomic<uint64_t>* summary, size_t size, size_t hint, size_t* indices, size_t count, size_t* retries = nullptr) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+    size_t words = requiredBitsetSize(size);
+    size_t start = (hint * kWordsPerLine) % words;
+
+    size_t claimed = 0;
+    auto claim = [&](size_t word) noexcept {
+        uint64_t mask = atomicClaimWord(bits, summary, size, word, count - claimed, retries);
+        while (mask != 0) {
+            indices[claimed++] = word * kBitsPerWord + std::countr_zero(mask);
+            mask &= mask - 1;
+        }
+    };
+
+    if (summary != nullptr) {
+        //
+        // Walk [start, words) then [0, start) skipping words marked as full.
+        //
+        size_t ranges[2][2] = {{start, words}, {0, start}};
+        for (auto [first, last] : ranges) {
+            for (size_t word = nextAvailableWord(summary, first, last); word < last; word = nextAvailableWord(summary, word + 1, last)) {
+                claim(word);
+                if (claimed == count) {
+                    return claimed;
                 }
             }
         }
+
+        if (claimed != 0) {
+            return claimed;
+        }
     }
 
-    return (std::numeric_limits<size_t>::max)();
+    for (size_t i = 0; i < words && claimed < count; i++) {
+        size_t word = (start + i) % words;
+
+        //
+        // A word that changes between full and available while another thread updates
+        // the summary can leave it stale, claiming from the word will correct it.
+        //
+        uint64_t mask = atomicClaimWord(bits, nullptr, size, word, count - claimed, retries);
+        if (mask != 0) {
+            markWordAvailable(summary, word);
+        }
+
+        while (mask != 0) {
+            indices[claimed++] = word * kBitsPerWord + std::countr_zero(mask);
+            mask &= mask - 1;
+        }
+    }
+
+    return claimed;
 }
 
-inline void atomicClearBit(std::atomic<uint64_t>* bits, size_t index) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
-    constexpr size_t kBitsPerElement = std::numeric_limits<uint64_t>::digits;
+/**
+ * @brief Claim up to @p count free bits from a bitset without a summary.
+ */
+inline size_t atomicScanAndSetMany(std::atomic<uint64_t>* bits, size_t size, size_t* indices, size_t count) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+    return atomicScanAndSetMany(bits, nullptr, size, 0, indices, count);
+}
+
+/**
+ * @brief Claim a single free bit from the bitset.
+ *
+ * @param bits The bitset to allocate from.
+ * @param summary The summary of full words, may be null.
+ * @param size The number of valid bits in the bitset.
+ * @param hint Any value, used to spread concurrent callers across the bitset.
+ * @param retries Incremented once for every failed compare exchange, may be null.
+ *
+ * @return The index of the claimed bit, or the maximum value of size_t if the bitset is full.
+ */
+inline size_t atomicScanAndSet(std::atomic<uint64_t>* bits, std::atomic<uint64_t>* summary, size_t size, size_t hint, size_t* retries = nullptr) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+    size_t index = 0;
+    if (atomicScanAndSetMany(bits, summary, size, hint, &index, 1, retries) == 0) {
+        return (std::numeric_limits<size_t>::max)();
+    }
+
+    return index;
+}
 
-    size_t elementIndex = index / kBitsPerElement;
-    size_t bitIndex = index % kBitsPerElement;
+/**
+ * @brief Claim a single free bit from a bitset without a summary.
+ */
+inline size_t atomicScanAndSet(std::atomic<uint64_t>* bits, size_t size) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+    return atomicScanAndSet(bits, nullptr, size, 0);
+}
 
-    uint64_t mask = ~(uint64_t{1} << bitIndex);
-    bits[elementIndex].fetch_and(mask, std::memory_order_acq_rel);
+/**
+ * @brief Clear every bit in @p mask from a single word of the bitset.
+ *
+ * @param bits The bitset to modify.
+ * @param summary The summary of full words, may be null.
+ * @param size The number of valid bits in the bitset.
+ * @param wordIndex The index of the word to modify.
+ * @param mask The bits to clear.
+ */
+inline void atomicClearMask(std::atomic<uint64_t>* bits, std::atomic<uint64_t>* summary, size_t size, size_t wordIndex, uint64_t mask) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+    uint64_t oldValue = bits[wordIndex].fetch_and(~mask, std::memory_order_acq_rel);
+    if (oldValue == validWordMask(size, wordIndex)) {
+        markWordAvailable(summary, wordIndex);
+    }
+}
+
+/**
+ * @brief Clear every bit in @p mask from a single word of a bitset without a summary.
+ */
+inline void atomicClearMask(std::atomic<uint64_t>* bits, size_t wordIndex, uint64_t mask) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+    bits[wordIndex].fetch_and(~mask, std::memory_order_acq_rel);
+}
+
+inline void atomicClearBit(std::atomic<uint64_t>* bits, std::atomic<uint64_t>* summary, size_t size, size_t index) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+    atomicClearMask(bits, summary, size, index / kBitsPerWord, uint64_t{1} << (index % kBitsPerWord));
+}
+
+inline void atomicClearBit(std::atomic<uint64_t>* bits, size_t index) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+    atomicClearMask(bits, index / kBitsPerWord, uint64_t{1} << (index % kBitsPerWord));
 }
-} // namespace sm::concurrent::detail
\ No newline at end of file
+} // namespace sm::concurrent::detail
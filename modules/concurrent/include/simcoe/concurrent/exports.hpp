@@ -2,7 +2,13 @@
 
 #pragma once
 
-#if defined(SM_CONCURRENT_API_EXPORT)
+#if defined(SM_CONCURRENT_HEADER_ONLY)
+//
+// The implementation is included inline with the headers, nothing is imported or exported.
+//
+#    define SM_CONCURRENT_API
+#    define SM_CONCURRENT_INLINE inline
+#elif defined(SM_CONCURRENT_API_EXPORT)
 #    if defined(_WIN32) || defined(_MSC_VER)
 #        define SM_CONCURRENT_API __declspec(dllexport)
 #    else
@@ -15,3 +21,7 @@
 #        define SM_CONCURRENT_API
 #    endif // defined(_WIN32) || defined(_MSC_VER)
 #endif     // SM_CONCURRENT_API_EXPORT
+
+#if !defined(SM_CONCURRENT_INLINE)
+#    define SM_CONCURRENT_INLINE
+#endif
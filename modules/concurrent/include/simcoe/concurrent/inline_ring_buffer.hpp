@@ -0,0 +1,571 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <new>
+#include <optional>
+#include <simcoe/concurrent/annotations.hpp>
+#include <simcoe/concurrent/capacity.hpp>
+#include <simcoe/concurrent/layout.hpp>
+#include <simcoe/concurrent/parking.hpp>
+#include <simcoe/concurrent/spin_wait.hpp>
+#include <span>
+#include <type_traits>
+
+namespace sm::concurrent {
+/**
+ * @brief Whether values of type @p T can be stored directly in the slots of an InlineRingBuffer.
+ */
+template <typename T>
+constexpr bool kIsInlineValue = std::is_trivially_copyable_v<T> && (sizeof(T) <= sizeof(uint64_t));
+
+/**
+ * @brief A fixed size, multi-producer single-consumer, wait free, reentrant atomic ringbuffer for small values.
+ *
+ * Follows the same protocol as RingBuffer, but rather than allocating storage from a bitmap and publishing
+ * its index the value itself is published in a 64 bit atomic slot. A push and a pop each touch a single slot,
+ * and the queue needs no storage beyond the slots.
+ *
+ * @warning An empty slot holds a value with every bit set, for a @p T that is 8 bytes wide
+ *          a value with that representation cannot be pushed. This is never a valid object pointer.
+ *
+ * @tparam T The type of elements stored in the ring buffer. Must be trivially copyable and at most 8 bytes.
+ * @tparam Allocator The allocator type used to allocate and deallocate memory for the ring buffer.
+ * @tparam Capacity The policy used to validate the capacity and map positions onto slots.
+ * @tparam Layout The layout policy, CacheAlignedLayout separates the producer and consumer indices.
+ */
+template <typename T, typename Allocator = std::allocator<T>, typename Capacity = DynamicCapacity, typename Layout = CompactLayout>
+#if __cpp_concepts >= 201907L
+    requires kIsInlineValue<T> && std::is_nothrow_default_constructible_v<Allocator> && CapacityPolicy<Capacity>
+#endif
+class InlineRingBuffer {
+public:
+    using size_type = uint32_t;
+    using value_type = T;
+    using allocator_type = Allocator;
+
+private:
+    using Slot = std::atomic<uint64_t>;
+
+    using SlotAllocator = std::allocator_traits<Allocator>::template rebind_alloc<Slot>;
+
+    static constexpr uint64_t kEmptySlot = (std::numeric_limits<uint64_t>::max)();
+
+    // The maximum number of elements published by a single batch operation,
+    // larger batches are split into multiple rounds.
+    static constexpr size_type kMaxBatchSize = 64;
+
+    // How a blocking pop backs off between polls of the queue before parking.
+    static constexpr SpinPolicy kPopSpin{.pauseRounds = 7, .maxPauses = 64, .yieldRounds = 4};
+
+    using AtomicSize = std::atomic<size_type>;
+
+    //
+    // Read mostly fields.
+    //
+    [[no_unique_address]] SlotAllocator mAllocator{};
+
+    Slot* mSlots{};
+
+    size_type mCapacity{};
+
+    //
+    // Fields written by producers, the consumer also decrements the count.
+    //
+    alignas(detail::kLayoutAlignment<Layout, AtomicSize>) AtomicSize mCount{};
+
+    AtomicSize mHead{};
+
+    //
+    // Fields written by the consumer.
+    //
+    alignas(detail::kLayoutAlignment<Layout, AtomicSize>) AtomicSize mTail{};
+
+    //
+    // Fields read by producers on every push and only written when the consumer parks or wakes,
+    // kept off the consumer line so pushes do not read the line every pop writes.
+    //
+
+    // Non-zero while the consumer is parked in a blocking pop.
+    alignas(detail::kLayoutAlignment<Layout, std::atomic<uint32_t>>) std::atomic<uint32_t> mSleeping{};
+
+    static uint64_t encode(const T& value) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+        // Bytes past the end of a smaller T are left zero, so it can never encode as an empty slot.
+        uint64_t bits = 0;
+        std::memcpy(&bits, &value, sizeof(T));
+        return bits;
+    }
+
+    static T decode(uint64_t bits) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+        // T is not required to be default constructible, copying into raw storage begins its lifetime.
+        alignas(T) std::byte storage[sizeof(T)];
+        std::memcpy(storage, &bits, sizeof(T));
+        return *std::launder(reinterpret_cast<T*>(storage));
+    }
+
+    void clear() noexcept {
+        if (mSlots != nullptr) {
+            mAllocator.deallocate(mSlots, mCapacity);
+
+            mSlots = nullptr;
+            mCapacity = 0;
+        }
+    }
+
+    size_type normalize(size_type index) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+        return Capacity::normalize(index, capacity());
+    }
+
+    /**
+     * @brief Wake the consumer if it is parked in a blocking pop.
+     */
+    void wakeConsumer() noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+        if (mSleeping.load() != 0) [[unlikely]] {
+            if (mSleeping.exchange(0) != 0) {
+                unparkOne(mSleeping);
+            }
+        }
+    }
+
+    bool isTailPublished() noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+        return mSlots[normalize(mTail.load())].load(std::memory_order_relaxed) != kEmptySlot;
+    }
+
+    /**
+     * @brief Poll the queue for a short while before a blocking pop parks.
+     */
+    bool trySpinPop(T& value) noexcept SM_CLANG_BLOCKING {
+        SpinWait spin{kPopSpin};
+        while (!spin.shouldPark()) {
+            if (isTailPublished() && tryPop(value)) {
+                return true;
+            }
+
+            spin.spinOnce();
+        }
+
+        return false;
+    }
+
+    /**
+     * @brief Reserve space for up to @p count elements.
+     *
+     * @return The number of elements reserved, any excess is rolled back.
+     */
+    size_type reserveCount(size_type count) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+        auto current = mCount.fetch_add(count);
+        if (current >= capacity()) {
+            mCount.fetch_sub(count);
+            return 0;
+        }
+
+        size_type reserved = (std::min)(count, capacity() - current);
+        if (reserved < count) {
+            mCount.fetch_sub(count - reserved);
+        }
+
+        return reserved;
+    }
+
+    constexpr InlineRingBuffer(Slot* slots, size_type capacity, Allocator allocator) noexcept
+        : mAllocator(std::move(allocator))
+        , mSlots(slots)
+        , mCapacity(capacity) {}
+
+public:
+    constexpr InlineRingBuffer() noexcept = default;
+
+    InlineRingBuffer(const InlineRingBuffer& other) = delete;
+    InlineRingBuffer& operator=(const InlineRingBuffer& other) = delete;
+
+    /**
+     * @brief Move construct a ring buffer.
+     *
+     * @note This function is not thread-safe and should only be called when no other threads are accessing the queue.
+     *
+     * @param other The other ring buffer to move from.
+     */
+    constexpr InlineRingBuffer(InlineRingBuffer&& other) noexcept
+        : mAllocator(std::move(other.mAllocator))
+        , mSlots(other.mSlots)
+        , mCapacity(other.mCapacity)
+        , mCount(other.mCount.load())
+        , mHead(other.mHead.load())
+        , mTail(other.mTail.load()) {
+        other.mSlots = nullptr;
+        other.mCapacity = 0;
+    }
+
+    /**
+     * @brief Move assign a ring buffer.
+     *
+     * @note This function is not thread-safe and should only be called when no other threads are accessing the queue.
+     *
+     * @param other The other ring buffer to move from.
+     * @return The moved ring buffer.
+     */
+    constexpr InlineRingBuffer& operator=(InlineRingBuffer&& other) noexcept {
+        if (this != &other) {
+            clear();
+
+            mAllocator = std::move(other.mAllocator);
+            mSlots = other.mSlots;
+            mCapacity = other.mCapacity;
+            mCount.store(other.mCount.load());
+            mHead.store(other.mHead.load());
+            mTail.store(other.mTail.load());
+
+            other.mSlots = nullptr;
+            other.mCapacity = 0;
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Destroy the ring buffer.
+     */
+    ~InlineRingBuffer() noexcept {
+        clear();
+    }
+
+    /**
+     * @brief Try to push a value onto the queue.
+     *
+     * @param value The value to push.
+     *
+     * @return true if the value was pushed, false if the queue was full or @p value encodes as an empty slot.
+     */
+    [[nodiscard]]
+    bool tryPush(const T& value) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+        uint64_t bits = encode(value);
+        if (bits == kEmptySlot) [[unlikely]] {
+            return false;
+        }
+
+        if (reserveCount(1) == 0) {
+            return false;
+        }
+
+        auto head = mHead.fetch_add(1);
+        mSlots[normalize(head)].store(bits);
+
+        wakeConsumer();
+
+        return true;
+    }
+
+    /**
+     * @brief Try to construct a value and push it onto the queue.
+     *
+     * Provided for compatibility with RingBuffer, as T is trivially copyable this is equivalent to
+     * `tryPush(T(args...))`.
+     *
+     * @param args The arguments forwarded to the constructor of T.
+     *
+     * @return true if the value was pushed, false otherwise.
+     */
+    template <typename... Args>
+#if __cpp_concepts >= 201907L
+        requires std::is_nothrow_constructible_v<T, Args&&...>
+#endif
+    [[nodiscard]]
+    bool tryEmplace(Args&&... args) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+        return tryPush(T(std::forward<Args>(args)...));
+    }
+
+    /**
+     * @brief Try to pop a value from the queue.
+     *
+     * If the queue is empty @p value is left unchanged.
+     *
+     * @param value The value to pop into.
+     *
+     * @return true if a value was popped, false if the queue was empty.
+     */
+    [[nodiscard]]
+    bool tryPop(T& value) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+        return tryConsume([&value](T& element) noexcept { value = element; });
+    }
+
+    /**
+     * @brief Try to visit and remove the value at the front of the queue.
+     *
+     * Provided for compatibility with RingBuffer, @p fn is given a copy of the value.
+     *
+     * @param fn The function to invoke with the value, must not throw.
+     *
+     * @return true if a value was consumed, false if the queue was empty.
+     */
+    template <typename F>
+#if __cpp_concepts >= 201907L
+        requires std::is_nothrow_invocable_v<F&, T&>
+#endif
+    [[nodiscard]]
+    bool tryConsume(F&& fn) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+        auto bits = mSlots[normalize(mTail.load())].exchange(kEmptySlot);
+        if (bits == kEmptySlot) {
+            return false;
+        }
+
+        T value = decode(bits);
+        fn(value);
+
+        mTail.fetch_add(1);
+        mCount.fetch_sub(1);
+        return true;
+    }
+
+    /**
+     * @brief Pop a value from the queue, blocking until one is available.
+     *
+     * @param value The value to pop into.
+     */
+    void pop(T& value) noexcept SM_CLANG_BLOCKING {
+        if (trySpinPop(value)) {
+            return;
+        }
+
+        while (true) {
+            mSleeping.store(1);
+            if (tryPop(value)) {
+                mSleeping.store(0);
+                return;
+            }
+
+            park(mSleeping, 1);
+        }
+    }
+
+    /**
+     * @brief Pop a value from the queue, blocking until one is available or the timeout expires.
+     *
+     * @param value The value to pop into.
+     * @param timeout The maximum time to wait.
+     *
+     * @return true if a value was popped, false if the timeout expired.
+     */
+    template <typename Rep, typename Period>
+    [[nodiscard]]
+    bool popFor(T& value, std::chrono::duration<Rep, Period> timeout) noexcept SM_CLANG_BLOCKING {
+        return popUntil(value, std::chrono::steady_clock::now() + timeout);
+    }
+
+    /**
+     * @brief Pop a value from the queue, blocking until one is available or the deadline passes.
+     *
+     * @param value The value to pop into.
+     * @param deadline The time after which to stop waiting.
+     *
+     * @return true if a value was popped, false if the deadline passed.
+     */
+    template <typename Clock, typename Duration>
+    [[nodiscard]]
+    bool popUntil(T& value, std::chrono::time_point<Clock, Duration> deadline) noexcept SM_CLANG_BLOCKING {
+        if (trySpinPop(value)) {
+            return true;
+        }
+
+        auto steadyDeadline = std::chrono::steady_clock::now() + std::chrono::ceil<std::chrono::steady_clock::duration>(deadline - Clock::now());
+        while (true) {
+            mSleeping.store(1);
+            if (tryPop(value)) {
+                mSleeping.store(0);
+                return true;
+            }
+
+            if (!parkUntil(mSleeping, 1, steadyDeadline)) {
+                mSleeping.store(0);
+                return tryPop(value);
+            }
+        }
+    }
+
+    /**
+     * @brief Try to push multiple values onto the queue.
+     *
+     * Each round reserves space for a run of values and claims their slots with a single update of the head.
+     *
+     * @param values The values to push.
+     *
+     * @return The number of values pushed from the front of @p values.
+     */
+    [[nodiscard]]
+    size_type tryPushN(std::span<const T> values) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+        size_type pushed = 0;
+
+        while (pushed < values.size()) {
+            size_type batch = static_cast<size_type>((std::min)(values.size() - pushed, size_t{kMaxBatchSize}));
+
+            //
+            // Values that encode as an empty slot end the batch early.
+            //
+            uint64_t bits[kMaxBatchSize];
+            size_type valid = 0;
+            while (valid < batch) {
+                bits[valid] = encode(values[pushed + valid]);
+                if (bits[valid] == kEmptySlot) [[unlikely]] {
+                    break;
+                }
+                valid += 1;
+            }
+
+            size_type reserved = (valid != 0) ? reserveCount(valid) : 0;
+            if (reserved == 0) {
+                break;
+            }
+
+            auto head = mHead.fetch_add(reserved);
+            for (size_type i = 0; i < reserved; i++) {
+                mSlots[normalize(head + i)].store(bits[i]);
+            }
+
+            wakeConsumer();
+
+            pushed += reserved;
+            if (reserved < batch) {
+                break;
+            }
+        }
+
+        return pushed;
+    }
+
+    /**
+     * @brief Visit and remove up to @p limit values from the queue.
+     *
+     * The tail and count are only updated once for the whole batch.
+     *
+     * @param visitor The function to invoke with each value, must not throw.
+     * @param limit The maximum number of values to remove.
+     *
+     * @return The number of values removed.
+     */
+    template <typename F>
+#if __cpp_concepts >= 201907L
+        requires std::is_nothrow_invocable_v<F&, T&>
+#endif
+    size_type drain(F&& visitor, size_type limit = (std::numeric_limits<size_type>::max)()) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+        auto tail = mTail.load();
+
+        size_type popped = 0;
+        while (popped < limit) {
+            auto bits = mSlots[normalize(tail + popped)].exchange(kEmptySlot);
+            if (bits == kEmptySlot) {
+                break;
+            }
+
+            T value = decode(bits);
+            visitor(value);
+            popped += 1;
+        }
+
+        if (popped != 0) {
+            mTail.fetch_add(popped);
+            mCount.fetch_sub(popped);
+        }
+
+        return popped;
+    }
+
+    /**
+     * @brief Try to pop multiple values from the queue.
+     *
+     * Popped values are copied into the front of @p values in queue order.
+     *
+     * @param values The values to pop into.
+     *
+     * @return The number of values popped.
+     */
+    [[nodiscard]]
+    size_type tryPopN(std::span<T> values) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+        size_type limit = static_cast<size_type>((std::min)(values.size(), size_t{(std::numeric_limits<size_type>::max)()}));
+        T* output = values.data();
+        return drain([&output](T& value) noexcept { *output++ = value; }, limit);
+    }
+
+    /**
+     * @brief Get an estimate of the number of items in the queue.
+     *
+     * @warning As this is a lock-free structure the count will be immediately out of date.
+     *
+     * @param order The memory order to use when loading the count.
+     *
+     * @return The number of items in the queue.
+     */
+    size_type count(std::memory_order order = std::memory_order_seq_cst) const noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+        return mCount.load(order);
+    }
+
+    /**
+     * @brief Get the maximum capacity of the queue.
+     *
+     * @return The maximum number of items the queue can hold.
+     */
+    size_type capacity() const noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+        return mCapacity;
+    }
+
+    /**
+     * @brief Get the Allocator object used by the ring buffer.
+     *
+     * @return The allocator.
+     */
+    allocator_type getAllocator() const noexcept {
+        return mAllocator;
+    }
+
+    /**
+     * @brief Provided for compatibility with standard containers.
+     *
+     * This is equivalent to `getAllocator()`.
+     *
+     * @return The allocator.
+     */
+    allocator_type get_allocator() const noexcept {
+        return mAllocator;
+    }
+
+    /**
+     * @brief Get the number of slots allocated for a queue of the given capacity.
+     *
+     * @param capacity The capacity of the queue.
+     *
+     * @return The number of slots.
+     */
+    static constexpr size_t underlyingStorageElementCount(size_type capacity) noexcept {
+        return capacity;
+    }
+
+    /**
+     * @brief Create a new queue with the given capacity.
+     *
+     * @param capacity The maximum number of elements the queue can hold, must be accepted by the capacity policy.
+     * @param allocator The allocator used to allocate and deallocate the storage.
+     *
+     * @return The ring buffer if it was created successfully, std::nullopt otherwise.
+     */
+    [[nodiscard]]
+    static std::optional<InlineRingBuffer> create(size_type capacity, Allocator allocator = Allocator{}) noexcept {
+        if (!Capacity::isValid(capacity)) {
+            return std::nullopt;
+        }
+
+        SlotAllocator slotAllocator{allocator};
+        auto slots = slotAllocator.allocate(underlyingStorageElementCount(capacity));
+        if (slots == nullptr) {
+            return std::nullopt;
+        }
+
+        std::uninitialized_fill_n(slots, capacity, kEmptySlot);
+
+        return InlineRingBuffer{slots, capacity, std::move(allocator)};
+    }
+};
+} // namespace sm::concurrent
@@ -0,0 +1,175 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <simcoe/concurrent/annotations.hpp>
+#include <simcoe/concurrent/layout.hpp>
+#include <simcoe/concurrent/limiting_clock.hpp>
+#include <simcoe/concurrent/limiting_flag.hpp>
+#include <type_traits>
+
+namespace sm::concurrent {
+namespace detail {
+/**
+ * @brief Mix the bits of a key so that sequential keys land in different buckets.
+ *
+ * The splitmix64 finalizer, std::hash is the identity for integers on most standard libraries.
+ */
+constexpr uint64_t mixKey(uint64_t key) noexcept {
+    key ^= key >> 30;
+    key *= 0xbf58476d1ce4e5b9ull;
+    key ^= key >> 27;
+    key *= 0x94d049bb133111ebull;
+    key ^= key >> 31;
+    return key;
+}
+} // namespace detail
+
+/**
+ * @brief A fixed size table of at most every flags, one per key.
+ *
+ * Keys are hashed into cache line sized buckets of a few entries each. An entry holds the key
+ * it was claimed by and an at most every state, lookups and claims are a handful of atomic operations
+ * and the table never allocates.
+ *
+ * When every entry in a bucket is claimed by a key that was recently active, a new key evicts one of
+ * them with a small probability and is otherwise limited. Under heavy collisions an evicted key
+ * may activate early, or an activation may be suppressed once.
+ *
+ * @tparam N The number of entries in the table, must be a multiple of the bucket size.
+ * @tparam Clock The clock policy.
+ */
+template <size_t N, typename Clock = HighResolutionClock>
+#if __cpp_concepts >= 201907L
+    requires LimitingClock<Clock>
+#endif
+class KeyedLimiter {
+    struct Entry {
+        // The mixed key that claimed this entry, zero if unclaimed.
+        std::atomic<uint64_t> key{0};
+
+        // The at most every state of the key.
+        std::atomic<uint64_t> state{0};
+    };
+
+    static constexpr size_t kWays = (kCacheLineSize >= sizeof(Entry)) ? (kCacheLineSize / sizeof(Entry)) : 1;
+
+    // A colliding key evicts an active entry once in this many attempts.
+    static constexpr uint64_t kEvictionOdds = 8;
+
+    static_assert(N > 0 && N % kWays == 0, "N must be a multiple of the bucket size");
+
+    static constexpr size_t kBucketCount = N / kWays;
+
+    struct alignas(kCacheLineSize) Bucket {
+        Entry entries[kWays];
+    };
+
+    Bucket mBuckets[kBucketCount];
+
+    uint64_t mInterval;
+
+    [[no_unique_address]] Clock mClock;
+
+    bool isStale(const Entry& entry, uint64_t now) const noexcept SM_CLANG_NONBLOCKING {
+        uint64_t last = entry.state.load(std::memory_order_relaxed) & detail::kTimeMask;
+        auto elapsed = static_cast<int64_t>((now - last) << 1) >> 1;
+        return elapsed >= static_cast<int64_t>(mInterval);
+    }
+
+public:
+    /**
+     * @brief Construct a new keyed limiter.
+     *
+     * @param interval The minimum interval between activations of each key.
+     * @param clock The clock to read.
+     */
+    constexpr KeyedLimiter(std::chrono::nanoseconds interval, Clock clock = Clock{}) noexcept
+        : mInterval(clock.ticks(interval))
+        , mClock(clock) {}
+
+    KeyedLimiter(const KeyedLimiter&) = delete;
+    KeyedLimiter& operator=(const KeyedLimiter&) = delete;
+
+    /**
+     * @brief Attempts to activate the flag for @p key.
+     *
+     * @param key The key to activate, such as a call site address or error code.
+     *
+     * @return If the flag for @p key was activated by this call.
+     */
+    bool isActive(uint64_t key) noexcept SM_CLANG_NONBLOCKING {
+        uint64_t mixed = detail::mixKey(key);
+        uint64_t tag = (mixed != 0) ? mixed : 1;
+
+        Bucket& bucket = mBuckets[mixed % kBucketCount];
+        uint64_t now = mClock.now();
+
+        //
+        // Look for the key, claiming the first unclaimed entry if it is not present.
+        //
+        for (Entry& entry : bucket.entries) {
+            uint64_t current = entry.key.load(std::memory_order_acquire);
+            if (current == 0 && entry.key.compare_exchange_strong(current, tag, std::memory_order_acq_rel)) {
+                return detail::tryActivate(entry.state, now, mInterval);
+            }
+
+            if (current == tag) {
+                return detail::tryActivate(entry.state, now, mInterval);
+            }
+        }
+
+        //
+        // Every entry is claimed by another key, take over one that has passed its interval.
+        // Otherwise occasionally evict one so that a table full of active keys still admits new ones.
+        //
+        size_t victim = kWays;
+        for (size_t i = 0; i < kWays; i++) {
+            if (isStale(bucket.entries[i], now)) {
+                victim = i;
+                break;
+            }
+        }
+
+        if (victim == kWays) {
+            uint64_t roll = detail::mixKey(now ^ tag);
+            if (roll % kEvictionOdds != 0) {
+                return false;
+            }
+
+            victim = (roll / kEvictionOdds) % kWays;
+        }
+
+        Entry& entry = bucket.entries[victim];
+        uint64_t current = entry.key.load(std::memory_order_acquire);
+        if (current != tag && !entry.key.compare_exchange_strong(current, tag, std::memory_order_acq_rel)) {
+            return false;
+        }
+
+        entry.state.store(0, std::memory_order_release);
+        return detail::tryActivate(entry.state, now, mInterval);
+    }
+
+    /**
+     * @brief Attempts to activate the flag for @p key.
+     *
+     * @param key The key to activate, hashed with std::hash.
+     *
+     * @return If the flag for @p key was activated by this call.
+     */
+    template <typename K>
+#if __cpp_concepts >= 201907L
+        requires(!std::is_integral_v<K>) && requires(const K& k) {
+            { std::hash<K>{}(k) } -> std::convertible_to<size_t>;
+        }
+#endif
+    bool isActive(const K& key) noexcept SM_CLANG_NONBLOCKING {
+        return isActive(static_cast<uint64_t>(std::hash<K>{}(key)));
+    }
+};
+} // namespace sm::concurrent
@@ -0,0 +1,387 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <simcoe/concurrent/annotations.hpp>
+#include <simcoe/concurrent/layout.hpp>
+#include <simcoe/concurrent/limiting_clock.hpp>
+#include <simcoe/concurrent/stats.hpp>
+#include <type_traits>
+#include <utility>
+
+namespace sm::concurrent {
+namespace detail {
+/**
+ * @brief The bucket layout of a log linear histogram.
+ *
+ * Values below 2^Precision each get their own bucket, above that every power of two range is split
+ * into 2^(Precision - 1) equal buckets, so a recorded value is off by at most 1 / 2^(Precision - 1)
+ * of itself. Values of 2^RangeBits or more are recorded in the last bucket.
+ */
+template <uint32_t Precision, uint32_t RangeBits>
+struct HistogramBuckets {
+    static_assert(Precision >= 1 && Precision <= 16, "Precision must be between 1 and 16");
+    static_assert(RangeBits > Precision && RangeBits <= 64, "RangeBits must be greater than Precision and at most 64");
+
+    static constexpr uint64_t kSubBuckets = uint64_t{1} << Precision;
+    static constexpr uint64_t kHalfSubBuckets = kSubBuckets / 2;
+
+    static constexpr size_t kCount = (RangeBits - Precision + 2) * kHalfSubBuckets;
+
+    static constexpr uint64_t kMaxValue = (RangeBits == 64) ? (std::numeric_limits<uint64_t>::max)() : (uint64_t{1} << (RangeBits % 64)) - 1;
+
+    static constexpr size_t indexOf(uint64_t value) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+        value = (value < kMaxValue) ? value : kMaxValue;
+        if (value < kSubBuckets) {
+            return static_cast<size_t>(value);
+        }
+
+        uint32_t shift = static_cast<uint32_t>(std::bit_width(value)) - Precision;
+        return static_cast<size_t>(shift * kHalfSubBuckets + (value >> shift));
+    }
+
+    static constexpr uint64_t lowest(size_t index) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+        if (index < kSubBuckets) {
+            return index;
+        }
+
+        uint64_t shift = index / kHalfSubBuckets - 1;
+        return (index - shift * kHalfSubBuckets) << shift;
+    }
+
+    static constexpr uint64_t highest(size_t index) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+        if (index < kSubBuckets) {
+            return index;
+        }
+
+        uint64_t shift = index / kHalfSubBuckets - 1;
+        return lowest(index) + ((uint64_t{1} << shift) - 1);
+    }
+};
+} // namespace detail
+
+/**
+ * @brief A point in time copy of a latency histogram.
+ *
+ * Snapshots are plain values, they can be merged across histograms and queried on the consumer side
+ * without touching the histogram that produced them.
+ *
+ * @tparam Precision The number of significant bits kept for each value.
+ * @tparam RangeBits The number of bits of the largest value that is recorded exactly.
+ */
+template <uint32_t Precision = 5, uint32_t RangeBits = 40>
+class HistogramSnapshot {
+    template <size_t, uint32_t, uint32_t>
+    friend class BasicLatencyHistogram;
+
+    using Buckets = detail::HistogramBuckets<Precision, RangeBits>;
+
+    uint64_t mCounts[Buckets::kCount]{};
+
+    uint64_t mTotal{0};
+
+    uint64_t mSum{0};
+
+public:
+    static constexpr size_t kBucketCount = Buckets::kCount;
+
+    /**
+     * @brief Record a value.
+     *
+     * @param value The value to record.
+     * @param count The number of times to record it.
+     */
+    constexpr void record(uint64_t value, uint64_t count = 1) noexcept {
+        mCounts[Buckets::indexOf(value)] += count;
+        mTotal += count;
+        mSum += value * count;
+    }
+
+    /**
+     * @brief Add every value recorded in another snapshot to this one.
+     *
+     * @param other The snapshot to merge.
+     */
+    constexpr void merge(const HistogramSnapshot& other) noexcept {
+        for (size_t i = 0; i < kBucketCount; i++) {
+            mCounts[i] += other.mCounts[i];
+        }
+
+        mTotal += other.mTotal;
+        mSum += other.mSum;
+    }
+
+    /**
+     * @brief Get the number of recorded values.
+     *
+     * @return The value count.
+     */
+    constexpr uint64_t count() const noexcept {
+        return mTotal;
+    }
+
+    /**
+     * @brief Get the mean of every recorded value.
+     *
+     * @return The exact mean, or 0 if the snapshot is empty.
+     */
+    constexpr double mean() const noexcept {
+        return (mTotal == 0) ? 0.0 : static_cast<double>(mSum) / static_cast<double>(mTotal);
+    }
+
+    /**
+     * @brief Get the smallest recorded value.
+     *
+     * @return The lowest value of the first non empty bucket, or 0 if the snapshot is empty.
+     */
+    constexpr uint64_t min() const noexcept {
+        for (size_t i = 0; i < kBucketCount; i++) {
+            if (mCounts[i] != 0) {
+                return Buckets::lowest(i);
+            }
+        }
+
+        return 0;
+    }
+
+    /**
+     * @brief Get the largest recorded value.
+     *
+     * @return The highest value of the last non empty bucket, or 0 if the snapshot is empty.
+     */
+    constexpr uint64_t max() const noexcept {
+        for (size_t i = kBucketCount; i > 0; i--) {
+            if (mCounts[i - 1] != 0) {
+                return Buckets::highest(i - 1);
+            }
+        }
+
+        return 0;
+    }
+
+    /**
+     * @brief Get the value below which a fraction of the recorded values fall.
+     *
+     * @param fraction The fraction of values, 0.99 for the 99th percentile.
+     *
+     * @return The highest value of the bucket holding the percentile, or 0 if the snapshot is empty.
+     */
+    constexpr uint64_t percentile(double fraction) const noexcept {
+        if (mTotal == 0) {
+            return 0;
+        }
+
+        if (fraction >= 1.0) {
+            return max();
+        }
+
+        // The rank of the percentile, rounded up so that p50 of two values is the first.
+        double scaled = (fraction > 0.0) ? fraction * static_cast<double>(mTotal) : 0.0;
+        uint64_t rank = static_cast<uint64_t>(scaled);
+        if (rank == 0 || static_cast<double>(rank) < scaled) {
+            rank += 1;
+        }
+
+        uint64_t seen = 0;
+        for (size_t i = 0; i < kBucketCount; i++) {
+            seen += mCounts[i];
+            if (seen >= rank) {
+                return Buckets::highest(i);
+            }
+        }
+
+        return max();
+    }
+
+    /**
+     * @brief Get the number of values recorded in the bucket holding @p value.
+     *
+     * @param value The value to look up.
+     *
+     * @return The bucket count.
+     */
+    constexpr uint64_t countAt(uint64_t value) const noexcept {
+        return mCounts[Buckets::indexOf(value)];
+    }
+};
+
+/**
+ * @brief A log linear latency histogram that can be recorded into from any thread without locking.
+ *
+ * Each record goes to the stripe selected by the caller's stack address with relaxed atomic increments,
+ * stripes are cache line isolated so threads measuring the same structure rarely share a line, and
+ * recording touches no thread local state so it is safe from a signal handler.
+ * snapshot merges every stripe on the consumer side. Values are unitless, usually nanoseconds or
+ * clock ticks.
+ *
+ * @code{.cpp}
+ * sm::concurrent::LatencyHistogram histogram;
+ * histogram.record(elapsed);
+ *
+ * auto snapshot = histogram.snapshot();
+ * log("p99: {}ns", snapshot.percentile(0.99));
+ * @endcode
+ *
+ * @tparam Stripes The number of stripes.
+ * @tparam Precision The number of significant bits kept for each value.
+ * @tparam RangeBits The number of bits of the largest value that is recorded exactly.
+ */
+template <size_t Stripes = 8, uint32_t Precision = 5, uint32_t RangeBits = 40>
+class BasicLatencyHistogram {
+    static_assert(Stripes > 0, "Stripes must be greater than 0");
+
+    using Buckets = detail::HistogramBuckets<Precision, RangeBits>;
+
+    struct alignas(kCacheLineSize) Stripe {
+        std::atomic<uint64_t> counts[Buckets::kCount]{};
+        std::atomic<uint64_t> sum{0};
+    };
+
+    Stripe mStripes[Stripes];
+
+public:
+    using Snapshot = HistogramSnapshot<Precision, RangeBits>;
+
+    /**
+     * @brief Record a value.
+     *
+     * @param value The value to record, values above the range are recorded in the last bucket.
+     */
+    void record(uint64_t value) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+        Stripe& stripe = mStripes[detail::stripeHint() % Stripes];
+        stripe.counts[Buckets::indexOf(value)].fetch_add(1, std::memory_order_relaxed);
+        stripe.sum.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Copy every recorded value.
+     *
+     * @return The merged stripes, values recorded while the snapshot is taken may or may not be included.
+     */
+    Snapshot snapshot() const noexcept {
+        Snapshot result;
+        for (const Stripe& stripe : mStripes) {
+            for (size_t i = 0; i < Buckets::kCount; i++) {
+                uint64_t count = stripe.counts[i].load(std::memory_order_relaxed);
+                result.mCounts[i] += count;
+                result.mTotal += count;
+            }
+
+            result.mSum += stripe.sum.load(std::memory_order_relaxed);
+        }
+
+        return result;
+    }
+
+    /**
+     * @brief Clear every recorded value.
+     *
+     * @warning Values recorded while the histogram is being reset may be partially cleared.
+     */
+    void reset() noexcept {
+        for (Stripe& stripe : mStripes) {
+            for (std::atomic<uint64_t>& count : stripe.counts) {
+                count.store(0, std::memory_order_relaxed);
+            }
+
+            stripe.sum.store(0, std::memory_order_relaxed);
+        }
+    }
+};
+
+using LatencyHistogram = BasicLatencyHistogram<>;
+
+/**
+ * @brief An element stamped with the time it was produced.
+ *
+ * Stored in a queue or mailbox in place of @p T so the consumer can record how long the element waited.
+ */
+template <typename T>
+struct Timestamped {
+    T value;
+    uint64_t timestamp;
+};
+
+/**
+ * @brief Records the time between stamping an element and consuming it into a histogram.
+ *
+ * Uses the same clocks as the limiting flags, elapsed times are recorded in the clock's native ticks.
+ *
+ * @code{.cpp}
+ * sm::concurrent::LatencyHistogram residency;
+ * sm::concurrent::LatencyRecorder recorder{residency};
+ *
+ * queue.tryEmplace(recorder.stamp(job));            // producer
+ * if (queue.tryPop(element)) recorder.record(element); // consumer
+ * @endcode
+ *
+ * @tparam Histogram The histogram to record into.
+ * @tparam Clock The clock to read.
+ */
+template <typename Histogram = LatencyHistogram, typename Clock = HighResolutionClock>
+#if __cpp_concepts >= 201907L
+    requires LimitingClock<Clock>
+#endif
+class LatencyRecorder {
+    Histogram* mHistogram;
+
+    [[no_unique_address]] Clock mClock;
+
+public:
+    /**
+     * @brief Construct a recorder.
+     *
+     * @param histogram The histogram to record into, must outlive the recorder.
+     * @param clock The clock to read.
+     */
+    explicit LatencyRecorder(Histogram& histogram, Clock clock = Clock{}) noexcept
+        : mHistogram(&histogram)
+        , mClock(std::move(clock)) {}
+
+    /**
+     * @brief Read the clock.
+     *
+     * @return The current time in clock ticks.
+     */
+    uint64_t now() const noexcept SM_CLANG_NONBLOCKING {
+        return mClock.now();
+    }
+
+    /**
+     * @brief Stamp an element with the current time.
+     *
+     * @param value The element.
+     *
+     * @return The stamped element.
+     */
+    template <typename T>
+    Timestamped<std::decay_t<T>> stamp(T&& value) const noexcept(std::is_nothrow_constructible_v<std::decay_t<T>, T&&>) {
+        return Timestamped<std::decay_t<T>>{std::forward<T>(value), now()};
+    }
+
+    /**
+     * @brief Record the time elapsed since @p since.
+     *
+     * @param since A time read from the same clock, times in the future record 0.
+     */
+    void record(uint64_t since) noexcept SM_CLANG_NONBLOCKING {
+        uint64_t current = now();
+        mHistogram->record((current > since) ? current - since : 0);
+    }
+
+    /**
+     * @brief Record how long a stamped element waited.
+     *
+     * @param element The element, its value is left untouched.
+     */
+    template <typename T>
+    void record(const Timestamped<T>& element) noexcept SM_CLANG_NONBLOCKING {
+        record(element.timestamp);
+    }
+};
+} // namespace sm::concurrent
@@ -0,0 +1,53 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <cstddef>
+
+/**
+ * @brief The cache line size assumed when separating fields onto their own lines.
+ *
+ * std::hardware_destructive_interference_size is not used as its value varies with compiler
+ * flags, which would silently change the layout of these types between translation units.
+ * Define this before including any concurrent header to override it.
+ */
+#if !defined(SM_CONCURRENT_CACHE_LINE_SIZE)
+#    if defined(__APPLE__) && defined(__aarch64__)
+#        define SM_CONCURRENT_CACHE_LINE_SIZE 128
+#    else
+#        define SM_CONCURRENT_CACHE_LINE_SIZE 64
+#    endif
+#endif
+
+namespace sm::concurrent {
+
+constexpr size_t kCacheLineSize = SM_CONCURRENT_CACHE_LINE_SIZE;
+
+/**
+ * @brief Layout policy that packs fields together.
+ *
+ * Uses the least memory, but fields written by producers and consumers may share a cache line.
+ */
+struct CompactLayout {
+    static constexpr size_t kAlignment = 1;
+};
+
+/**
+ * @brief Layout policy that places fields written by different threads on separate cache lines.
+ *
+ * Producer written, consumer written, and read mostly fields each start on their own cache line.
+ * This trades memory for fewer cross core invalidations.
+ */
+struct CacheAlignedLayout {
+    static constexpr size_t kAlignment = kCacheLineSize;
+};
+
+namespace detail {
+/**
+ * @brief The alignment a layout policy requires for a field of type @p T.
+ */
+template <typename Layout, typename T>
+constexpr size_t kLayoutAlignment = (Layout::kAlignment > alignof(T)) ? Layout::kAlignment : alignof(T);
+} // namespace detail
+
+} // namespace sm::concurrent
@@ -0,0 +1,191 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <simcoe/concurrent/annotations.hpp>
+#include <simcoe/concurrent/exports.hpp>
+
+#if __cpp_concepts >= 201907L
+#    include <concepts>
+#endif
+
+#if defined(__linux__)
+#    include <time.h>
+#endif
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#    include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#    include <x86intrin.h>
+#endif
+
+namespace sm::concurrent {
+
+#if __cpp_concepts >= 201907L
+/**
+ * @brief A clock used by limiting flags.
+ *
+ * now() returns the current time in native ticks and ticks() converts an interval into the same units,
+ * this lets flags compare times without converting every reading.
+ */
+template <typename T>
+concept LimitingClock = requires(const T clock, std::chrono::nanoseconds interval) {
+    { clock.now() } -> std::same_as<uint64_t>;
+    { clock.ticks(interval) } -> std::same_as<uint64_t>;
+};
+#endif
+
+/**
+ * @brief A clock that reads std::chrono::high_resolution_clock.
+ */
+struct HighResolutionClock {
+    using Clock = std::chrono::high_resolution_clock;
+
+    uint64_t now() const noexcept SM_CLANG_NONBLOCKING {
+        return static_cast<uint64_t>(Clock::now().time_since_epoch().count());
+    }
+
+    constexpr uint64_t ticks(std::chrono::nanoseconds interval) const noexcept SM_CLANG_NONBLOCKING {
+        return static_cast<uint64_t>(std::chrono::duration_cast<Clock::duration>(interval).count());
+    }
+};
+
+/**
+ * @brief A monotonic clock that trades resolution for a cheaper read.
+ *
+ * Reads CLOCK_MONOTONIC_COARSE on linux, which is updated once per scheduler tick,
+ * so intervals shorter than a few milliseconds are rounded up to the tick.
+ * Other platforms read std::chrono::steady_clock.
+ */
+struct CoarseMonotonicClock {
+    uint64_t now() const noexcept SM_CLANG_NONBLOCKING {
+#if defined(__linux__)
+        timespec time;
+        clock_gettime(CLOCK_MONOTONIC_COARSE, &time);
+        return static_cast<uint64_t>(time.tv_sec) * 1'000'000'000u + static_cast<uint64_t>(time.tv_nsec);
+#else
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    constexpr uint64_t ticks(std::chrono::nanoseconds interval) const noexcept SM_CLANG_NONBLOCKING {
+        return static_cast<uint64_t>(interval.count());
+    }
+};
+
+/**
+ * @brief A clock that reads the processor timestamp counter.
+ *
+ * Uses rdtsc on x86 and cntvct_el0 on aarch64, other platforms read std::chrono::steady_clock.
+ * The counter frequency is calibrated once at first use.
+ *
+ * @warning Requires an invariant timestamp counter that is synchronized between cores,
+ *          which is the case on any x86 processor from the last decade.
+ */
+struct TscClock {
+    uint64_t now() const noexcept SM_CLANG_NONBLOCKING {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+        return __rdtsc();
+#elif defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#elif defined(__aarch64__) && !defined(_MSC_VER)
+        uint64_t value;
+        asm volatile("mrs %0, cntvct_el0" : "=r"(value));
+        return value;
+#else
+        return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+    }
+
+    uint64_t ticks(std::chrono::nanoseconds interval) const noexcept {
+        constexpr uint64_t kNanosPerSecond = 1'000'000'000;
+
+        // Split the interval to avoid overflowing 64 bits for long intervals.
+        uint64_t count = static_cast<uint64_t>(interval.count());
+        uint64_t hz = frequency();
+        return (count / kNanosPerSecond) * hz + (count % kNanosPerSecond) * hz / kNanosPerSecond;
+    }
+
+    /**
+     * @brief Get the number of ticks per second.
+     *
+     * @return The calibrated frequency of the counter.
+     */
+    SM_CONCURRENT_API SM_CONCURRENT_INLINE static uint64_t frequency() noexcept;
+};
+
+/**
+ * @brief The frame counter read by FrameClock.
+ *
+ * Owned and advanced by the application, usually once per iteration of its main loop.
+ */
+class FrameCounter {
+    std::atomic<uint64_t> mFrame{0};
+
+public:
+    constexpr FrameCounter() noexcept = default;
+
+    /**
+     * @brief Advance the counter.
+     *
+     * @param frames The number of frames to advance by.
+     */
+    void advance(uint64_t frames = 1) noexcept SM_CLANG_NONBLOCKING {
+        mFrame.fetch_add(frames, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Get the current frame.
+     *
+     * @return The number of frames advanced so far.
+     */
+    uint64_t frame() const noexcept SM_CLANG_NONBLOCKING {
+        return mFrame.load(std::memory_order_relaxed);
+    }
+};
+
+/**
+ * @brief A clock that counts frames of an external FrameCounter.
+ *
+ * Reading the clock is a relaxed load. Intervals are converted to frames using the nominal
+ * frame period and rounded up, so an interval shorter than a frame still limits to once per frame.
+ */
+class FrameClock {
+    const FrameCounter* mCounter;
+    std::chrono::nanoseconds mPeriod;
+
+public:
+    /**
+     * @brief Construct a new frame clock.
+     *
+     * @param counter The counter to read, must outlive the clock.
+     * @param period The nominal duration of a frame.
+     */
+    constexpr FrameClock(const FrameCounter& counter, std::chrono::nanoseconds period) noexcept
+        : mCounter(&counter)
+        , mPeriod(period) {}
+
+    uint64_t now() const noexcept SM_CLANG_NONBLOCKING {
+        return mCounter->frame();
+    }
+
+    constexpr uint64_t ticks(std::chrono::nanoseconds interval) const noexcept SM_CLANG_NONBLOCKING {
+        return static_cast<uint64_t>((interval + mPeriod - std::chrono::nanoseconds(1)) / mPeriod);
+    }
+};
+
+#if __cpp_concepts >= 201907L
+static_assert(LimitingClock<HighResolutionClock>);
+static_assert(LimitingClock<CoarseMonotonicClock>);
+static_assert(LimitingClock<TscClock>);
+static_assert(LimitingClock<FrameClock>);
+#endif
+
+} // namespace sm::concurrent
+
+#if defined(SM_CONCURRENT_HEADER_ONLY)
+#    include <simcoe/concurrent/detail/limiting_clock_impl.hpp>
+#endif
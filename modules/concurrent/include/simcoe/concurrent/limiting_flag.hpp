@@ -2,6 +2,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <cstdint>
@@ -12,6 +13,8 @@
 #endif
 
 #include <simcoe/concurrent/annotations.hpp>
+#include <simcoe/concurrent/limiting_clock.hpp>
+#include <simcoe/concurrent/spin_wait.hpp>
 
 namespace sm::concurrent {
 
@@ -22,24 +25,98 @@ concept LimitingFlag = requires(T a) {
 };
 #endif
 
+namespace detail {
+constexpr uint64_t kIsSet = (1ull << 63);
+constexpr uint64_t kTimeMask = ~kIsSet;
+
+/**
+ * @brief Attempt to activate an at most every flag.
+ *
+ * The low 63 bits of @p state store the last activation time in clock ticks, the high bit is toggled
+ * on every activation so that two activations at the same tick still change the state.
+ * A state of zero has never been activated.
+ *
+ * @param state The state of the flag.
+ * @param now The current time in clock ticks.
+ * @param interval The minimum interval between activations in clock ticks.
+ *
+ * @return If the flag was activated by this call.
+ */
+inline bool tryActivate(std::atomic<uint64_t>& state, uint64_t now, uint64_t interval) noexcept SM_CLANG_NONBLOCKING {
+    uint64_t initialValue = state.load(std::memory_order_acquire);
+
+    uint64_t last = initialValue & kTimeMask;
+
+    //
+    // Times are 63 bits wide, sign extend the difference so that a reading from a clock
+    // slightly behind the one that last activated the flag does not pass the interval.
+    //
+    auto elapsed = static_cast<int64_t>((now - last) << 1) >> 1;
+    if (initialValue != 0 && elapsed < static_cast<int64_t>(interval)) {
+        return false;
+    }
+
+    uint64_t nextValue = (now & kTimeMask) | ((initialValue & kIsSet) ^ kIsSet);
+
+    return state.compare_exchange_strong(initialValue, nextValue, std::memory_order_release, std::memory_order_relaxed);
+}
+} // namespace detail
+
+/**
+ * @brief A limiting flag that activates at most once every specified interval, measured by @p Clock.
+ *
+ * @tparam Clock The clock policy, the interval is converted to clock ticks once on construction.
+ */
+template <typename Clock = HighResolutionClock>
+#if __cpp_concepts >= 201907L
+    requires LimitingClock<Clock>
+#endif
+class BasicAtMostEvery {
+    std::atomic<uint64_t> mLastActive{0};
+
+    uint64_t mInterval;
+
+    [[no_unique_address]] Clock mClock;
+
+public:
+    /**
+     * @brief Construct a new instance of BasicAtMostEvery.
+     *
+     * The flag starts inactive and can be activated immediately after construction.
+     *
+     * @param interval The minimum interval between activations.
+     * @param clock The clock to read.
+     */
+    constexpr BasicAtMostEvery(std::chrono::nanoseconds interval, Clock clock = Clock{}) noexcept
+        : mInterval(clock.ticks(interval))
+        , mClock(clock) {}
+
+    /**
+     * @brief Attempts to activate the flag.
+     *
+     * @return If the flag was activated by this call.
+     * @retval true if the flag was activated
+     * @retval false if the flag was not activated
+     */
+    bool isActive() noexcept SM_CLANG_NONBLOCKING {
+        return detail::tryActivate(mLastActive, mClock.now(), mInterval);
+    }
+};
+
 /**
  * @brief A limiting flag that activates at most once every specified interval.
  */
 class AtMostEvery {
-    static constexpr uint64_t kIsSet = (1ull << 63);
-    static constexpr uint64_t kTimeMask = ~kIsSet;
-
     /**
      * @brief The atomic state of the flag.
-     * The low 63 bits store the last activation time in 100ns units.
-     * The high bit stores whether the flag is currently set or not.
+     * @see detail::tryActivate
      */
     std::atomic<uint64_t> mLastActive;
 
     /**
-     * @brief The minimum interval between activations.
+     * @brief The minimum interval between activations in high resolution clock ticks.
      */
-    std::chrono::nanoseconds mInterval;
+    uint64_t mInterval;
 
 public:
     /**
@@ -51,7 +128,7 @@ public:
      */
     constexpr AtMostEvery(std::chrono::nanoseconds interval) noexcept
         : mLastActive(0)
-        , mInterval(interval) {}
+        , mInterval(HighResolutionClock{}.ticks(interval)) {}
 
     /**
      * @brief Attempts to activate the flag.
@@ -60,11 +137,134 @@ public:
      * @retval true if the flag was activated
      * @retval false if the flag was not activated
      */
-    SM_CONCURRENT_API bool isActive() noexcept SM_CLANG_NONBLOCKING;
+    SM_CONCURRENT_API SM_CONCURRENT_INLINE bool isActive() noexcept SM_CLANG_NONBLOCKING;
 };
 
+/**
+ * @brief A limiting flag that allows a sustained rate of activations with bursts.
+ *
+ * Implemented as the generic cell rate algorithm, rather than counting tokens the bucket stores
+ * the theoretical arrival time of the next activation in a single 64 bit word. Each activation pushes
+ * that time forward by the emission interval, and is allowed if the result is no further ahead of now
+ * than the burst allows. An acquire is a load and a compare exchange, retried only under contention.
+ *
+ * @code{.cpp}
+ * // Up to 100 activations per second, with bursts of up to 20.
+ * TokenBucket bucket{100, std::chrono::seconds(1), 20};
+ * @endcode
+ *
+ * @tparam Clock The clock policy.
+ */
+template <typename Clock = HighResolutionClock>
+#if __cpp_concepts >= 201907L
+    requires LimitingClock<Clock>
+#endif
+class BasicTokenBucket {
+    // The theoretical arrival time in clock ticks.
+    std::atomic<uint64_t> mArrival{0};
+
+    // The clock ticks between activations at the sustained rate.
+    uint64_t mEmission;
+
+    // How far ahead of now the arrival time may be, the burst size in clock ticks.
+    uint64_t mTolerance;
+
+    [[no_unique_address]] Clock mClock;
+
+public:
+    /**
+     * @brief Construct a new token bucket.
+     *
+     * The bucket starts full, so a burst is available immediately after construction.
+     *
+     * @param rate The number of activations allowed per @p period.
+     * @param period The period over which @p rate activations are allowed.
+     * @param burst The maximum number of activations allowed at once.
+     * @param clock The clock to read.
+     */
+    constexpr BasicTokenBucket(uint32_t rate, std::chrono::nanoseconds period, uint32_t burst, Clock clock = Clock{}) noexcept
+        : mEmission((std::max)(clock.ticks(period) / (std::max)(rate, 1u), uint64_t{1}))
+        , mTolerance(mEmission * burst)
+        , mClock(clock) {}
+
+    /**
+     * @brief Attempts to take @p count tokens from the bucket.
+     *
+     * @param count The number of tokens to take, requests larger than the burst size always fail.
+     *
+     * @return If the tokens were taken.
+     */
+    [[nodiscard]]
+    bool tryAcquire(uint32_t count) noexcept SM_CLANG_NONBLOCKING {
+        uint64_t now = mClock.now();
+        uint64_t increment = mEmission * count;
+
+        //
+        // Nothing is published by acquiring tokens, so relaxed ordering is enough.
+        //
+        uint64_t arrival = mArrival.load(std::memory_order_relaxed);
+        SpinWait spin{kRetrySpin};
+        while (true) {
+            uint64_t next = (std::max)(arrival, now) + increment;
+            if (next - now > mTolerance) {
+                return false;
+            }
+
+            if (mArrival.compare_exchange_weak(arrival, next, std::memory_order_relaxed)) {
+                return true;
+            }
+
+            spin.pause();
+        }
+    }
+
+    /**
+     * @brief Attempts to take a single token from the bucket.
+     *
+     * @return If the flag was activated by this call.
+     * @retval true if the flag was activated
+     * @retval false if the flag was not activated
+     */
+    bool isActive() noexcept SM_CLANG_NONBLOCKING {
+        return tryAcquire(1);
+    }
+};
+
+using TokenBucket = BasicTokenBucket<>;
+
 #if __cpp_concepts >= 201907L
 static_assert(LimitingFlag<AtMostEvery>);
+static_assert(LimitingFlag<BasicAtMostEvery<CoarseMonotonicClock>>);
+static_assert(LimitingFlag<TokenBucket>);
 #endif
 
 } // namespace sm::concurrent
+
+/**
+ * @brief Evaluates to true at most once every @p interval for each place it is used.
+ *
+ * Declares a static AtMostEvery at the call site, @p interval must be a constant expression.
+ *
+ * @code{.cpp}
+ * if (SM_RATE_LIMITED(std::chrono::seconds(1))) {
+ *     log("queue is full");
+ * }
+ * @endcode
+ */
+#if __cpp_constinit >= 201907L
+#    define SM_RATE_LIMITED(interval)                                          \
+        ([]() noexcept -> bool {                                               \
+            static constinit ::sm::concurrent::AtMostEvery sFlag_{(interval)}; \
+            return sFlag_.isActive();                                          \
+        }())
+#else
+#    define SM_RATE_LIMITED(interval)                                \
+        ([]() noexcept -> bool {                                     \
+            static ::sm::concurrent::AtMostEvery sFlag_{(interval)}; \
+            return sFlag_.isActive();                                \
+        }())
+#endif
+
+#if defined(SM_CONCURRENT_HEADER_ONLY)
+#    include <simcoe/concurrent/detail/limiting_flag_impl.hpp>
+#endif
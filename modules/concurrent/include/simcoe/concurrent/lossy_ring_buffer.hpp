@@ -0,0 +1,414 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <new>
+#include <optional>
+#include <simcoe/concurrent/annotations.hpp>
+#include <simcoe/concurrent/capacity.hpp>
+#include <simcoe/concurrent/layout.hpp>
+#include <simcoe/concurrent/spin_wait.hpp>
+#include <type_traits>
+#include <utility>
+
+namespace sm::concurrent {
+/**
+ * @brief A fixed size, multi-producer single-consumer, wait free, reentrant ringbuffer that overwrites its oldest values.
+ *
+ * Intended for telemetry where the most recent window matters more than completeness. A push never fails,
+ * when the buffer is full it replaces the oldest value that has not been consumed and counts it as dropped.
+ *
+ * Each slot carries a sequence that records which position last claimed it and whether the value is being
+ * written, ready, or consumed. Producers claim a position with a single fetch_add and take the slot with one
+ * compare exchange, if the slot is still being written by a producer a whole lap behind, the new value is
+ * dropped instead so that two producers never write the same slot. The dropping producer hands its position
+ * to the writer, which then publishes the slot as consumed at that position rather than publishing its own
+ * stale value, so the consumer moves past the slot instead of waiting a lap for it to be overwritten.
+ * The consumer copies a value out and then marks it consumed with a compare exchange, which fails if a
+ * producer overwrote it in the meantime.
+ *
+ * Values are copied through atomic words so that a value being overwritten while it is read is never a data race,
+ * which restricts T to trivially copyable types.
+ *
+ * @tparam T The type of elements stored in the ring buffer, must be trivially copyable.
+ * @tparam Allocator The allocator type used to allocate and deallocate memory for the ring buffer.
+ * @tparam Capacity The policy used to validate the capacity and map positions onto slots.
+ * @tparam Layout The layout policy, CacheAlignedLayout separates the producer and consumer positions.
+ */
+template <typename T, typename Allocator = std::allocator<T>, typename Capacity = DynamicCapacity, typename Layout = CacheAlignedLayout>
+#if __cpp_concepts >= 201907L
+    requires std::is_trivially_copyable_v<T> && std::is_nothrow_default_constructible_v<Allocator> && CapacityPolicy<Capacity>
+#endif
+class LossyRingBuffer {
+public:
+    using size_type = uint32_t;
+    using value_type = T;
+    using allocator_type = Allocator;
+
+private:
+    // Positions are 64 bit so they never wrap.
+    using Position = uint64_t;
+
+    using Word = uint64_t;
+
+    static constexpr size_t kWordCount = (sizeof(T) + sizeof(Word) - 1) / sizeof(Word);
+
+    //
+    // The sequence of a slot is four times the position that last claimed it plus one of these states.
+    // A sequence of zero is a slot that has never been written.
+    //
+    static constexpr Position kWriting = 1;
+    static constexpr Position kReady = 2;
+    static constexpr Position kConsumed = 3;
+
+    static constexpr Position sequenceOf(Position position, Position state) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+        return position * 4 + state;
+    }
+
+    struct Slot {
+        std::atomic<Position> sequence{0};
+
+        std::atomic<Word> words[kWordCount]{};
+    };
+
+    using SlotAllocator = std::allocator_traits<Allocator>::template rebind_alloc<Slot>;
+
+    //
+    // Read mostly fields.
+    //
+    [[no_unique_address]] SlotAllocator mAllocator{};
+
+    Slot* mSlots{};
+
+    size_type mCapacity{};
+
+    //
+    // Fields written by producers.
+    //
+    alignas(detail::kLayoutAlignment<Layout, std::atomic<Position>>) std::atomic<Position> mHead{};
+
+    std::atomic<uint64_t> mDropped{};
+
+    //
+    // Fields written by the consumer.
+    //
+    // Only atomic so that count can be read from other threads.
+    alignas(detail::kLayoutAlignment<Layout, std::atomic<Position>>) std::atomic<Position> mTail{};
+
+    Slot& getSlotAt(Position position) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+        return mSlots[Capacity::normalize(position, Position{mCapacity})];
+    }
+
+    // Copy the oldest value that has not been overwritten into @p words and mark it consumed.
+    bool tryPopWords(Word (&words)[kWordCount]) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+        Position tail = mTail.load(std::memory_order_relaxed);
+        while (true) {
+            Position head = mHead.load(std::memory_order_acquire);
+            if (tail >= head) {
+                break;
+            }
+
+            // Everything more than a lap behind the head has been claimed by newer producers.
+            if (head - tail > mCapacity) {
+                tail = head - mCapacity;
+            }
+
+            Slot& slot = getSlotAt(tail);
+            Position sequence = slot.sequence.load(std::memory_order_acquire);
+            Position ready = sequenceOf(tail, kReady);
+            if (sequence < ready) {
+                // The producer of this position has not published yet, or it dropped its value and the
+                // producer from an earlier lap that is still writing the slot has not finished.
+                break;
+            }
+
+            if (sequence == ready) {
+                for (size_t i = 0; i < kWordCount; i++) {
+                    words[i] = slot.words[i].load(std::memory_order_relaxed);
+                }
+
+                //
+                // The copy is only valid if no producer took the slot while it was read.
+                //
+                if (slot.sequence.compare_exchange_strong(sequence, sequenceOf(tail, kConsumed), std::memory_order_acq_rel)) {
+                    mTail.store(tail + 1, std::memory_order_relaxed);
+                    return true;
+                }
+            }
+
+            // Overwritten by a later lap or dropped on push, the producer that dropped it counted the drop.
+            tail += 1;
+        }
+
+        mTail.store(tail, std::memory_order_relaxed);
+        return false;
+    }
+
+    void clear() noexcept {
+        if (mSlots != nullptr) {
+            std::destroy_n(mSlots, mCapacity);
+            mAllocator.deallocate(mSlots, mCapacity);
+
+            mSlots = nullptr;
+            mCapacity = 0;
+        }
+    }
+
+    constexpr LossyRingBuffer(Slot* slots, size_type capacity, Allocator allocator) noexcept
+        : mAllocator(std::move(allocator))
+        , mSlots(slots)
+        , mCapacity(capacity) {}
+
+public:
+    constexpr LossyRingBuffer() noexcept = default;
+
+    LossyRingBuffer(const LossyRingBuffer& other) = delete;
+    LossyRingBuffer& operator=(const LossyRingBuffer& other) = delete;
+
+    /**
+     * @brief Move construct a ring buffer.
+     *
+     * @note This function is not thread-safe and should only be called when no other threads are accessing the queue.
+     *
+     * @param other The other ring buffer to move from.
+     */
+    constexpr LossyRingBuffer(LossyRingBuffer&& other) noexcept
+        : mAllocator(std::move(other.mAllocator))
+        , mSlots(std::exchange(other.mSlots, nullptr))
+        , mCapacity(std::exchange(other.mCapacity, 0))
+        , mHead(other.mHead.load())
+        , mDropped(other.mDropped.load())
+        , mTail(other.mTail.load()) {}
+
+    /**
+     * @brief Move assign a ring buffer.
+     *
+     * @note This function is not thread-safe and should only be called when no other threads are accessing the queue.
+     *
+     * @param other The other ring buffer to move from.
+     * @return The moved ring buffer.
+     */
+    constexpr LossyRingBuffer& operator=(LossyRingBuffer&& other) noexcept {
+        if (this != &other) {
+            clear();
+
+            mAllocator = std::move(other.mAllocator);
+            mSlots = std::exchange(other.mSlots, nullptr);
+            mCapacity = std::exchange(other.mCapacity, 0);
+            mHead.store(other.mHead.load());
+            mDropped.store(other.mDropped.load());
+            mTail.store(other.mTail.load());
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Destroy the ring buffer.
+     */
+    ~LossyRingBuffer() noexcept {
+        clear();
+    }
+
+    /**
+     * @brief Push a value, overwriting the oldest unconsumed value if the buffer is full.
+     *
+     * Wait free and safe to call from a signal handler. A compare exchange is only retried when a producer
+     * from a later lap takes the same slot at the same time, once for each such producer.
+     *
+     * @param value The value to push.
+     */
+    void push(const T& value) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+        Position position = mHead.fetch_add(1);
+        Slot& slot = getSlotAt(position);
+
+        Position sequence = slot.sequence.load(std::memory_order_acquire);
+        Position writing = sequenceOf(position, kWriting);
+
+        SpinWait spin{kRetrySpin};
+        while (true) {
+            // A producer from a later lap already took the slot.
+            if (sequence >= writing) {
+                mDropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            //
+            // A producer from an earlier lap is still writing, drop the value rather than wait and leave this
+            // position in the sequence so the writer publishes the slot as consumed here instead of its stale value.
+            //
+            if ((sequence % 4) == kWriting) {
+                if (slot.sequence.compare_exchange_weak(sequence, writing, std::memory_order_acquire)) {
+                    mDropped.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+
+                spin.pause();
+                continue;
+            }
+
+            if (slot.sequence.compare_exchange_weak(sequence, writing, std::memory_order_acquire)) {
+                break;
+            }
+
+            spin.pause();
+        }
+
+        if ((sequence % 4) == kReady) {
+            // The value from the previous lap was never consumed.
+            mDropped.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        Word words[kWordCount]{};
+        std::memcpy(words, &value, sizeof(T));
+        for (size_t i = 0; i < kWordCount; i++) {
+            slot.words[i].store(words[i], std::memory_order_relaxed);
+        }
+
+        Position expected = writing;
+        if (!slot.sequence.compare_exchange_strong(expected, sequenceOf(position, kReady), std::memory_order_release, std::memory_order_relaxed)) {
+            //
+            // Producers from later laps dropped their values while this one was written, the value is a lap
+            // stale so drop it too and mark the slot consumed at the newest of their positions.
+            //
+            mDropped.fetch_add(1, std::memory_order_relaxed);
+            spin.reset();
+            while (!slot.sequence.compare_exchange_weak(expected, sequenceOf(expected / 4, kConsumed), std::memory_order_release, std::memory_order_relaxed)) {
+                spin.pause();
+            }
+        }
+    }
+
+    /**
+     * @brief Try to pop the oldest value that has not been overwritten.
+     *
+     * Must only be called from the consumer thread.
+     * If a value is successfully popped, it is copied into @p value, otherwise @p value is left unchanged.
+     *
+     * @param value The value to pop into.
+     *
+     * @return true if a value was popped, false if the buffer was empty or the oldest value is still being written.
+     */
+    [[nodiscard]]
+    bool tryPop(T& value) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+        Word words[kWordCount];
+        if (!tryPopWords(words)) {
+            return false;
+        }
+
+        std::memcpy(&value, words, sizeof(T));
+        return true;
+    }
+
+    /**
+     * @brief Visit and remove up to @p limit values from the queue.
+     *
+     * Must only be called from the consumer thread.
+     *
+     * @param visitor The function to invoke with a copy of each value, must not throw.
+     * @param limit The maximum number of values to remove.
+     *
+     * @return The number of values removed.
+     */
+    template <typename F>
+#if __cpp_concepts >= 201907L
+        requires std::is_nothrow_invocable_v<F&, T&>
+#endif
+    size_type drain(F&& visitor, size_type limit = (std::numeric_limits<size_type>::max)()) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+        size_type popped = 0;
+        Word words[kWordCount];
+        while (popped < limit && tryPopWords(words)) {
+            // T may not be default constructible, copying the bytes into storage creates the value.
+            alignas(T) std::byte storage[sizeof(T)];
+            std::memcpy(storage, words, sizeof(T));
+            visitor(*std::launder(reinterpret_cast<T*>(storage)));
+            popped += 1;
+        }
+
+        return popped;
+    }
+
+    /**
+     * @brief Get the number of values that were overwritten before they were consumed, or dropped on push.
+     *
+     * @return The number of dropped values.
+     */
+    uint64_t dropped() const noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+        return mDropped.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Get an estimate of the number of items in the queue.
+     *
+     * @warning As this is a lock-free structure the count will be immediately out of date.
+     *
+     * @return The number of items in the queue.
+     */
+    size_type count() const noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+        Position tail = mTail.load();
+        Position head = mHead.load();
+
+        return (head > tail) ? static_cast<size_type>((std::min)(head - tail, Position{mCapacity})) : 0;
+    }
+
+    /**
+     * @brief Get the maximum capacity of the queue.
+     *
+     * @return The maximum number of items the queue can hold.
+     */
+    size_type capacity() const noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+        return mCapacity;
+    }
+
+    /**
+     * @brief Get the Allocator object used by the ring buffer.
+     *
+     * @return The allocator.
+     */
+    allocator_type getAllocator() const noexcept {
+        return allocator_type(mAllocator);
+    }
+
+    /**
+     * @brief Provided for compatibility with standard containers.
+     *
+     * This is equivalent to `getAllocator()`.
+     *
+     * @return The allocator.
+     */
+    allocator_type get_allocator() const noexcept {
+        return allocator_type(mAllocator);
+    }
+
+    /**
+     * @brief Create a new queue with the given capacity.
+     *
+     * @param capacity The number of most recent elements the queue keeps, must be accepted by the capacity policy.
+     * @param allocator The allocator used to allocate and deallocate the storage.
+     *
+     * @return The ring buffer if it was created successfully, std::nullopt otherwise.
+     */
+    [[nodiscard]]
+    static std::optional<LossyRingBuffer> create(size_type capacity, Allocator allocator = Allocator{}) noexcept {
+        if (!Capacity::isValid(capacity)) {
+            return std::nullopt;
+        }
+
+        SlotAllocator slotAllocator{allocator};
+        Slot* slots = slotAllocator.allocate(capacity);
+        if (slots == nullptr) {
+            return std::nullopt;
+        }
+
+        std::uninitialized_default_construct_n(slots, capacity);
+
+        return LossyRingBuffer{slots, capacity, std::move(allocator)};
+    }
+};
+} // namespace sm::concurrent
@@ -2,15 +2,34 @@
 
 #pragma once
 
+#include <algorithm>
 #include <atomic>
-
-#if __cpp_concepts >= 201907L
-#    include <type_traits>
-#endif
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
 
 #include <simcoe/concurrent/annotations.hpp>
+#include <simcoe/concurrent/coroutine.hpp>
+#include <simcoe/concurrent/layout.hpp>
+#include <simcoe/concurrent/spin_wait.hpp>
+#include <simcoe/concurrent/stats.hpp>
 
 namespace sm::concurrent {
+/**
+ * @brief The counters recorded by an AtomicMailbox with a stats policy.
+ */
+enum class MailboxCounter {
+    // The writer polled the state while the reader held the back slot.
+    eWriterSpins,
+
+    eCount
+};
+
+constexpr bool isHighWaterMark(MailboxCounter) noexcept {
+    return false;
+}
+
 /**
  * @brief Single producer single consumer non-blocking mailbox.
  *
@@ -35,9 +54,13 @@ namespace sm::concurrent {
  * }
  * @endcode
  *
+ * Coroutines can wait for the next write with `co_await mailbox.next()` and then read it as above.
+ *
  * @tparam T The type of data to be communicated.
+ * @tparam Layout The layout policy, CacheAlignedLayout places the state and each slot on their own cache lines.
+ * @tparam Stats The stats policy, AtomicStats records MailboxCounter.
  */
-template <typename T>
+template <typename T, typename Layout = CompactLayout, typename Stats = NoStats>
 #if __cpp_concepts >= 201907L
     requires std::is_default_constructible_v<T> && std::is_nothrow_move_assignable_v<T>
 #endif
@@ -45,14 +68,45 @@ class AtomicMailbox {
     static constexpr int kIndexBit = (1 << 0);
     static constexpr int kWriteBit = (1 << 1);
 
-    // clang bug maybe, on linux adding this alignas causes clang to
-    // generate all kinds of strange layout info for this class.
-    // on windows it works fine, the performance difference is well into
-    // placebo territory so i'll leave it out for now.
-    // alignas(std::hardware_destructive_interference_size)
-    std::atomic<int> mState{};
+    // The remaining bits of the state count commits so that next() can tell when a write was missed.
+    static constexpr unsigned kGenerationStep = (1 << 2);
+
+    // How the writer backs off while the reader holds the back slot, the reader does not wake it
+    // so it keeps yielding rather than park.
+    static constexpr SpinPolicy kWriterSpin{.pauseRounds = 6, .maxPauses = 32, .yieldRounds = 1};
+
+    struct alignas(detail::kLayoutAlignment<Layout, T>) Slot {
+        T value{};
+    };
+
+    // clang bug maybe, on linux aligning this causes clang to generate all kinds
+    // of strange layout info for this class, so the aligned layout is opt in.
+    alignas(detail::kLayoutAlignment<Layout, std::atomic<int>>) std::atomic<int> mState{};
+
+    // Non-zero while the reader is suspended in next().
+    std::atomic<uint32_t> mWaiting{};
 
-    T mSlots[2]{};
+    // The suspended reader, only valid while mWaiting is non-zero.
+    detail::CoroutineWaiter* mWaiter{};
+
+    // The generation the last awaited next() returned at, only accessed by the reader.
+    unsigned mSeen{};
+
+    Slot mSlots[2]{};
+
+    [[no_unique_address]] typename Stats::template Storage<MailboxCounter> mStats{};
+
+    unsigned generation() const noexcept SM_CLANG_NONBLOCKING {
+        return static_cast<unsigned>(mState.load()) / kGenerationStep;
+    }
+
+    void wakeReader() noexcept SM_CLANG_NONBLOCKING {
+        if (mWaiting.load() != 0) [[unlikely]] {
+            if (mWaiting.exchange(0) != 0) {
+                mWaiter->resume(mWaiter);
+            }
+        }
+    }
 
 public:
     constexpr AtomicMailbox() noexcept = default;
@@ -79,7 +133,59 @@ public:
      */
     const T& read() const noexcept SM_CLANG_NONBLOCKING {
         std::size_t index = !(mState.load(std::memory_order_acquire) & kIndexBit);
-        return mSlots[index];
+        return mSlots[index].value;
+    }
+
+    /**
+     * @brief Begin writing to the mailbox in place.
+     *
+     * Waits until the back slot is free and returns it, the slot holds the value written two writes ago
+     * so buffers owned by T can be reused. The write must be published with commit().
+     *
+     * @return The back slot.
+     */
+    [[nodiscard]]
+    T& beginWrite() noexcept SM_CLANG_BLOCKING {
+        int state = 0;
+        uint64_t spins = 0;
+        SpinWait spin{kWriterSpin};
+        while ((state = mState.load(std::memory_order_acquire)) & kWriteBit) {
+            spins += 1;
+            spin.spinOnce();
+        }
+
+        mStats.add(MailboxCounter::eWriterSpins, spins);
+        return mSlots[state & kIndexBit].value;
+    }
+
+    /**
+     * @brief Publish the slot returned by beginWrite().
+     *
+     * Resumes the reader if it is suspended in next().
+     */
+    void commit() noexcept SM_CLANG_NONBLOCKING {
+        unsigned state = static_cast<unsigned>(mState.load(std::memory_order_acquire));
+
+        //
+        // Sequentially consistent so that either the reader sees this write after registering
+        // in next() or we see its registration.
+        //
+        mState.store(static_cast<int>((state ^ (kIndexBit | kWriteBit)) + kGenerationStep));
+        wakeReader();
+    }
+
+    /**
+     * @brief Writes data to the mailbox in place.
+     *
+     * @param fill The function to invoke with the back slot before it is published, must not throw.
+     */
+    template <typename F>
+#if __cpp_concepts >= 201907L
+        requires std::is_nothrow_invocable_v<F&, T&>
+#endif
+    void writeInPlace(F&& fill) noexcept SM_CLANG_BLOCKING {
+        fill(beginWrite());
+        commit();
     }
 
     /**
@@ -88,16 +194,358 @@ public:
      * @param data The data to write.
      */
     void write(T data) SM_CLANG_BLOCKING {
-        int state = 0;
-        while ((state = mState.load(std::memory_order_acquire)) & kWriteBit) {
-            /* spin */
+        beginWrite() = std::move(data);
+        commit();
+    }
+
+    /**
+     * @brief Get a snapshot of the counters recorded by the stats policy.
+     *
+     * @return The counters, every counter is zero with NoStats.
+     */
+    StatsSnapshot<MailboxCounter> stats() const noexcept {
+        return mStats.snapshot();
+    }
+
+#if __cpp_impl_coroutine >= 201902L
+    /**
+     * @brief The awaitable returned by next(), resumes once a write has been committed.
+     *
+     * @tparam Scheduler The hook used to resume the coroutine when the writer commits.
+     */
+    template <typename Scheduler>
+    class NextAwaiter final : detail::ScheduledWaiter<Scheduler> {
+        AtomicMailbox* mMailbox;
+
+    public:
+        NextAwaiter(AtomicMailbox* mailbox, Scheduler scheduler) noexcept
+            : detail::ScheduledWaiter<Scheduler>(scheduler)
+            , mMailbox(mailbox) {}
+
+        bool await_ready() noexcept SM_CLANG_NONBLOCKING {
+            return mMailbox->generation() != mMailbox->mSeen;
+        }
+
+        void await_suspend(std::coroutine_handle<> handle) noexcept SM_CLANG_NONBLOCKING {
+            // The writer may resume the coroutine and destroy this awaiter as soon as it is registered.
+            AtomicMailbox* mailbox = mMailbox;
+            unsigned seen = mailbox->mSeen;
+
+            this->mHandle = handle;
+            mailbox->mWaiter = this;
+            mailbox->mWaiting.store(1);
+
+            //
+            // A commit before the registration did not see it, take the registration back
+            // through the same path as the writer so that only one side ever resumes the coroutine.
+            //
+            if (mailbox->generation() != seen) {
+                mailbox->wakeReader();
+            }
+        }
+
+        void await_resume() noexcept SM_CLANG_NONBLOCKING {
+            mMailbox->mSeen = mMailbox->generation();
+        }
+    };
+
+    /**
+     * @brief Wait for the next write from a coroutine.
+     *
+     * Completes immediately if a write was committed since the last awaited next() completed, otherwise
+     * suspends the coroutine until the writer commits and resumes it through @p scheduler.
+     * The waiter lives in the awaiter so suspending does not allocate, only one next() may be awaited at a time.
+     *
+     * @code{.cpp}
+     * Task reader(AtomicMailbox<MyData>& mailbox) {
+     *     while (true) {
+     *         co_await mailbox.next();
+     *         std::lock_guard guard(mailbox);
+     *         // process mailbox.read()...
+     *     }
+     * }
+     * @endcode
+     *
+     * @param scheduler The hook used to resume the coroutine, it runs on the writer's thread.
+     *
+     * @return The awaitable.
+     */
+    template <typename Scheduler = InlineScheduler>
+#    if __cpp_concepts >= 201907L
+        requires CoroutineScheduler<Scheduler>
+#    endif
+    [[nodiscard]]
+    NextAwaiter<Scheduler> next(Scheduler scheduler = Scheduler{}) noexcept {
+        return NextAwaiter<Scheduler>{this, scheduler};
+    }
+#endif
+};
+
+/**
+ * @brief Single producer single consumer wait free mailbox.
+ *
+ * Uses three slots so that neither side ever waits. The writer always owns a back slot
+ * and publishes it by exchanging it with the shared middle slot, the reader takes the
+ * middle slot when locking if it holds newer data than the front slot it already owns.
+ * Has the same interface as AtomicMailbox, at the cost of one more slot.
+ *
+ * @code{.cpp}
+ * TripleBufferMailbox<MyData> mailbox;
+ *
+ * // Writer thread, never waits for the reader
+ * {
+ *     mailbox.write(MyData{...});
+ * }
+ *
+ * // Reader thread, sees the latest complete write
+ * {
+ *     std::lock_guard guard(mailbox);
+ *     const MyData& data = mailbox.read();
+ *     // process data...
+ * }
+ * @endcode
+ *
+ * @tparam T The type of data to be communicated.
+ * @tparam Layout The layout policy, CacheAlignedLayout places the shared state, the fields owned by
+ *                each side, and each slot on their own cache lines.
+ */
+template <typename T, typename Layout = CompactLayout>
+#if __cpp_concepts >= 201907L
+    requires std::is_default_constructible_v<T> && std::is_nothrow_move_assignable_v<T>
+#endif
+class TripleBufferMailbox {
+    static constexpr uint8_t kIndexMask = 0b11;
+    static constexpr uint8_t kDirtyBit = (1 << 2);
+
+    struct alignas(detail::kLayoutAlignment<Layout, T>) Slot {
+        T value{};
+    };
+
+    // The index of the middle slot, and whether it holds data the reader has not taken yet.
+    alignas(detail::kLayoutAlignment<Layout, std::atomic<uint8_t>>) std::atomic<uint8_t> mShared{1};
+
+    // Only accessed by the writer.
+    alignas(detail::kLayoutAlignment<Layout, uint8_t>) uint8_t mBack{2};
+
+    // Only accessed by the reader.
+    alignas(detail::kLayoutAlignment<Layout, uint8_t>) uint8_t mFront{0};
+
+    Slot mSlots[3]{};
+
+public:
+    constexpr TripleBufferMailbox() noexcept = default;
+
+    /**
+     * @brief Locks the mailbox for reading.
+     *
+     * Takes the most recently published slot if it is newer than the one currently being read.
+     */
+    void lock() noexcept SM_CLANG_NONBLOCKING {
+        if (mShared.load(std::memory_order_relaxed) & kDirtyBit) {
+            mFront = mShared.exchange(mFront, std::memory_order_acq_rel) & kIndexMask;
+        }
+    }
+
+    /**
+     * @brief Unlocks the mailbox after reading.
+     *
+     * @note This function is a no-op and exists to allow usage with std::lock_guard.
+     */
+    void unlock() noexcept SM_CLANG_NONBLOCKING {}
+
+    /**
+     * @brief Reads the latest data from the mailbox.
+     * @note Requires the mailbox to be locked.
+     *
+     * @return The most recent data as of the last lock.
+     */
+    const T& read() const noexcept SM_CLANG_NONBLOCKING {
+        return mSlots[mFront].value;
+    }
+
+    /**
+     * @brief Writes data to the mailbox.
+     *
+     * Never waits for the reader, a write that replaces one the reader has not taken yet discards it.
+     *
+     * @param data The data to write.
+     */
+    void write(T data) noexcept SM_CLANG_NONBLOCKING {
+        beginWrite() = std::move(data);
+        commit();
+    }
+
+    /**
+     * @brief Begin writing to the mailbox in place.
+     *
+     * Returns the back slot, which holds an older value so buffers owned by T can be reused.
+     * The write must be published with commit().
+     *
+     * @return The back slot.
+     */
+    [[nodiscard]]
+    T& beginWrite() noexcept SM_CLANG_NONBLOCKING {
+        return mSlots[mBack].value;
+    }
+
+    /**
+     * @brief Publish the slot returned by beginWrite().
+     */
+    void commit() noexcept SM_CLANG_NONBLOCKING {
+        mBack = mShared.exchange(mBack | kDirtyBit, std::memory_order_acq_rel) & kIndexMask;
+    }
+
+    /**
+     * @brief Writes data to the mailbox in place.
+     *
+     * @param fill The function to invoke with the back slot before it is published, must not throw.
+     */
+    template <typename F>
+#if __cpp_concepts >= 201907L
+        requires std::is_nothrow_invocable_v<F&, T&>
+#endif
+    void writeInPlace(F&& fill) noexcept SM_CLANG_NONBLOCKING {
+        fill(beginWrite());
+        commit();
+    }
+};
+
+/**
+ * @brief Single producer multiple consumer broadcast mailbox, writes are wait free and reads are lock free.
+ *
+ * A seqlock, the writer makes the sequence odd, copies the data in, and makes it even again.
+ * Readers copy the data out and retry if the sequence changed while they were copying,
+ * so any number of readers can share one mailbox and the writer never waits for them.
+ * The data is stored as relaxed atomic words so a torn read is never a data race.
+ *
+ * @code{.cpp}
+ * BroadcastMailbox<MyData> mailbox;
+ *
+ * // Writer thread
+ * {
+ *     mailbox.write(MyData{...});
+ * }
+ *
+ * // Any number of reader threads
+ * {
+ *     if (mailbox.version() != lastVersion) {
+ *         lastVersion = mailbox.read(data);
+ *         // process data...
+ *     }
+ * }
+ * @endcode
+ *
+ * @warning Only one thread may write at a time.
+ *
+ * @tparam T The type of data to be communicated, must be trivially copyable.
+ * @tparam Layout The layout policy, CacheAlignedLayout starts the mailbox on its own cache line.
+ *
+ * @cite BoehmSeqlocks Can Seqlocks Get Along With Programming Language Memory Models?
+ */
+template <typename T, typename Layout = CompactLayout>
+#if __cpp_concepts >= 201907L
+    requires std::is_trivially_copyable_v<T>
+#endif
+class BroadcastMailbox {
+    using Word = uint64_t;
+
+    static constexpr size_t kWordCount = (sizeof(T) + sizeof(Word) - 1) / sizeof(Word);
+
+    alignas(detail::kLayoutAlignment<Layout, std::atomic<uint64_t>>) std::atomic<uint64_t> mSequence{};
+
+    std::atomic<Word> mWords[kWordCount]{};
+
+    void copyIn(const T& value) noexcept SM_CLANG_NONBLOCKING {
+        const std::byte* bytes = reinterpret_cast<const std::byte*>(&value);
+        for (size_t i = 0; i < kWordCount; i++) {
+            Word word = 0;
+            std::memcpy(&word, bytes + i * sizeof(Word), (std::min)(sizeof(Word), sizeof(T) - i * sizeof(Word)));
+            mWords[i].store(word, std::memory_order_relaxed);
         }
+    }
+
+    void copyOut(T& value) const noexcept SM_CLANG_NONBLOCKING {
+        std::byte* bytes = reinterpret_cast<std::byte*>(&value);
+        for (size_t i = 0; i < kWordCount; i++) {
+            Word word = mWords[i].load(std::memory_order_relaxed);
+            std::memcpy(bytes + i * sizeof(Word), &word, (std::min)(sizeof(Word), sizeof(T) - i * sizeof(Word)));
+        }
+    }
 
-        int newIndex = (state & kIndexBit);
+public:
+    constexpr BroadcastMailbox() noexcept = default;
+
+    /**
+     * @brief Try to copy the latest data out of the mailbox once.
+     *
+     * @param value Receives the data, its contents are unspecified if the read failed.
+     * @param version Receives the version of the data read.
+     *
+     * @return true if the copy is consistent, false if it raced with a write.
+     */
+    [[nodiscard]]
+    bool tryRead(T& value, uint64_t& version) const noexcept SM_CLANG_NONBLOCKING {
+        uint64_t before = mSequence.load(std::memory_order_acquire);
+        if (before & 1) {
+            return false;
+        }
+
+        copyOut(value);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (mSequence.load(std::memory_order_relaxed) != before) {
+            return false;
+        }
+
+        version = before >> 1;
+        return true;
+    }
+
+    /**
+     * @brief Copy the latest data out of the mailbox.
+     *
+     * Retries until it gets a copy that did not race with a write.
+     *
+     * @param value Receives the data.
+     *
+     * @return The version of the data read.
+     */
+    uint64_t read(T& value) const noexcept SM_CLANG_NONBLOCKING {
+        uint64_t version = 0;
+        SpinWait spin{kRetrySpin};
+        while (!tryRead(value, version)) {
+            // The writer never waits, so it only holds the sequence odd for as long as a copy takes.
+            spin.pause();
+        }
+
+        return version;
+    }
+
+    /**
+     * @brief Get the version of the most recently completed write.
+     *
+     * The version starts at zero and increases by one with each write, readers can compare it
+     * against the version of their last read to skip copying data that has not changed.
+     *
+     * @return The current version.
+     */
+    uint64_t version() const noexcept SM_CLANG_NONBLOCKING {
+        return mSequence.load(std::memory_order_acquire) >> 1;
+    }
+
+    /**
+     * @brief Writes data to the mailbox.
+     *
+     * @param value The data to write.
+     */
+    void write(const T& value) noexcept SM_CLANG_NONBLOCKING {
+        uint64_t sequence = mSequence.load(std::memory_order_relaxed);
+        mSequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
 
-        mSlots[newIndex] = std::move(data);
+        copyIn(value);
 
-        mState.store(state ^ (kIndexBit | kWriteBit), std::memory_order_release);
+        mSequence.store(sequence + 2, std::memory_order_release);
     }
 };
 } // namespace sm::concurrent
@@ -0,0 +1,355 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <new>
+#include <optional>
+#include <simcoe/concurrent/annotations.hpp>
+#include <simcoe/concurrent/capacity.hpp>
+#include <simcoe/concurrent/layout.hpp>
+#include <simcoe/concurrent/spin_wait.hpp>
+#include <type_traits>
+
+namespace sm::concurrent {
+/**
+ * @brief A fixed size, multi-producer multi-consumer, lock free atomic ringbuffer.
+ *
+ * Every slot carries a sequence number that tells producers and consumers whose turn it is to use the slot.
+ * A producer claims a position with a compare exchange on the enqueue position once the slot at that position
+ * is free for it, and publishes the value by advancing the slot sequence. Consumers do the same with the dequeue
+ * position, so neither side needs the bitmap allocator of RingBuffer and any number of threads may pop.
+ *
+ * @warning Unlike RingBuffer this queue is not reentrant. A push or pop that is interrupted between claiming
+ *          a position and publishing it stalls that slot until it resumes, so a signal handler must not
+ *          wait on this queue.
+ *
+ * @tparam T The type of elements stored in the ring buffer. tryPush requires T to be MoveConstructible and tryPop
+ *           requires it to be MoveAssignable, tryEmplace and tryConsume have no such requirements.
+ * @tparam Allocator The allocator type used to allocate and deallocate memory for the ring buffer.
+ * @tparam Capacity The policy used to validate the capacity and map positions onto slots.
+ * @tparam Layout The layout policy, CacheAlignedLayout separates the enqueue and dequeue positions.
+ *
+ * @cite VyukovMPMCQueue Bounded MPMC queue
+ */
+template <typename T, typename Allocator = std::allocator<T>, typename Capacity = DynamicCapacity, typename Layout = CacheAlignedLayout>
+#if __cpp_concepts >= 201907L
+    requires std::is_nothrow_destructible_v<T> && std::is_nothrow_default_constructible_v<Allocator> && CapacityPolicy<Capacity>
+#endif
+class MpmcRingBuffer {
+public:
+    using size_type = uint32_t;
+    using value_type = T;
+    using allocator_type = Allocator;
+
+private:
+    // Positions are 64 bit so they never wrap, which keeps slot sequences continuous for any capacity.
+    using Position = uint64_t;
+
+    struct Cell {
+        // Twice the position when the slot is free for the producer of that position,
+        // and one more than that once the value is published for its consumer.
+        // Doubling keeps the two states distinct even when the capacity is 1.
+        std::atomic<Position> sequence;
+
+        alignas(alignof(T)) std::byte data[sizeof(T)];
+    };
+
+    using CellAllocator = std::allocator_traits<Allocator>::template rebind_alloc<Cell>;
+
+    //
+    // Read mostly fields.
+    //
+    [[no_unique_address]] CellAllocator mAllocator{};
+
+    Cell* mCells{};
+
+    size_type mCapacity{};
+
+    //
+    // Fields written by producers.
+    //
+    alignas(detail::kLayoutAlignment<Layout, std::atomic<Position>>) std::atomic<Position> mEnqueue{};
+
+    //
+    // Fields written by consumers.
+    //
+    alignas(detail::kLayoutAlignment<Layout, std::atomic<Position>>) std::atomic<Position> mDequeue{};
+
+    Cell& getCellAt(Position position) noexcept SM_CLANG_NONBLOCKING {
+        return mCells[Capacity::normalize(position, Position{mCapacity})];
+    }
+
+    static T& getElement(Cell& cell) noexcept SM_CLANG_NONBLOCKING {
+        return *std::launder(reinterpret_cast<T*>(cell.data));
+    }
+
+    void clear() noexcept {
+        if (mCells != nullptr) {
+            for (Position position = mDequeue.load(); position != mEnqueue.load(); position++) {
+                std::destroy_at(&getElement(getCellAt(position)));
+            }
+
+            std::destroy_n(mCells, mCapacity);
+            mAllocator.deallocate(mCells, mCapacity);
+
+            mCells = nullptr;
+            mCapacity = 0;
+        }
+    }
+
+    /**
+     * @brief Claim the next position of @p target.
+     *
+     * @param target The enqueue or dequeue position.
+     * @param offset The difference between twice the position and the sequence of a slot that is ready to claim.
+     *
+     * @return The claimed position, or the maximum position if no slot is ready.
+     */
+    Position claim(std::atomic<Position>& target, Position offset) noexcept SM_CLANG_NONBLOCKING {
+        Position position = target.load(std::memory_order_relaxed);
+        SpinWait spin{kRetrySpin};
+        while (true) {
+            Position sequence = getCellAt(position).sequence.load(std::memory_order_acquire);
+            auto difference = static_cast<int64_t>(sequence - (position * 2 + offset));
+            if (difference == 0) {
+                if (target.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    return position;
+                }
+
+                spin.pause();
+            } else if (difference < 0) {
+                // The slot still belongs to the previous lap, the queue is full or empty.
+                return (std::numeric_limits<Position>::max)();
+            } else {
+                // Another thread claimed this position, try again from where it left the target.
+                spin.pause();
+                position = target.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    constexpr MpmcRingBuffer(Cell* cells, size_type capacity, Allocator allocator) noexcept
+        : mAllocator(std::move(allocator))
+        , mCells(cells)
+        , mCapacity(capacity) {}
+
+public:
+    constexpr MpmcRingBuffer() noexcept = default;
+
+    MpmcRingBuffer(const MpmcRingBuffer& other) = delete;
+    MpmcRingBuffer& operator=(const MpmcRingBuffer& other) = delete;
+
+    /**
+     * @brief Move construct a ring buffer.
+     *
+     * @note This function is not thread-safe and should only be called when no other threads are accessing the queue.
+     *
+     * @param other The other ring buffer to move from.
+     */
+    constexpr MpmcRingBuffer(MpmcRingBuffer&& other) noexcept
+        : mAllocator(std::move(other.mAllocator))
+        , mCells(other.mCells)
+        , mCapacity(other.mCapacity)
+        , mEnqueue(other.mEnqueue.load())
+        , mDequeue(other.mDequeue.load()) {
+        other.mCells = nullptr;
+        other.mCapacity = 0;
+    }
+
+    /**
+     * @brief Move assign a ring buffer.
+     *
+     * @note This function is not thread-safe and should only be called when no other threads are accessing the queue.
+     *
+     * @param other The other ring buffer to move from.
+     * @return The moved ring buffer.
+     */
+    constexpr MpmcRingBuffer& operator=(MpmcRingBuffer&& other) noexcept {
+        if (this != &other) {
+            clear();
+
+            mAllocator = std::move(other.mAllocator);
+            mCells = other.mCells;
+            mCapacity = other.mCapacity;
+            mEnqueue.store(other.mEnqueue.load());
+            mDequeue.store(other.mDequeue.load());
+
+            other.mCells = nullptr;
+            other.mCapacity = 0;
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Destroy the ring buffer.
+     */
+    ~MpmcRingBuffer() noexcept {
+        clear();
+    }
+
+    /**
+     * @brief Try to construct a value in place at the back of the queue.
+     *
+     * @param args The arguments forwarded to the constructor of T.
+     *
+     * @return true if the value was constructed, false if the queue was full.
+     */
+    template <typename... Args>
+#if __cpp_concepts >= 201907L
+        requires std::is_nothrow_constructible_v<T, Args&&...>
+#endif
+    [[nodiscard]]
+    bool tryEmplace(Args&&... args) noexcept SM_CLANG_NONBLOCKING {
+        Position position = claim(mEnqueue, 0);
+        if (position == (std::numeric_limits<Position>::max)()) {
+            return false;
+        }
+
+        Cell& cell = getCellAt(position);
+        std::construct_at(reinterpret_cast<T*>(cell.data), std::forward<Args>(args)...);
+        cell.sequence.store(position * 2 + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Try to push a value onto the queue.
+     *
+     * If the value is successfully pushed then @p value is moved from, otherwise it is left unchanged.
+     *
+     * @param value The value to push.
+     *
+     * @return true if the value was pushed, false if the queue was full.
+     */
+    [[nodiscard]]
+    bool tryPush(T& value) noexcept SM_CLANG_NONBLOCKING
+#if __cpp_concepts >= 201907L
+        requires std::is_nothrow_move_constructible_v<T>
+#endif
+    {
+        return tryEmplace(std::move(value));
+    }
+
+    /**
+     * @brief Try to visit and remove the value at the front of the queue.
+     *
+     * @param fn The function to invoke with the value, must not throw.
+     *
+     * @return true if a value was consumed, false if the queue was empty.
+     */
+    template <typename F>
+#if __cpp_concepts >= 201907L
+        requires std::is_nothrow_invocable_v<F&, T&>
+#endif
+    [[nodiscard]]
+    bool tryConsume(F&& fn) noexcept SM_CLANG_NONBLOCKING {
+        Position position = claim(mDequeue, 1);
+        if (position == (std::numeric_limits<Position>::max)()) {
+            return false;
+        }
+
+        Cell& cell = getCellAt(position);
+        T& underlying = getElement(cell);
+        fn(underlying);
+        std::destroy_at(&underlying);
+
+        // Hand the slot to the producer of the same slot on the next lap.
+        cell.sequence.store((position + mCapacity) * 2, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Try to pop a value from the queue.
+     *
+     * If a value is successfully popped, it is moved into @p value, otherwise @p value is left unchanged.
+     *
+     * @param value The value to pop into.
+     *
+     * @return true if a value was popped, false if the queue was empty.
+     */
+    [[nodiscard]]
+    bool tryPop(T& value) noexcept SM_CLANG_NONBLOCKING
+#if __cpp_concepts >= 201907L
+        requires std::is_nothrow_move_assignable_v<T>
+#endif
+    {
+        return tryConsume([&value](T& underlying) noexcept { value = std::move(underlying); });
+    }
+
+    /**
+     * @brief Get an estimate of the number of items in the queue.
+     *
+     * @warning As this is a lock-free structure the count will be immediately out of date.
+     *
+     * @return The number of items in the queue.
+     */
+    size_type count() const noexcept SM_CLANG_NONBLOCKING {
+        Position dequeue = mDequeue.load();
+        Position enqueue = mEnqueue.load();
+
+        // A consumer may claim a position between the loads.
+        return (enqueue > dequeue) ? static_cast<size_type>((std::min)(enqueue - dequeue, Position{mCapacity})) : 0;
+    }
+
+    /**
+     * @brief Get the maximum capacity of the queue.
+     *
+     * @return The maximum number of items the queue can hold.
+     */
+    size_type capacity() const noexcept SM_CLANG_NONBLOCKING {
+        return mCapacity;
+    }
+
+    /**
+     * @brief Get the Allocator object used by the ring buffer.
+     *
+     * @return The allocator.
+     */
+    allocator_type getAllocator() const noexcept {
+        return mAllocator;
+    }
+
+    /**
+     * @brief Provided for compatibility with standard containers.
+     *
+     * This is equivalent to `getAllocator()`.
+     *
+     * @return The allocator.
+     */
+    allocator_type get_allocator() const noexcept {
+        return mAllocator;
+    }
+
+    /**
+     * @brief Create a new queue with the given capacity.
+     *
+     * @param capacity The maximum number of elements the queue can hold, must be accepted by the capacity policy.
+     * @param allocator The allocator used to allocate and deallocate the storage.
+     *
+     * @return The ring buffer if it was created successfully, std::nullopt otherwise.
+     */
+    [[nodiscard]]
+    static std::optional<MpmcRingBuffer> create(size_type capacity, Allocator allocator = Allocator{}) noexcept {
+        if (!Capacity::isValid(capacity)) {
+            return std::nullopt;
+        }
+
+        CellAllocator cellAllocator{allocator};
+        Cell* cells = cellAllocator.allocate(capacity);
+        if (cells == nullptr) {
+            return std::nullopt;
+        }
+
+        for (size_type i = 0; i < capacity; i++) {
+            std::construct_at(&cells[i])->sequence.store(Position{i} * 2, std::memory_order_relaxed);
+        }
+
+        return MpmcRingBuffer{cells, capacity, std::move(allocator)};
+    }
+};
+} // namespace sm::concurrent
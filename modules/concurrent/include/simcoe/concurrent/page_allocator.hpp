@@ -0,0 +1,172 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <cstddef>
+#include <simcoe/concurrent/exports.hpp>
+
+namespace sm::concurrent {
+/**
+ * @brief Selects the NUMA node of the thread that allocates.
+ */
+constexpr int kCurrentNumaNode = -1;
+
+/**
+ * @brief Options for allocating memory directly from the operating system.
+ */
+struct PageOptions {
+    // Back the allocation with huge pages, falls back to regular pages if none are available.
+    bool hugePages = false;
+
+    // Touch every page before returning so that the first writes do not take page faults.
+    bool prefault = false;
+
+    // The NUMA node to place the pages on, kCurrentNumaNode for the node of the allocating thread.
+    // Ignored if unset and on platforms without NUMA support.
+    int node = kCurrentNumaNode;
+
+    // Whether node should be applied at all.
+    bool bindNode = false;
+
+    constexpr bool operator==(const PageOptions&) const noexcept = default;
+};
+
+/**
+ * @brief Allocate whole pages from the operating system.
+ *
+ * Uses mmap on linux, huge pages are taken from the MAP_HUGETLB pool first and then from
+ * transparent huge pages with madvise. Windows uses VirtualAlloc with MEM_LARGE_PAGES, which
+ * requires the SeLockMemoryPrivilege. Nodes are bound with mbind and VirtualAllocExNuma.
+ *
+ * @param size The number of bytes to allocate.
+ * @param options How the pages are allocated.
+ *
+ * @return The page aligned allocation, or nullptr if @p size bytes could not be allocated.
+ */
+SM_CONCURRENT_API SM_CONCURRENT_INLINE void* allocatePages(size_t size, const PageOptions& options) noexcept;
+
+/**
+ * @brief Release memory allocated by allocatePages.
+ *
+ * @param memory The allocation to release.
+ * @param size The size passed to allocatePages.
+ * @param options The options passed to allocatePages.
+ */
+SM_CONCURRENT_API SM_CONCURRENT_INLINE void freePages(void* memory, size_t size, const PageOptions& options) noexcept;
+
+/**
+ * @brief Get the NUMA node of the processor the calling thread is running on.
+ *
+ * @return The node, 0 on platforms without NUMA support.
+ */
+SM_CONCURRENT_API SM_CONCURRENT_INLINE int currentNumaNode() noexcept;
+
+namespace detail {
+/**
+ * @brief The shared implementation of the page allocators.
+ *
+ * Returns nullptr instead of throwing when the allocation fails, which RingBuffer::create reports as failure.
+ */
+template <typename T>
+class BasicPageAllocator {
+protected:
+    PageOptions mOptions;
+
+    constexpr BasicPageAllocator(PageOptions options) noexcept
+        : mOptions(options) {}
+
+public:
+    using value_type = T;
+
+    [[nodiscard]]
+    T* allocate(size_t n) noexcept {
+        return static_cast<T*>(allocatePages(n * sizeof(T), mOptions));
+    }
+
+    void deallocate(T* memory, size_t n) noexcept {
+        freePages(memory, n * sizeof(T), mOptions);
+    }
+
+    constexpr const PageOptions& options() const noexcept {
+        return mOptions;
+    }
+};
+} // namespace detail
+
+/**
+ * @brief An allocator that backs allocations with huge pages.
+ *
+ * Each allocation is rounded up to a whole number of huge pages, intended for large long lived
+ * buffers such as RingBuffer storage.
+ *
+ * @code{.cpp}
+ * using Queue = RingBuffer<Event, HugePageAllocator<Event>>;
+ * auto queue = Queue::create(1 << 20, HugePageAllocator<Event>{true});
+ * @endcode
+ */
+template <typename T>
+class HugePageAllocator : public detail::BasicPageAllocator<T> {
+public:
+    /**
+     * @brief Construct a new huge page allocator that does not prefault.
+     */
+    constexpr HugePageAllocator() noexcept
+        : HugePageAllocator(false) {}
+
+    /**
+     * @brief Construct a new huge page allocator.
+     *
+     * @param prefault Touch every page of an allocation before returning it.
+     */
+    constexpr explicit HugePageAllocator(bool prefault) noexcept
+        : detail::BasicPageAllocator<T>(PageOptions{.hugePages = true, .prefault = prefault}) {}
+
+    template <typename U>
+    constexpr HugePageAllocator(const HugePageAllocator<U>& other) noexcept
+        : detail::BasicPageAllocator<T>(other.options()) {}
+
+    template <typename U>
+    constexpr bool operator==(const HugePageAllocator<U>& other) const noexcept {
+        return this->options() == other.options();
+    }
+};
+
+/**
+ * @brief An allocator that places allocations on a NUMA node.
+ *
+ * Construct it with the node of the thread that will consume the data, or leave the node as kCurrentNumaNode
+ * and allocate from that thread. Other processors can still access the memory at a higher cost.
+ */
+template <typename T>
+class NumaAllocator : public detail::BasicPageAllocator<T> {
+public:
+    /**
+     * @brief Construct a new NUMA allocator for the node of the allocating thread.
+     */
+    constexpr NumaAllocator() noexcept
+        : NumaAllocator(kCurrentNumaNode) {}
+
+    /**
+     * @brief Construct a new NUMA allocator.
+     *
+     * @param node The node to allocate on, kCurrentNumaNode for the node of the allocating thread.
+     * @param prefault Touch every page of an allocation before returning it.
+     * @param hugePages Also back allocations with huge pages.
+     */
+    constexpr explicit NumaAllocator(int node, bool prefault = false, bool hugePages = false) noexcept
+        : detail::BasicPageAllocator<T>(PageOptions{.hugePages = hugePages, .prefault = prefault, .node = node, .bindNode = true}) {}
+
+    template <typename U>
+    constexpr NumaAllocator(const NumaAllocator<U>& other) noexcept
+        : detail::BasicPageAllocator<T>(other.options()) {}
+
+    template <typename U>
+    constexpr bool operator==(const NumaAllocator<U>& other) const noexcept {
+        return this->options() == other.options();
+    }
+};
+} // namespace sm::concurrent
+
+#if defined(SM_CONCURRENT_HEADER_ONLY)
+#    include <simcoe/concurrent/detail/page_allocator_impl.hpp>
+#endif
@@ -0,0 +1,53 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <simcoe/concurrent/annotations.hpp>
+#include <simcoe/concurrent/exports.hpp>
+
+namespace sm::concurrent {
+/**
+ * @brief Block the calling thread while @p word holds @p expected.
+ *
+ * Uses futex on linux and WaitOnAddress on windows. The caller must recheck its condition
+ * after returning as the thread may be woken spuriously.
+ *
+ * @param word The word to wait on.
+ * @param expected The value to wait on.
+ */
+SM_CONCURRENT_API SM_CONCURRENT_INLINE void park(const std::atomic<uint32_t>& word, uint32_t expected) noexcept SM_CLANG_BLOCKING;
+
+/**
+ * @brief Block the calling thread while @p word holds @p expected or until @p deadline passes.
+ *
+ * @param word The word to wait on.
+ * @param expected The value to wait on.
+ * @param deadline The time after which the thread stops waiting.
+ *
+ * @return false if the deadline passed, true otherwise.
+ */
+SM_CONCURRENT_API SM_CONCURRENT_INLINE bool parkUntil(const std::atomic<uint32_t>& word, uint32_t expected, std::chrono::steady_clock::time_point deadline) noexcept SM_CLANG_BLOCKING;
+
+/**
+ * @brief Wake one thread parked on @p word.
+ *
+ * This is a single system call and is safe to call from a signal handler on linux.
+ *
+ * @param word The word threads are parked on.
+ */
+SM_CONCURRENT_API SM_CONCURRENT_INLINE void unparkOne(std::atomic<uint32_t>& word) noexcept SM_CLANG_NONBLOCKING;
+
+/**
+ * @brief Wake every thread parked on @p word.
+ *
+ * @param word The word threads are parked on.
+ */
+SM_CONCURRENT_API SM_CONCURRENT_INLINE void unparkAll(std::atomic<uint32_t>& word) noexcept SM_CLANG_NONBLOCKING;
+} // namespace sm::concurrent
+
+#if defined(SM_CONCURRENT_HEADER_ONLY)
+#    include <simcoe/concurrent/detail/parking_impl.hpp>
+#endif
@@ -0,0 +1,23 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <cstddef>
+#include <simcoe/concurrent/exports.hpp>
+
+namespace sm::concurrent {
+/**
+ * @brief Get the index of the processor the calling thread is running on.
+ *
+ * Uses sched_getcpu on linux and GetCurrentProcessorNumber on windows, both of which avoid a
+ * system call on current kernels. The thread may be migrated as soon as this returns, so the
+ * result is only a hint for spreading work.
+ *
+ * @return The processor index, 0 on platforms that do not report it.
+ */
+SM_CONCURRENT_API SM_CONCURRENT_INLINE size_t currentProcessor() noexcept;
+} // namespace sm::concurrent
+
+#if defined(SM_CONCURRENT_HEADER_ONLY)
+#    include <simcoe/concurrent/detail/processor_impl.hpp>
+#endif
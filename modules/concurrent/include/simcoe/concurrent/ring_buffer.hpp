@@ -2,17 +2,55 @@
 
 #pragma once
 
+#include <algorithm>
 #include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
 #include <cstdint>
 #include <cstring>
 #include <limits>
 #include <memory>
+#include <new>
 #include <optional>
 #include <simcoe/concurrent/annotations.hpp>
+#include <simcoe/concurrent/capacity.hpp>
+#include <simcoe/concurrent/coroutine.hpp>
 #include <simcoe/concurrent/detail/ring_buffer_bitset_detail.hpp>
+#include <simcoe/concurrent/layout.hpp>
+#include <simcoe/concurrent/parking.hpp>
+#include <simcoe/concurrent/spin_wait.hpp>
+#include <simcoe/concurrent/stats.hpp>
+#include <span>
 #include <type_traits>
 
 namespace sm::concurrent {
+/**
+ * @brief The counters recorded by a RingBuffer with a stats policy.
+ */
+enum class RingBufferCounter {
+    // A push was rejected because the optimistic count reservation exceeded the capacity.
+    eCountRollback,
+
+    // A push reserved a count but the bitmap scan found no free slot.
+    eBitmapFull,
+
+    // A compare exchange in the bitmap scan failed and was retried.
+    eScanRetries,
+
+    // The largest count observed by a push.
+    eHighWater,
+
+    // A pop found the queue empty.
+    ePopEmpty,
+
+    eCount
+};
+
+constexpr bool isHighWaterMark(RingBufferCounter counter) noexcept {
+    return counter == RingBufferCounter::eHighWater;
+}
+
 /**
  * @brief A fixed size, multi-producer single-consumer, wait free, reentrant atomic ringbuffer.
  *
@@ -22,15 +60,20 @@ namespace sm::concurrent {
  * themselves. This means that this ring buffer also contains an atomic bitmap allocator to store its
  * contents.
  *
- * @tparam T The type of elements stored in the ring buffer. Must be MoveAssignable and MoveConstructible.
+ * @tparam T The type of elements stored in the ring buffer. tryPush requires T to be MoveConstructible and tryPop
+ *           requires it to be MoveAssignable, tryEmplace and tryConsume have no such requirements.
  * @tparam Allocator The allocator type used to allocate and deallocate memory for the ring buffer.
+ * @tparam Capacity The policy used to validate the capacity and map positions onto slots,
+ *                  Pow2Capacity replaces the modulo on every push and pop with a mask.
+ * @tparam Layout The layout policy, CacheAlignedLayout separates the producer and consumer indices.
+ * @tparam Stats The stats policy, NoStats compiles every counter away and AtomicStats records RingBufferCounter.
  *
  * @cite FreeBSDRingBuffer FreeBSD ring_buf implementation
  * @cite WaitFreeMpScQueue waitfree-mpsc-queue
  */
-template <typename T, typename Allocator = std::allocator<T>>
+template <typename T, typename Allocator = std::allocator<T>, typename Capacity = DynamicCapacity, typename Layout = CompactLayout, typename Stats = NoStats>
 #if __cpp_concepts >= 201907L
-    requires std::is_nothrow_move_constructible_v<T> && std::is_nothrow_move_assignable_v<T> && std::is_nothrow_destructible_v<T> && std::is_nothrow_default_constructible_v<Allocator>
+    requires std::is_nothrow_destructible_v<T> && std::is_nothrow_default_constructible_v<Allocator> && CapacityPolicy<Capacity>
 #endif
 class RingBuffer {
 public:
@@ -48,17 +91,61 @@ private:
 
     using StorageAllocator = std::allocator_traits<Allocator>::template rebind_alloc<Storage>;
 
+    // The maximum number of elements claimed by a single batch operation,
+    // larger batches are split into multiple rounds.
+    static constexpr size_type kMaxBatchSize = 64;
+
+    // How a blocking pop backs off between polls of the queue before parking.
+    static constexpr SpinPolicy kPopSpin{.pauseRounds = 7, .maxPauses = 64, .yieldRounds = 4};
+
+    // The values of mSleeping, how the consumer is waiting for a producer to publish.
+    static constexpr uint32_t kConsumerAwake = 0;
+    static constexpr uint32_t kConsumerParked = 1;
+    static constexpr uint32_t kConsumerAwaiting = 2;
+
+    using AtomicSize = std::atomic<size_type>;
+
+    //
+    // Read mostly fields.
+    //
     [[no_unique_address]] StorageAllocator mAllocator{};
 
-    std::byte* mStorage{};
+    // The address of the storage relative to this object, zero if there is no storage.
+    // An offset rather than a pointer so a queue placed in shared memory is valid in every process that maps it.
+    std::ptrdiff_t mStorageOffset{};
 
     // The capacity of the ring buffer + 1.
     size_type mCapacity{};
 
-    std::atomic<size_type> mCount{};
+    // False if the storage was provided by the caller and must not be deallocated.
+    bool mOwnsStorage{};
+
+    //
+    // Fields written by producers, the consumer also decrements the count.
+    //
+    alignas(detail::kLayoutAlignment<Layout, AtomicSize>) AtomicSize mCount{};
+
+    AtomicSize mHead{};
+
+    //
+    // Fields written by the consumer.
+    //
+    alignas(detail::kLayoutAlignment<Layout, AtomicSize>) AtomicSize mTail{};
 
-    std::atomic<size_type> mHead{};
-    std::atomic<size_type> mTail{};
+    // Not moved with the queue, each object records its own operations.
+    [[no_unique_address]] typename Stats::template Storage<RingBufferCounter> mStats{};
+
+    //
+    // Fields read by producers on every push and only written when the consumer parks or wakes,
+    // kept off the consumer line so pushes do not read the line every pop writes.
+    //
+
+    // Non-zero while the consumer is parked in a blocking pop or suspended in an awaited pop.
+    alignas(detail::kLayoutAlignment<Layout, std::atomic<uint32_t>>) std::atomic<uint32_t> mSleeping{};
+
+    // The suspended consumer, only valid while mSleeping is kConsumerAwaiting.
+    // Not moved with the queue, a queue must not be moved while it is awaited.
+    detail::CoroutineWaiter* mWaiter{};
 
     static constexpr size_t storageOffsetForBitset(size_type capacity) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
         size_t offset = sizeof(T) * (capacity + 1);
@@ -68,21 +155,52 @@ private:
 
     static constexpr size_t storageOffsetForElements(size_type capacity) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
         size_t offset = storageOffsetForBitset(capacity);
-        offset += sizeof(BitsetWord) * detail::requiredBitsetSize(capacity);
+        offset += sizeof(BitsetWord) * (detail::requiredBitsetSize(capacity) + detail::requiredSummarySize(capacity));
         offset = detail::roundup(offset, alignof(ElementIndex));
         return offset;
     }
 
+    // The alignment of a region passed to createInPlace, the storage follows the queue in the region.
+    static constexpr size_t kInPlaceAlignment = (std::max)({alignof(T), alignof(BitsetWord), alignof(ElementIndex), alignof(Storage)});
+
+    static constexpr size_t inPlaceStorageOffset() noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+        return detail::roundup(sizeof(RingBuffer), (std::max)(kInPlaceAlignment, alignof(RingBuffer)));
+    }
+
+    static bool isInPlaceRegionAligned(std::span<std::byte> region) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+        return reinterpret_cast<uintptr_t>(region.data()) % (std::max)(kInPlaceAlignment, alignof(RingBuffer)) == 0;
+    }
+
+    std::byte* getStorageBase() const noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+        if (mStorageOffset == 0) {
+            return nullptr;
+        }
+
+        return reinterpret_cast<std::byte*>(reinterpret_cast<uintptr_t>(this) + mStorageOffset);
+    }
+
+    void setStorageBase(std::byte* storage) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+        mStorageOffset = (storage == nullptr) ? 0 : static_cast<std::ptrdiff_t>(reinterpret_cast<uintptr_t>(storage) - reinterpret_cast<uintptr_t>(this));
+    }
+
     T* getStorageAddress() noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
-        return reinterpret_cast<T*>(mStorage);
+        return reinterpret_cast<T*>(getStorageBase());
     }
 
     BitsetWord* getBitsetAddress() noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
-        return reinterpret_cast<BitsetWord*>(mStorage + storageOffsetForBitset(capacity()));
+        return reinterpret_cast<BitsetWord*>(getStorageBase() + storageOffsetForBitset(capacity()));
+    }
+
+    BitsetWord* getSummaryAddress() noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+        if (detail::requiredSummarySize(capacity()) == 0) {
+            return nullptr;
+        }
+
+        return getBitsetAddress() + detail::requiredBitsetSize(capacity());
     }
 
     ElementIndex* getElementAddress() noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
-        return reinterpret_cast<ElementIndex*>(mStorage + storageOffsetForElements(capacity()));
+        return reinterpret_cast<ElementIndex*>(getStorageBase() + storageOffsetForElements(capacity()));
     }
 
     T& getElementAt(size_type index) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
@@ -90,50 +208,170 @@ private:
         return storage[index];
     }
 
-    void clear() noexcept {
-        if (auto storage = getStorageAddress()) {
-            //
-            // Destroy the remaining elements in the buffer
-            //
-            constexpr size_t kBitsPerElement = std::numeric_limits<uint64_t>::digits;
-
-            auto bitset = getBitsetAddress();
-            for (size_t i = 0; i < (capacity() / kBitsPerElement); i++) {
-                uint64_t word = bitset[i].load();
-                for (size_t bit = 0; bit < kBitsPerElement; bit++) {
-                    size_t index = i * kBitsPerElement + bit;
-                    if (index >= capacity()) {
-                        break;
-                    }
-
-                    if (word & (uint64_t{1} << bit)) {
-                        std::destroy_at(&storage[index]);
-                    }
+    /**
+     * @brief Destroy every element that holds a bit in the bitset.
+     */
+    void destroyElements() noexcept {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            T* storage = getStorageAddress();
+            BitsetWord* bitset = getBitsetAddress();
+            for (size_t i = 0; i < detail::requiredBitsetSize(capacity()); i++) {
+                for (uint64_t word = bitset[i].load(std::memory_order_relaxed); word != 0; word &= word - 1) {
+                    std::destroy_at(&storage[i * detail::kBitsPerWord + std::countr_zero(word)]);
                 }
             }
+        }
+    }
+
+    void clear() noexcept {
+        if (auto storage = getStorageAddress()) {
+            destroyElements();
 
-            mAllocator.deallocate(reinterpret_cast<Storage*>(mStorage), detail::underlyingStorageElementCount<T>(capacity()));
+            if (mOwnsStorage) {
+                mAllocator.deallocate(reinterpret_cast<Storage*>(storage), detail::underlyingStorageElementCount<T>(capacity()));
+            }
 
-            mStorage = nullptr;
+            mStorageOffset = 0;
             mCapacity = 0;
+            mOwnsStorage = false;
         }
     }
 
     size_type normalize(size_type index) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
-        return index % capacity();
+        return Capacity::normalize(index, capacity());
+    }
+
+    size_t allocateElement(size_type hint) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+        if constexpr (Stats::kEnabled) {
+            size_t retries = 0;
+            size_t index = detail::atomicScanAndSet(getBitsetAddress(), getSummaryAddress(), capacity(), hint, &retries);
+            mStats.add(RingBufferCounter::eScanRetries, retries);
+            return index;
+        } else {
+            return detail::atomicScanAndSet(getBitsetAddress(), getSummaryAddress(), capacity(), hint);
+        }
+    }
+
+    void releaseElement(size_t index) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+        detail::atomicClearBit(getBitsetAddress(), getSummaryAddress(), capacity(), index);
+    }
+
+    /**
+     * @brief Wake the consumer if it is parked in a blocking pop or suspended in an awaited pop.
+     *
+     * Must be called after publishing an element, producers only pay for the wake
+     * when the consumer has announced that it is about to park.
+     */
+    void wakeConsumer() noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+        uint32_t sleeping = mSleeping.load();
+        if (sleeping == kConsumerAwake) [[likely]] {
+            return;
+        }
+
+        if (sleeping == kConsumerParked && mSleeping.compare_exchange_strong(sleeping, kConsumerAwake)) {
+            unparkOne(mSleeping);
+        } else if (sleeping == kConsumerAwaiting) {
+            resumeAwaiting();
+        }
+    }
+
+    /**
+     * @brief Resume the suspended consumer if the element at the tail has been published.
+     *
+     * The element a producer published may be behind a tail element that another producer has claimed but not
+     * published yet, that producer resumes the consumer once it publishes. This keeps the awaited pop from
+     * waiting on the producer's stack, so a push never blocks.
+     */
+    void resumeAwaiting() noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+        uint32_t expected = kConsumerAwaiting;
+        while (isTailPublished() && mSleeping.compare_exchange_strong(expected, kConsumerAwake)) {
+            if (isTailPublished()) {
+                mWaiter->resume(mWaiter);
+                return;
+            }
+
+            //
+            // The consumer resumed and suspended again between the check and the exchange, so this is a later
+            // registration whose tail is not published. The consumer cannot pop while it is suspended, so put
+            // the registration back and check again for a publish that saw the consumer awake.
+            //
+            mSleeping.store(kConsumerAwaiting);
+            expected = kConsumerAwaiting;
+        }
     }
 
-    size_t allocateElement() noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
-        return detail::atomicScanAndSet(getBitsetAddress(), capacity());
+    bool isTailPublished() noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+        //
+        // Sequentially consistent so that a consumer that announced it is suspending either sees
+        // the element a producer published or the producer sees the announcement.
+        //
+        auto elements = getElementAddress();
+        return elements[normalize(mTail.load())].load() != std::numeric_limits<size_type>::max();
+    }
+
+    /**
+     * @brief Poll the queue for a short while before a blocking pop parks.
+     */
+    bool trySpinPop(T& value) noexcept SM_CLANG_BLOCKING {
+        SpinWait spin{kPopSpin};
+        while (!spin.shouldPark()) {
+            if (isTailPublished() && tryPop(value)) {
+                return true;
+            }
+
+            spin.spinOnce();
+        }
+
+        return false;
     }
 
-    constexpr RingBuffer(std::byte* storage, size_type capacity, Allocator allocator) noexcept
+    /**
+     * @brief Reserve space for up to @p count elements.
+     *
+     * @param count The number of elements to reserve.
+     * @param hint Receives the count observed before reserving, used to spread allocations.
+     *
+     * @return The number of elements reserved, any excess is rolled back.
+     */
+    size_type reserveCount(size_type count, size_type& hint) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+        auto current = mCount.fetch_add(count);
+        hint = current;
+        if (current >= capacity()) {
+            mCount.fetch_sub(count);
+            mStats.add(RingBufferCounter::eCountRollback);
+            return 0;
+        }
+
+        size_type reserved = (std::min)(count, capacity() - current);
+        if (reserved < count) {
+            mCount.fetch_sub(count - reserved);
+        }
+
+        mStats.max(RingBufferCounter::eHighWater, current + reserved);
+        return reserved;
+    }
+
+    /**
+     * @brief Initialize the bitset and element indices of freshly allocated storage.
+     */
+    static void initStorage(std::byte* storage, size_type capacity) noexcept {
+        BitsetWord* bitset = reinterpret_cast<BitsetWord*>(storage + storageOffsetForBitset(capacity));
+
+        ElementIndex* elements = reinterpret_cast<ElementIndex*>(storage + storageOffsetForElements(capacity));
+
+        std::uninitialized_fill_n(bitset, detail::requiredBitsetSize(capacity) + detail::requiredSummarySize(capacity), 0);
+        std::uninitialized_fill_n(elements, capacity, std::numeric_limits<size_type>::max());
+    }
+
+    RingBuffer(std::byte* storage, size_type capacity, Allocator allocator, bool ownsStorage) noexcept
         : mAllocator(std::move(allocator))
-        , mStorage(storage)
         , mCapacity(capacity + 1)
+        , mOwnsStorage(ownsStorage)
         , mCount(0)
         , mHead(0)
-        , mTail(0) {}
+        , mTail(0) {
+        setStorageBase(storage);
+    }
 
 public:
     constexpr RingBuffer() noexcept = default;
@@ -150,13 +388,16 @@ public:
      */
     constexpr RingBuffer(RingBuffer&& other) noexcept
         : mAllocator(std::move(other.mAllocator))
-        , mStorage(other.mStorage)
         , mCapacity(other.mCapacity)
+        , mOwnsStorage(other.mOwnsStorage)
         , mCount(other.mCount.load())
         , mHead(other.mHead.load())
         , mTail(other.mTail.load()) {
-        other.mStorage = nullptr;
+        setStorageBase(other.getStorageBase());
+
+        other.mStorageOffset = 0;
         other.mCapacity = 0;
+        other.mOwnsStorage = false;
     }
 
     /**
@@ -172,15 +413,16 @@ public:
             clear();
 
             mAllocator = std::move(other.mAllocator);
-            mStorage = other.mStorage;
+            setStorageBase(other.getStorageBase());
             mCapacity = other.mCapacity;
-            mCount.store(other.mCount.load());
+            mOwnsStorage = other.mOwnsStorage;
             mCount.store(other.mCount.load());
             mHead.store(other.mHead.load());
             mTail.store(other.mTail.load());
 
-            other.mStorage = nullptr;
+            other.mStorageOffset = 0;
             other.mCapacity = 0;
+            other.mOwnsStorage = false;
         }
         return *this;
     }
@@ -193,77 +435,487 @@ public:
     }
 
     /**
-     * @brief Try to push a value onto the queue.
+     * @brief Destroy every element in the queue and keep the storage for reuse.
      *
-     * Attempts to push a value onto the queue. If the queue is full, the value is not pushed and false is returned.
-     * If the value is successfully pushed then @p value is moved from, otherwise it is left unchanged.
+     * Only the bitset words and element indices that are in use are written, so recycling
+     * a queue that held a few elements is much cheaper than creating a new one.
      *
-     * @param value The value to push.
-     *
-     * @return true if the value was pushed, false if the queue was full.
+     * @note This function is not thread-safe and should only be called when no other threads are accessing the queue.
      */
-    [[nodiscard]]
-    bool tryPush(T& value) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
-        auto index = allocateElement();
-        if (index == (std::numeric_limits<size_t>::max)()) {
-            return false;
+    void reset() noexcept {
+        if (getStorageAddress() == nullptr) {
+            return;
+        }
+
+        destroyElements();
+
+        BitsetWord* bitset = getBitsetAddress();
+        for (size_t i = 0; i < detail::requiredBitsetSize(capacity()) + detail::requiredSummarySize(capacity()); i++) {
+            if (bitset[i].load(std::memory_order_relaxed) != 0) {
+                bitset[i].store(0, std::memory_order_relaxed);
+            }
+        }
+
+        //
+        // Only the indices between the tail and head can be published. Unless the positions wrapped
+        // around the size type, step through the slots without normalizing each position.
+        //
+        ElementIndex* elements = getElementAddress();
+        size_type tail = mTail.load(std::memory_order_relaxed);
+        size_type head = mHead.load(std::memory_order_relaxed);
+        if (tail <= head) {
+            size_type slot = normalize(tail);
+            for (size_type i = 0; i < head - tail; i++) {
+                elements[slot].store(std::numeric_limits<size_type>::max(), std::memory_order_relaxed);
+                slot = (slot + 1 == capacity()) ? 0 : slot + 1;
+            }
+        } else {
+            for (size_type position = tail; position != head; position++) {
+                elements[normalize(position)].store(std::numeric_limits<size_type>::max(), std::memory_order_relaxed);
+            }
         }
 
+        mCount.store(0);
+        mHead.store(0);
+        mTail.store(0);
+    }
+
+    /**
+     * @brief Try to construct a value in place at the back of the queue.
+     *
+     * The value is constructed directly in the slot claimed from the bitmap allocator,
+     * if the queue is full no value is constructed and @p args are left unchanged.
+     *
+     * @param args The arguments forwarded to the constructor of T.
+     *
+     * @return true if the value was constructed, false if the queue was full.
+     */
+    template <typename... Args>
+#if __cpp_concepts >= 201907L
+        requires std::is_nothrow_constructible_v<T, Args&&...>
+#endif
+    [[nodiscard]]
+    bool tryEmplace(Args&&... args) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
         //
         // Optimistic increment of count, if we exceed capacity, roll back.
+        // Reserving before allocating means a full queue is rejected without scanning the bitset.
         //
         auto count = mCount.fetch_add(1);
         if (count >= capacity()) {
             mCount.fetch_sub(1);
-            detail::atomicClearBit(getBitsetAddress(), index);
+            mStats.add(RingBufferCounter::eCountRollback);
+            return false;
+        }
+
+        mStats.max(RingBufferCounter::eHighWater, count + 1);
+
+        //
+        // Every element holding a bit has also reserved a count, so a free bit should exist.
+        // The scan can still miss one while other threads are claiming and releasing bits.
+        //
+        auto index = allocateElement(count);
+        if (index == (std::numeric_limits<size_t>::max)()) {
+            mCount.fetch_sub(1);
+            mStats.add(RingBufferCounter::eBitmapFull);
             return false;
         }
 
 #if __cplusplus >= 202002L // Theres no feature test macro for std::construct_at
-        std::construct_at(&getElementAt(index), std::move(value));
+        std::construct_at(&getElementAt(index), std::forward<Args>(args)...);
 #else
-        new (&getElementAt(index)) T(std::move(value));
+        new (&getElementAt(index)) T(std::forward<Args>(args)...);
 #endif
 
         auto head = mHead.fetch_add(1);
         auto elements = getElementAddress();
         elements[normalize(head)].store(index);
 
+        wakeConsumer();
+
         return true;
     }
 
     /**
-     * @brief Try to pop a value from the queue.
+     * @brief Try to push a value onto the queue.
      *
-     * Attempts to pop a value from the queue. If the queue is empty, false is returned and @p value is left unchanged.
-     * If a value is successfully popped, it is moved into @p value.
+     * Attempts to push a value onto the queue. If the queue is full, the value is not pushed and false is returned.
+     * If the value is successfully pushed then @p value is moved from, otherwise it is left unchanged.
      *
-     * @param value The value to pop into.
+     * @param value The value to push.
      *
-     * @return true if a value was popped, false if the queue was empty.
+     * @return true if the value was pushed, false if the queue was full.
      */
     [[nodiscard]]
-    bool tryPop(T& value) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+    bool tryPush(T& value) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT
+#if __cpp_concepts >= 201907L
+        requires std::is_nothrow_move_constructible_v<T>
+#endif
+    {
+        return tryEmplace(std::move(value));
+    }
+
+    /**
+     * @brief Try to visit and remove the value at the front of the queue.
+     *
+     * The value is passed to @p fn while it is still in storage, then it is destroyed
+     * and its slot is released. If the queue is empty @p fn is not invoked.
+     *
+     * @param fn The function to invoke with the value, must not throw.
+     *
+     * @return true if a value was consumed, false if the queue was empty.
+     */
+    template <typename F>
+#if __cpp_concepts >= 201907L
+        requires std::is_nothrow_invocable_v<F&, T&>
+#endif
+    [[nodiscard]]
+    bool tryConsume(F&& fn) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
         auto elements = getElementAddress();
         auto index = elements[normalize(mTail.load())].exchange(std::numeric_limits<size_type>::max());
         if (index == std::numeric_limits<size_type>::max()) {
+            mStats.add(RingBufferCounter::ePopEmpty);
             return false;
         }
 
         //
-        // Move the value out of storage before we mark the slot as free.
+        // The value must be finished with before we mark the slot as free.
         //
         T& underlying = getElementAt(index);
-        value = std::move(underlying);
+        fn(underlying);
         std::destroy_at(&underlying);
 
-        detail::atomicClearBit(getBitsetAddress(), index);
+        releaseElement(index);
 
         mTail.fetch_add(1);
         mCount.fetch_sub(1);
         return true;
     }
 
+    /**
+     * @brief Try to pop a value from the queue.
+     *
+     * Attempts to pop a value from the queue. If the queue is empty, false is returned and @p value is left unchanged.
+     * If a value is successfully popped, it is moved into @p value.
+     *
+     * @param value The value to pop into.
+     *
+     * @return true if a value was popped, false if the queue was empty.
+     */
+    [[nodiscard]]
+    bool tryPop(T& value) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT
+#if __cpp_concepts >= 201907L
+        requires std::is_nothrow_move_assignable_v<T>
+#endif
+    {
+        return tryConsume([&value](T& underlying) noexcept { value = std::move(underlying); });
+    }
+
+    /**
+     * @brief Pop a value from the queue, blocking until one is available.
+     *
+     * Polls the queue briefly and then parks the calling thread until a producer publishes an element.
+     *
+     * @param value The value to pop into.
+     */
+    void pop(T& value) noexcept SM_CLANG_BLOCKING
+#if __cpp_concepts >= 201907L
+        requires std::is_nothrow_move_assignable_v<T>
+#endif
+    {
+        if (trySpinPop(value)) {
+            return;
+        }
+
+        while (true) {
+            //
+            // Announce that we are about to park before checking the queue a final time,
+            // a producer that publishes after this point is guaranteed to see the flag.
+            //
+            mSleeping.store(kConsumerParked);
+            if (tryPop(value)) {
+                mSleeping.store(kConsumerAwake);
+                return;
+            }
+
+            park(mSleeping, kConsumerParked);
+        }
+    }
+
+    /**
+     * @brief Pop a value from the queue, blocking until one is available or the timeout expires.
+     *
+     * @param value The value to pop into.
+     * @param timeout The maximum time to wait.
+     *
+     * @return true if a value was popped, false if the timeout expired.
+     */
+    template <typename Rep, typename Period>
+#if __cpp_concepts >= 201907L
+        requires std::is_nothrow_move_assignable_v<T>
+#endif
+    [[nodiscard]]
+    bool popFor(T& value, std::chrono::duration<Rep, Period> timeout) noexcept SM_CLANG_BLOCKING {
+        return popUntil(value, std::chrono::steady_clock::now() + timeout);
+    }
+
+    /**
+     * @brief Pop a value from the queue, blocking until one is available or the deadline passes.
+     *
+     * @param value The value to pop into.
+     * @param deadline The time after which to stop waiting.
+     *
+     * @return true if a value was popped, false if the deadline passed.
+     */
+    template <typename Clock, typename Duration>
+#if __cpp_concepts >= 201907L
+        requires std::is_nothrow_move_assignable_v<T>
+#endif
+    [[nodiscard]]
+    bool popUntil(T& value, std::chrono::time_point<Clock, Duration> deadline) noexcept SM_CLANG_BLOCKING {
+        if (trySpinPop(value)) {
+            return true;
+        }
+
+        auto steadyDeadline = std::chrono::steady_clock::now() + std::chrono::ceil<std::chrono::steady_clock::duration>(deadline - Clock::now());
+        while (true) {
+            mSleeping.store(kConsumerParked);
+            if (tryPop(value)) {
+                mSleeping.store(kConsumerAwake);
+                return true;
+            }
+
+            if (!parkUntil(mSleeping, kConsumerParked, steadyDeadline)) {
+                mSleeping.store(kConsumerAwake);
+                return tryPop(value);
+            }
+        }
+    }
+
+#if __cpp_impl_coroutine >= 201902L
+    /**
+     * @brief The awaitable returned by pop(), resumes with the popped value.
+     *
+     * @tparam Scheduler The hook used to resume the coroutine when a producer publishes.
+     */
+    template <typename Scheduler>
+    class PopAwaiter final : detail::ScheduledWaiter<Scheduler> {
+        RingBuffer* mQueue;
+
+    public:
+        PopAwaiter(RingBuffer* queue, Scheduler scheduler) noexcept
+            : detail::ScheduledWaiter<Scheduler>(scheduler)
+            , mQueue(queue) {}
+
+        bool await_ready() noexcept SM_CLANG_NONBLOCKING {
+            return mQueue->isTailPublished();
+        }
+
+        void await_suspend(std::coroutine_handle<> handle) noexcept SM_CLANG_NONBLOCKING {
+            // A producer may resume the coroutine and destroy this awaiter as soon as it is registered.
+            RingBuffer* queue = mQueue;
+
+            this->mHandle = handle;
+            queue->mWaiter = this;
+            queue->mSleeping.store(kConsumerAwaiting);
+
+            //
+            // An element published before the registration did not see it, take the registration back
+            // through the same path as a producer so that only one side ever resumes the coroutine.
+            //
+            queue->resumeAwaiting();
+        }
+
+        T await_resume() noexcept SM_CLANG_NONBLOCKING {
+            // The coroutine only resumes once the tail is published, and only the consumer pops.
+            T value{};
+            [[maybe_unused]] bool popped = mQueue->tryPop(value);
+            return value;
+        }
+    };
+
+    /**
+     * @brief Pop a value from the queue from a coroutine.
+     *
+     * Suspends the coroutine until the element at the tail is published, the producer that publishes it resumes
+     * the coroutine through @p scheduler. Resuming never waits, so a push that wakes the coroutine does not block.
+     * The waiter lives in the awaiter so suspending does not allocate, only one pop may be awaited at a time.
+     *
+     * @code{.cpp}
+     * Task consumer(RingBuffer<Message>& queue) {
+     *     while (true) {
+     *         Message message = co_await queue.pop();
+     *         // process message...
+     *     }
+     * }
+     * @endcode
+     *
+     * @note The waiter is only valid in the process that registered it, producers in other processes
+     *       sharing the queue cannot resume it.
+     *
+     * @param scheduler The hook used to resume the coroutine, it runs on the producer's thread.
+     *
+     * @return The awaitable, which produces the popped value.
+     */
+    template <typename Scheduler = InlineScheduler>
+#    if __cpp_concepts >= 201907L
+        requires CoroutineScheduler<Scheduler> && std::is_nothrow_default_constructible_v<T> && std::is_nothrow_move_assignable_v<T>
+#    endif
+    [[nodiscard]]
+    PopAwaiter<Scheduler> pop(Scheduler scheduler = Scheduler{}) noexcept {
+        return PopAwaiter<Scheduler>{this, scheduler};
+    }
+#endif
+
+    /**
+     * @brief Try to push multiple values onto the queue.
+     *
+     * Values are pushed in order, each round reserves space for a run of elements
+     * and publishes them with a single update of the head.
+     * Values that were pushed are moved from, the remaining values are left unchanged.
+     *
+     * @param values The values to push.
+     *
+     * @return The number of values pushed from the front of @p values.
+     */
+    [[nodiscard]]
+    size_type tryPushN(std::span<T> values) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT
+#if __cpp_concepts >= 201907L
+        requires std::is_nothrow_move_constructible_v<T>
+#endif
+    {
+        auto elements = getElementAddress();
+        size_type pushed = 0;
+
+        while (pushed < values.size()) {
+            size_type batch = static_cast<size_type>((std::min)(values.size() - pushed, size_t{kMaxBatchSize}));
+            size_type hint = 0;
+            size_type reserved = reserveCount(batch, hint);
+            if (reserved == 0) {
+                break;
+            }
+
+            size_t indices[kMaxBatchSize];
+            size_t retries = 0;
+            size_type claimed = static_cast<size_type>(detail::atomicScanAndSetMany(getBitsetAddress(), getSummaryAddress(), capacity(), hint, indices, reserved, Stats::kEnabled ? &retries : nullptr));
+            mStats.add(RingBufferCounter::eScanRetries, retries);
+            if (claimed < reserved) {
+                mCount.fetch_sub(reserved - claimed);
+                mStats.add(RingBufferCounter::eBitmapFull);
+            }
+
+            if (claimed == 0) {
+                break;
+            }
+
+            for (size_type i = 0; i < claimed; i++) {
+                std::construct_at(&getElementAt(static_cast<size_type>(indices[i])), std::move(values[pushed + i]));
+            }
+
+            auto head = mHead.fetch_add(claimed);
+            for (size_type i = 0; i < claimed; i++) {
+                elements[normalize(head + i)].store(static_cast<size_type>(indices[i]));
+            }
+
+            wakeConsumer();
+
+            pushed += claimed;
+            if (claimed < batch) {
+                break;
+            }
+        }
+
+        return pushed;
+    }
+
+    /**
+     * @brief Visit and remove up to @p limit values from the queue.
+     *
+     * Each value is passed to @p visitor while it is still in storage and destroyed afterwards,
+     * the tail and count are only updated once for the whole batch.
+     *
+     * @param visitor The function to invoke with each value, must not throw.
+     * @param limit The maximum number of values to remove.
+     *
+     * @return The number of values removed.
+     */
+    template <typename F>
+#if __cpp_concepts >= 201907L
+        requires std::is_nothrow_invocable_v<F&, T&>
+#endif
+    size_type drain(F&& visitor, size_type limit = (std::numeric_limits<size_type>::max)()) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+        constexpr size_t kBitsPerElement = std::numeric_limits<uint64_t>::digits;
+        constexpr size_t kNoWord = (std::numeric_limits<size_t>::max)();
+
+        auto elements = getElementAddress();
+        auto bitset = getBitsetAddress();
+        auto summary = getSummaryAddress();
+        auto tail = mTail.load();
+
+        //
+        // Bits are released one word at a time rather than one element at a time.
+        //
+        size_t pendingWord = kNoWord;
+        uint64_t pendingMask = 0;
+
+        size_type popped = 0;
+        while (popped < limit) {
+            auto index = elements[normalize(tail + popped)].exchange(std::numeric_limits<size_type>::max());
+            if (index == std::numeric_limits<size_type>::max()) {
+                break;
+            }
+
+            T& underlying = getElementAt(index);
+            visitor(underlying);
+            std::destroy_at(&underlying);
+
+            size_t word = index / kBitsPerElement;
+            if (word != pendingWord) {
+                if (pendingWord != kNoWord) {
+                    detail::atomicClearMask(bitset, summary, capacity(), pendingWord, pendingMask);
+                }
+
+                pendingWord = word;
+                pendingMask = 0;
+            }
+
+            pendingMask |= uint64_t{1} << (index % kBitsPerElement);
+            popped += 1;
+        }
+
+        if (pendingWord != kNoWord) {
+            detail::atomicClearMask(bitset, summary, capacity(), pendingWord, pendingMask);
+        }
+
+        if (popped != 0) {
+            mTail.fetch_add(popped);
+            mCount.fetch_sub(popped);
+        } else if (limit != 0) {
+            mStats.add(RingBufferCounter::ePopEmpty);
+        }
+
+        return popped;
+    }
+
+    /**
+     * @brief Try to pop multiple values from the queue.
+     *
+     * Popped values are moved into the front of @p values in queue order.
+     *
+     * @param values The values to pop into.
+     *
+     * @return The number of values popped.
+     */
+    [[nodiscard]]
+    size_type tryPopN(std::span<T> values) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT
+#if __cpp_concepts >= 201907L
+        requires std::is_nothrow_move_assignable_v<T>
+#endif
+    {
+        size_type limit = static_cast<size_type>((std::min)(values.size(), size_t{(std::numeric_limits<size_type>::max)()}));
+        T* output = values.data();
+        return drain([&output](T& value) noexcept { *output++ = std::move(value); }, limit);
+    }
+
     /**
      * @brief Get an estimate of the number of items in the queue.
      *
@@ -277,6 +929,15 @@ public:
         return mCount.load(order);
     }
 
+    /**
+     * @brief Get a snapshot of the counters recorded by the stats policy.
+     *
+     * @return The counters, every counter is zero with NoStats.
+     */
+    StatsSnapshot<RingBufferCounter> stats() const noexcept {
+        return mStats.snapshot();
+    }
+
     /**
      * @brief Get the maximum capacity of the queue.
      *
@@ -309,14 +970,14 @@ public:
     /**
      * @brief Create a new queue with the given capacity.
      *
-     * @param capacity The maximum number of elements the queue can hold.
+     * @param capacity The maximum number of elements the queue can hold, must be accepted by the capacity policy.
      * @param allocator The allocator used to allocate and deallocate the storage.
      *
      * @return The ring buffer if it was created successfully, std::nullopt otherwise.
      */
     [[nodiscard]]
     static std::optional<RingBuffer> create(size_type capacity, Allocator allocator = Allocator{}) noexcept {
-        if (capacity == 0) {
+        if (!Capacity::isValid(capacity)) {
             return std::nullopt;
         }
 
@@ -327,14 +988,81 @@ public:
             return std::nullopt;
         }
 
-        BitsetWord* bitset = reinterpret_cast<BitsetWord*>(reinterpret_cast<std::byte*>(storage) + storageOffsetForBitset(capacity));
+        initStorage(reinterpret_cast<std::byte*>(storage), capacity);
+
+        return RingBuffer{reinterpret_cast<std::byte*>(storage), capacity, std::move(allocator), true};
+    }
 
-        ElementIndex* elements = reinterpret_cast<ElementIndex*>(reinterpret_cast<std::byte*>(storage) + storageOffsetForElements(capacity));
+    /**
+     * @brief Get the size of a region that can hold a queue with the given capacity.
+     *
+     * @param capacity The maximum number of elements the queue can hold.
+     *
+     * @return The number of bytes createInPlace requires.
+     */
+    static constexpr size_t requiredInPlaceSize(size_type capacity) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+        return inPlaceStorageOffset() + detail::underlyingStorageElementCount<T>(capacity) * sizeof(T);
+    }
 
-        std::uninitialized_fill_n(bitset, detail::requiredBitsetSize(capacity), 0);
-        std::uninitialized_fill_n(elements, capacity, std::numeric_limits<size_type>::max());
+    /**
+     * @brief Create a new queue entirely inside a caller provided region.
+     *
+     * The queue object is placed at the start of @p region and followed by its storage, intended for memory
+     * shared between processes. The storage is found by its offset from the queue so every process may map
+     * the region at a different address. The queue never deallocates the region, once every process is finished
+     * with it the creator destroys the queue with std::destroy_at before releasing the region.
+     *
+     * @warning Every process must use the same queue type and T must be meaningful in every process,
+     *          pointers into the address space of a single process are not. Blocking pops park on a
+     *          process private address, use the non-blocking pops from other processes.
+     *
+     * @param region The region to create the queue in, must be aligned for the queue and
+     *               hold at least requiredInPlaceSize(capacity) bytes.
+     * @param capacity The maximum number of elements the queue can hold, must be accepted by the capacity policy.
+     *
+     * @return The queue if it was created successfully, nullptr otherwise.
+     */
+    [[nodiscard]]
+    static RingBuffer* createInPlace(std::span<std::byte> region, size_type capacity) noexcept {
+        static_assert(AtomicSize::is_always_lock_free && BitsetWord::is_always_lock_free, "Shared queues require lock free atomics");
+
+        if (!Capacity::isValid(capacity) || !isInPlaceRegionAligned(region) || region.size() < requiredInPlaceSize(capacity)) {
+            return nullptr;
+        }
+
+        std::byte* storage = region.data() + inPlaceStorageOffset();
+        initStorage(storage, capacity);
+
+        // The constructor is private so std::construct_at cannot be used.
+        return ::new (static_cast<void*>(region.data())) RingBuffer(storage, capacity, Allocator{}, false);
+    }
+
+    /**
+     * @brief Attach to a queue that another process created with createInPlace.
+     *
+     * The creation must happen before attaching, for example by signalling the other process once
+     * createInPlace has returned.
+     *
+     * @param region The region the queue was created in, mapped into this process.
+     *
+     * @return The queue if @p region holds a queue of this type, nullptr otherwise.
+     */
+    [[nodiscard]]
+    static RingBuffer* attach(std::span<std::byte> region) noexcept {
+        if (!isInPlaceRegionAligned(region) || region.size() < inPlaceStorageOffset()) {
+            return nullptr;
+        }
+
+        RingBuffer* queue = std::launder(reinterpret_cast<RingBuffer*>(region.data()));
+        if (queue->mStorageOffset != static_cast<std::ptrdiff_t>(inPlaceStorageOffset()) || queue->mCapacity == 0) {
+            return nullptr;
+        }
+
+        if (!Capacity::isValid(queue->capacity()) || region.size() < requiredInPlaceSize(queue->capacity())) {
+            return nullptr;
+        }
 
-        return RingBuffer{reinterpret_cast<std::byte*>(storage), capacity, std::move(allocator)};
+        return queue;
     }
 };
 } // namespace sm::concurrent
@@ -0,0 +1,580 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <new>
+#include <optional>
+#include <simcoe/concurrent/annotations.hpp>
+#include <simcoe/concurrent/detail/ring_buffer_bitset_detail.hpp>
+#include <simcoe/concurrent/layout.hpp>
+#include <type_traits>
+#include <utility>
+
+namespace sm::concurrent {
+/**
+ * @brief An unbounded, multi-producer single-consumer, lock free queue made of fixed size segments.
+ *
+ * Producers claim slots in the newest segment with a single fetch_add, when it fills the first producer
+ * to notice links a new segment with a compare exchange and every producer moves on to it. The consumer
+ * drains segments in order and retires each one once it has been consumed, retired segments are kept
+ * in a small set of spares for producers to reuse before any new segment is allocated.
+ *
+ * A producer pins the tail segment for the length of its push, a retired segment is reused once the
+ * tail has moved past it and it has no pins, so a producer stalled inside a push only keeps its own
+ * segment alive. Surplus segments are deallocated after every producer that may have read the tail
+ * before it moved has pinned a segment, which only waits on the few instructions that pinning takes.
+ *
+ * @warning Pushing allocates when no spare segment is available, so unlike RingBuffer this queue
+ *          must not be pushed to from a signal handler.
+ *
+ * @tparam T The type of elements stored in the queue. tryPush requires T to be MoveConstructible and tryPop
+ *           requires it to be MoveAssignable, tryEmplace and tryConsume have no such requirements.
+ * @tparam Allocator The allocator type used to allocate and deallocate segments.
+ * @tparam Layout The layout policy, CacheAlignedLayout separates the producer and consumer fields.
+ */
+template <typename T, typename Allocator = std::allocator<T>, typename Layout = CacheAlignedLayout>
+#if __cpp_concepts >= 201907L
+    requires std::is_nothrow_destructible_v<T> && std::is_nothrow_default_constructible_v<Allocator>
+#endif
+class SegmentedQueue {
+public:
+    using size_type = uint32_t;
+    using value_type = T;
+    using allocator_type = Allocator;
+
+private:
+    // The number of retired segments kept for reuse.
+    static constexpr size_t kSpareSegments = 2;
+
+    struct Slot {
+        // Non-zero once the value is published.
+        std::atomic<uint8_t> ready{0};
+
+        alignas(alignof(T)) std::byte data[sizeof(T)];
+    };
+
+    struct alignas(kCacheLineSize) Segment {
+        // The next segment, written once by the producer that links it.
+        std::atomic<Segment*> next{nullptr};
+
+        // The number of slots claimed by producers, may exceed the capacity.
+        std::atomic<size_type> head{0};
+
+        // The number of producers pushing into this segment.
+        std::atomic<uint32_t> producers{0};
+
+        // Links segments waiting to be reclaimed, only accessed by the consumer.
+        Segment* retired{nullptr};
+
+        Slot* slots() noexcept SM_CLANG_NONBLOCKING {
+            return std::launder(reinterpret_cast<Slot*>(reinterpret_cast<std::byte*>(this) + slotsOffset()));
+        }
+
+        static constexpr size_t slotsOffset() noexcept {
+            return detail::roundup(sizeof(Segment), alignof(Slot));
+        }
+    };
+
+    struct alignas(alignof(Segment)) Block {
+        std::byte data[sizeof(Segment)];
+    };
+
+    using BlockAllocator = std::allocator_traits<Allocator>::template rebind_alloc<Block>;
+
+    //
+    // Read mostly fields.
+    //
+    [[no_unique_address]] BlockAllocator mAllocator{};
+
+    size_type mSegmentCapacity{};
+
+    // Retired segments that can be reused, null when empty.
+    std::atomic<Segment*> mSpares[kSpareSegments]{};
+
+    //
+    // Fields written by producers.
+    //
+    alignas(detail::kLayoutAlignment<Layout, std::atomic<Segment*>>) std::atomic<Segment*> mTail{};
+
+    // Counts the producers between reading the tail and pinning it, split by the parity of the epoch they entered in.
+    std::atomic<uint32_t> mPinning[2]{};
+
+    // Advanced by the consumer to start waiting for every producer that is pinning to finish.
+    std::atomic<uint32_t> mEpoch{};
+
+    //
+    // Fields written by the consumer.
+    //
+    alignas(detail::kLayoutAlignment<Layout, Segment*>) Segment* mHead{};
+
+    size_type mHeadIndex{};
+
+    // Segments the consumer has moved past, waiting for the tail to move past them and their pins to drop.
+    Segment* mRetired{};
+
+    // Unreachable segments waiting for every producer that entered in mFreeingEpoch to finish pinning.
+    Segment* mFreeing{};
+
+    // Unreachable segments waiting for the current wait on mFreeing to finish.
+    Segment* mUnreachable{};
+
+    uint32_t mFreeingEpoch{};
+
+    size_t blockCount() const noexcept SM_CLANG_NONBLOCKING {
+        size_t size = Segment::slotsOffset() + sizeof(Slot) * mSegmentCapacity;
+        return (size + sizeof(Block) - 1) / sizeof(Block);
+    }
+
+    Segment* allocateSegment() noexcept {
+        Block* blocks = mAllocator.allocate(blockCount());
+        if (blocks == nullptr) {
+            return nullptr;
+        }
+
+        Segment* segment = ::new (static_cast<void*>(blocks)) Segment();
+        Slot* slots = segment->slots();
+        for (size_type i = 0; i < mSegmentCapacity; i++) {
+            ::new (static_cast<void*>(&slots[i])) Slot();
+        }
+
+        return segment;
+    }
+
+    void deallocateSegment(Segment* segment) noexcept {
+        std::destroy_at(segment);
+        mAllocator.deallocate(reinterpret_cast<Block*>(segment), blockCount());
+    }
+
+    /**
+     * @brief Take a spare segment, allocating a new one if there are none.
+     */
+    Segment* acquireSegment() noexcept {
+        for (auto& spare : mSpares) {
+            if (spare.load(std::memory_order_relaxed) != nullptr) {
+                if (Segment* segment = spare.exchange(nullptr, std::memory_order_acquire)) {
+                    return segment;
+                }
+            }
+        }
+
+        return allocateSegment();
+    }
+
+    /**
+     * @brief Keep a segment that no producer is pushing into as a spare.
+     *
+     * @return true if the segment was kept, false if every spare is taken.
+     */
+    bool tryStoreSpare(Segment* segment) noexcept {
+        segment->next.store(nullptr, std::memory_order_relaxed);
+        segment->head.store(0, std::memory_order_relaxed);
+        segment->retired = nullptr;
+
+        for (auto& spare : mSpares) {
+            Segment* expected = nullptr;
+            if (spare.compare_exchange_strong(expected, segment, std::memory_order_release, std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void deallocateList(Segment*& list) noexcept {
+        while (list != nullptr) {
+            Segment* next = list->retired;
+            deallocateSegment(list);
+            list = next;
+        }
+    }
+
+    /**
+     * @brief Recycle retired segments that no producer can push into and deallocate surplus ones.
+     *
+     * A producer only pushes into a segment after pinning it and seeing that it is still the tail,
+     * so once the tail has moved past a segment and its pins have dropped no producer can push into it.
+     * A producer that read the tail before it moved may still touch the pin count, so segments are only
+     * deallocated once every producer that was pinning has finished.
+     */
+    void reclaimRetired() noexcept {
+        if (mFreeing != nullptr && mPinning[mFreeingEpoch & 1].load() == 0) {
+            deallocateList(mFreeing);
+        }
+
+        if (mRetired != nullptr) {
+            // The tail is read before the pins, a producer that pins after seeing it will see that the tail moved.
+            Segment* tail = mTail.load();
+
+            Segment* keep = nullptr;
+            Segment* segment = mRetired;
+            while (segment != nullptr) {
+                Segment* next = segment->retired;
+                if (segment == tail || segment->producers.load() != 0) {
+                    segment->retired = keep;
+                    keep = segment;
+                } else if (!tryStoreSpare(segment)) {
+                    segment->retired = mUnreachable;
+                    mUnreachable = segment;
+                }
+
+                segment = next;
+            }
+
+            mRetired = keep;
+        }
+
+        if (mFreeing == nullptr && mUnreachable != nullptr) {
+            mFreeing = std::exchange(mUnreachable, nullptr);
+            mFreeingEpoch = mEpoch.fetch_add(1);
+
+            if (mPinning[mFreeingEpoch & 1].load() == 0) {
+                deallocateList(mFreeing);
+            }
+        }
+    }
+
+    /**
+     * @brief Pin the tail segment.
+     *
+     * @return The tail, which cannot be reused until it is unpinned.
+     */
+    Segment* pinTail() noexcept {
+        uint32_t parity;
+        while (true) {
+            // Recheck the epoch so the consumer waits for every producer that counted itself before the epoch moved.
+            uint32_t epoch = mEpoch.load();
+            parity = epoch & 1;
+            mPinning[parity].fetch_add(1);
+            if (mEpoch.load() == epoch) {
+                break;
+            }
+
+            mPinning[parity].fetch_sub(1);
+        }
+
+        Segment* segment;
+        while (true) {
+            segment = mTail.load();
+            segment->producers.fetch_add(1);
+            if (mTail.load() == segment) {
+                break;
+            }
+
+            segment->producers.fetch_sub(1);
+        }
+
+        mPinning[parity].fetch_sub(1);
+        return segment;
+    }
+
+    void retire(Segment* segment) noexcept {
+        segment->retired = mRetired;
+        mRetired = segment;
+    }
+
+    void clear() noexcept {
+        if (mHead == nullptr) {
+            return;
+        }
+
+        size_type start = mHeadIndex;
+        for (Segment* segment = mHead; segment != nullptr; start = 0) {
+            Slot* slots = segment->slots();
+            for (size_type i = start; i < mSegmentCapacity; i++) {
+                if (slots[i].ready.load(std::memory_order_acquire) != 0) {
+                    std::destroy_at(std::launder(reinterpret_cast<T*>(slots[i].data)));
+                }
+            }
+
+            Segment* next = segment->next.load();
+            deallocateSegment(segment);
+            segment = next;
+        }
+
+        deallocateList(mRetired);
+        deallocateList(mFreeing);
+        deallocateList(mUnreachable);
+
+        for (auto& spare : mSpares) {
+            if (Segment* segment = spare.exchange(nullptr)) {
+                deallocateSegment(segment);
+            }
+        }
+
+        mHead = nullptr;
+        mTail.store(nullptr);
+        mHeadIndex = 0;
+    }
+
+    SegmentedQueue(Segment* segment, size_type segmentCapacity, Allocator allocator) noexcept
+        : mAllocator(std::move(allocator))
+        , mSegmentCapacity(segmentCapacity)
+        , mTail(segment)
+        , mHead(segment) {}
+
+    // Used by create to allocate the first segment before the queue exists.
+    SegmentedQueue(size_type segmentCapacity, Allocator allocator) noexcept
+        : mAllocator(std::move(allocator))
+        , mSegmentCapacity(segmentCapacity) {}
+
+public:
+    constexpr SegmentedQueue() noexcept = default;
+
+    SegmentedQueue(const SegmentedQueue& other) = delete;
+    SegmentedQueue& operator=(const SegmentedQueue& other) = delete;
+
+    /**
+     * @brief Move construct a queue.
+     *
+     * @note This function is not thread-safe and should only be called when no other threads are accessing the queue.
+     *
+     * @param other The other queue to move from.
+     */
+    SegmentedQueue(SegmentedQueue&& other) noexcept
+        : mAllocator(std::move(other.mAllocator))
+        , mSegmentCapacity(other.mSegmentCapacity)
+        , mTail(other.mTail.exchange(nullptr))
+        , mHead(std::exchange(other.mHead, nullptr))
+        , mHeadIndex(std::exchange(other.mHeadIndex, 0))
+        , mRetired(std::exchange(other.mRetired, nullptr))
+        , mFreeing(std::exchange(other.mFreeing, nullptr))
+        , mUnreachable(std::exchange(other.mUnreachable, nullptr))
+        , mFreeingEpoch(other.mFreeingEpoch) {
+        mEpoch.store(other.mEpoch.load());
+        for (size_t i = 0; i < kSpareSegments; i++) {
+            mSpares[i].store(other.mSpares[i].exchange(nullptr));
+        }
+    }
+
+    /**
+     * @brief Move assign a queue.
+     *
+     * @note This function is not thread-safe and should only be called when no other threads are accessing the queue.
+     *
+     * @param other The other queue to move from.
+     * @return The moved queue.
+     */
+    SegmentedQueue& operator=(SegmentedQueue&& other) noexcept {
+        if (this != &other) {
+            clear();
+
+            mAllocator = std::move(other.mAllocator);
+            mSegmentCapacity = other.mSegmentCapacity;
+            mTail.store(other.mTail.exchange(nullptr));
+            mHead = std::exchange(other.mHead, nullptr);
+            mHeadIndex = std::exchange(other.mHeadIndex, 0);
+            mRetired = std::exchange(other.mRetired, nullptr);
+            mFreeing = std::exchange(other.mFreeing, nullptr);
+            mUnreachable = std::exchange(other.mUnreachable, nullptr);
+            mFreeingEpoch = other.mFreeingEpoch;
+            mEpoch.store(other.mEpoch.load());
+            for (size_t i = 0; i < kSpareSegments; i++) {
+                mSpares[i].store(other.mSpares[i].exchange(nullptr));
+            }
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Destroy the queue.
+     */
+    ~SegmentedQueue() noexcept {
+        clear();
+    }
+
+    /**
+     * @brief Try to construct a value in place at the back of the queue.
+     *
+     * @param args The arguments forwarded to the constructor of T.
+     *
+     * @return true if the value was constructed, false if a new segment was needed and could not be allocated.
+     */
+    template <typename... Args>
+#if __cpp_concepts >= 201907L
+        requires std::is_nothrow_constructible_v<T, Args&&...>
+#endif
+    [[nodiscard]]
+    bool tryEmplace(Args&&... args) noexcept {
+        while (true) {
+            Segment* segment = pinTail();
+            size_type index = segment->head.fetch_add(1, std::memory_order_relaxed);
+            if (index < mSegmentCapacity) {
+                Slot& slot = segment->slots()[index];
+                std::construct_at(reinterpret_cast<T*>(slot.data), std::forward<Args>(args)...);
+                slot.ready.store(1, std::memory_order_release);
+                segment->producers.fetch_sub(1);
+                return true;
+            }
+
+            //
+            // The segment is full, link a new one if nobody has yet and help move the tail onto it.
+            //
+            Segment* next = segment->next.load(std::memory_order_acquire);
+            if (next == nullptr) {
+                Segment* fresh = acquireSegment();
+                if (fresh == nullptr) {
+                    segment->producers.fetch_sub(1);
+                    return false;
+                }
+
+                if (segment->next.compare_exchange_strong(next, fresh, std::memory_order_acq_rel)) {
+                    next = fresh;
+                } else if (!tryStoreSpare(fresh)) {
+                    // No other thread has seen the segment, it can be deallocated without waiting.
+                    deallocateSegment(fresh);
+                }
+            }
+
+            // The segment is pinned so it cannot be reused and become the tail again, this only fails if the tail moved on.
+            Segment* expected = segment;
+            mTail.compare_exchange_strong(expected, next);
+            segment->producers.fetch_sub(1);
+        }
+    }
+
+    /**
+     * @brief Try to push a value onto the queue.
+     *
+     * If the value is successfully pushed then @p value is moved from, otherwise it is left unchanged.
+     *
+     * @param value The value to push.
+     *
+     * @return true if the value was pushed, false if a new segment could not be allocated.
+     */
+    [[nodiscard]]
+    bool tryPush(T& value) noexcept
+#if __cpp_concepts >= 201907L
+        requires std::is_nothrow_move_constructible_v<T>
+#endif
+    {
+        return tryEmplace(std::move(value));
+    }
+
+    /**
+     * @brief Try to visit and remove the value at the front of the queue.
+     *
+     * Must only be called from the consumer thread.
+     *
+     * @param fn The function to invoke with the value, must not throw.
+     *
+     * @return true if a value was consumed, false if the queue was empty.
+     */
+    template <typename F>
+#if __cpp_concepts >= 201907L
+        requires std::is_nothrow_invocable_v<F&, T&>
+#endif
+    [[nodiscard]]
+    bool tryConsume(F&& fn) noexcept {
+        reclaimRetired();
+
+        while (true) {
+            Segment* segment = mHead;
+            if (mHeadIndex == mSegmentCapacity) {
+                //
+                // Every slot of this segment was claimed and consumed, move on once the next one is linked.
+                //
+                Segment* next = segment->next.load(std::memory_order_acquire);
+                if (next == nullptr) {
+                    return false;
+                }
+
+                mHead = next;
+                mHeadIndex = 0;
+                retire(segment);
+                continue;
+            }
+
+            Slot& slot = segment->slots()[mHeadIndex];
+            if (slot.ready.load(std::memory_order_acquire) == 0) {
+                return false;
+            }
+
+            T& underlying = *std::launder(reinterpret_cast<T*>(slot.data));
+            fn(underlying);
+            std::destroy_at(&underlying);
+
+            slot.ready.store(0, std::memory_order_relaxed);
+            mHeadIndex += 1;
+            return true;
+        }
+    }
+
+    /**
+     * @brief Try to pop a value from the queue.
+     *
+     * Must only be called from the consumer thread.
+     * If a value is successfully popped, it is moved into @p value, otherwise @p value is left unchanged.
+     *
+     * @param value The value to pop into.
+     *
+     * @return true if a value was popped, false if the queue was empty.
+     */
+    [[nodiscard]]
+    bool tryPop(T& value) noexcept
+#if __cpp_concepts >= 201907L
+        requires std::is_nothrow_move_assignable_v<T>
+#endif
+    {
+        return tryConsume([&value](T& underlying) noexcept { value = std::move(underlying); });
+    }
+
+    /**
+     * @brief Get the number of elements in each segment.
+     *
+     * @return The segment capacity.
+     */
+    size_type segmentCapacity() const noexcept SM_CLANG_NONBLOCKING {
+        return mSegmentCapacity;
+    }
+
+    /**
+     * @brief Get the Allocator object used by the queue.
+     *
+     * @return The allocator.
+     */
+    allocator_type getAllocator() const noexcept {
+        return allocator_type(mAllocator);
+    }
+
+    /**
+     * @brief Provided for compatibility with standard containers.
+     *
+     * This is equivalent to `getAllocator()`.
+     *
+     * @return The allocator.
+     */
+    allocator_type get_allocator() const noexcept {
+        return allocator_type(mAllocator);
+    }
+
+    /**
+     * @brief Create a new queue.
+     *
+     * @param segmentCapacity The number of elements in each segment.
+     * @param allocator The allocator used to allocate and deallocate segments.
+     *
+     * @return The queue if it was created successfully, std::nullopt otherwise.
+     */
+    [[nodiscard]]
+    static std::optional<SegmentedQueue> create(size_type segmentCapacity, Allocator allocator = Allocator{}) noexcept {
+        if (segmentCapacity == 0 || segmentCapacity > (std::numeric_limits<size_type>::max)() / 2) {
+            return std::nullopt;
+        }
+
+        SegmentedQueue queue{segmentCapacity, std::move(allocator)};
+        Segment* segment = queue.allocateSegment();
+        if (segment == nullptr) {
+            return std::nullopt;
+        }
+
+        queue.mHead = segment;
+        queue.mTail.store(segment);
+        return queue;
+    }
+};
+} // namespace sm::concurrent
@@ -0,0 +1,401 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <simcoe/concurrent/annotations.hpp>
+#include <simcoe/concurrent/layout.hpp>
+#include <simcoe/concurrent/processor.hpp>
+#include <simcoe/concurrent/ring_buffer.hpp>
+#include <simcoe/concurrent/stats.hpp>
+#include <type_traits>
+#include <utility>
+
+namespace sm::concurrent {
+/**
+ * @brief Sharding policy that gives each thread a fixed shard.
+ *
+ * A thread always pushes to the same shard, so the values pushed by one thread are popped in order.
+ *
+ * @warning The first push on a thread initializes a thread_local, so pushes are not nonblocking and
+ *          are not safe from a signal handler.
+ */
+struct ThreadSharding {
+    static constexpr bool kNonBlocking = false;
+
+    static size_t select() noexcept {
+        return detail::threadIndex();
+    }
+};
+
+/**
+ * @brief Sharding policy that pushes to the shard of the current processor.
+ *
+ * Producers on the same processor share a shard and never contend with other processors, which scales best
+ * when there are many more producer threads than processors. Values pushed by one thread are only popped
+ * in order while it is not migrated to another processor.
+ */
+struct ProcessorSharding {
+    static constexpr bool kNonBlocking = true;
+
+    static size_t select() noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+        return currentProcessor();
+    }
+};
+
+#if __cpp_concepts >= 201907L
+/**
+ * @brief A policy that selects the shard of a producer.
+ *
+ * A policy whose select is nonblocking declares a static constexpr bool kNonBlocking set to true,
+ * the queue's pushes are only marked nonblocking for such policies.
+ */
+template <typename T>
+concept ShardingPolicy = requires {
+    { T::select() } noexcept -> std::same_as<size_t>;
+};
+#endif
+
+namespace detail {
+template <typename Sharding>
+constexpr bool isNonBlockingSharding() noexcept {
+#if __cpp_concepts >= 201907L
+    if constexpr (requires { Sharding::kNonBlocking; }) {
+        return Sharding::kNonBlocking;
+    }
+#endif
+    return false;
+}
+} // namespace detail
+
+/**
+ * @brief A multi-producer single-consumer queue made of several RingBuffer shards.
+ *
+ * Every RingBuffer producer updates the same count and head, which becomes the bottleneck with many producers.
+ * This queue spreads producers across independent shards chosen by the sharding policy, and the consumer
+ * visits the shards round robin. There is no order between values in different shards.
+ *
+ * @tparam T The type of elements stored in the queue, with the same requirements as RingBuffer.
+ * @tparam Allocator The allocator type used to allocate the shards and their storage.
+ * @tparam Sharding The policy that selects the shard of a producer.
+ * @tparam Layout The layout policy of each shard, CacheAlignedLayout keeps shards on separate cache lines.
+ */
+template <typename T, typename Allocator = std::allocator<T>, typename Sharding = ThreadSharding, typename Layout = CacheAlignedLayout>
+#if __cpp_concepts >= 201907L
+    requires std::is_nothrow_destructible_v<T> && std::is_nothrow_default_constructible_v<Allocator> && ShardingPolicy<Sharding>
+#endif
+class ShardedRingBuffer {
+public:
+    using Shard = RingBuffer<T, Allocator, DynamicCapacity, Layout>;
+
+    using size_type = typename Shard::size_type;
+    using value_type = T;
+    using allocator_type = Allocator;
+
+private:
+    using ShardAllocator = std::allocator_traits<Allocator>::template rebind_alloc<Shard>;
+
+    // The most values taken from one shard before moving to the next.
+    static constexpr size_type kDrainBatch = 64;
+
+    [[no_unique_address]] ShardAllocator mAllocator{};
+
+    Shard* mShards{};
+
+    size_type mShardCount{};
+
+    // The shard the consumer visits first, only accessed by the consumer.
+    size_type mNextShard{};
+
+    static constexpr bool kNonBlockingPush = detail::isNonBlockingSharding<Sharding>();
+
+    Shard& selectShard() noexcept SM_CLANG_NONBLOCKING_IF(kNonBlockingPush) {
+        return mShards[Sharding::select() % mShardCount];
+    }
+
+    void clear() noexcept {
+        if (mShards != nullptr) {
+            std::destroy_n(mShards, mShardCount);
+            mAllocator.deallocate(mShards, mShardCount);
+
+            mShards = nullptr;
+            mShardCount = 0;
+        }
+    }
+
+    constexpr ShardedRingBuffer(Shard* shards, size_type shardCount, Allocator allocator) noexcept
+        : mAllocator(std::move(allocator))
+        , mShards(shards)
+        , mShardCount(shardCount) {}
+
+public:
+    constexpr ShardedRingBuffer() noexcept = default;
+
+    ShardedRingBuffer(const ShardedRingBuffer& other) = delete;
+    ShardedRingBuffer& operator=(const ShardedRingBuffer& other) = delete;
+
+    /**
+     * @brief Move construct a queue.
+     *
+     * @note This function is not thread-safe and should only be called when no other threads are accessing the queue.
+     *
+     * @param other The other queue to move from.
+     */
+    constexpr ShardedRingBuffer(ShardedRingBuffer&& other) noexcept
+        : mAllocator(std::move(other.mAllocator))
+        , mShards(std::exchange(other.mShards, nullptr))
+        , mShardCount(std::exchange(other.mShardCount, 0))
+        , mNextShard(std::exchange(other.mNextShard, 0)) {}
+
+    /**
+     * @brief Move assign a queue.
+     *
+     * @note This function is not thread-safe and should only be called when no other threads are accessing the queue.
+     *
+     * @param other The other queue to move from.
+     * @return The moved queue.
+     */
+    constexpr ShardedRingBuffer& operator=(ShardedRingBuffer&& other) noexcept {
+        if (this != &other) {
+            clear();
+
+            mAllocator = std::move(other.mAllocator);
+            mShards = std::exchange(other.mShards, nullptr);
+            mShardCount = std::exchange(other.mShardCount, 0);
+            mNextShard = std::exchange(other.mNextShard, 0);
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Destroy the queue.
+     */
+    ~ShardedRingBuffer() noexcept {
+        clear();
+    }
+
+    /**
+     * @brief Try to construct a value in place in the shard of the calling producer.
+     *
+     * Only nonblocking if the sharding policy is, see ThreadSharding.
+     *
+     * @param args The arguments forwarded to the constructor of T.
+     *
+     * @return true if the value was constructed, false if the shard was full.
+     */
+    template <typename... Args>
+#if __cpp_concepts >= 201907L
+        requires std::is_nothrow_constructible_v<T, Args&&...>
+#endif
+    [[nodiscard]]
+    bool tryEmplace(Args&&... args) noexcept SM_CLANG_NONBLOCKING_IF(kNonBlockingPush) {
+        return selectShard().tryEmplace(std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Try to push a value into the shard of the calling producer.
+     *
+     * Only nonblocking if the sharding policy is, see ThreadSharding.
+     * The other shards are not tried when the selected shard is full, as that would reorder the values of the producer.
+     * If the value is successfully pushed then @p value is moved from, otherwise it is left unchanged.
+     *
+     * @param value The value to push.
+     *
+     * @return true if the value was pushed, false if the shard was full.
+     */
+    [[nodiscard]]
+    bool tryPush(T& value) noexcept SM_CLANG_NONBLOCKING_IF(kNonBlockingPush)
+#if __cpp_concepts >= 201907L
+        requires std::is_nothrow_move_constructible_v<T>
+#endif
+    {
+        return selectShard().tryPush(value);
+    }
+
+    /**
+     * @brief Visit and remove up to @p limit values, taking a batch from each shard in turn.
+     *
+     * Must only be called from the consumer thread.
+     *
+     * @param visitor The function to invoke with each value, must not throw.
+     * @param limit The maximum number of values to remove.
+     *
+     * @return The number of values removed.
+     */
+    template <typename F>
+#if __cpp_concepts >= 201907L
+        requires std::is_nothrow_invocable_v<F&, T&>
+#endif
+    size_type drain(F&& visitor, size_type limit = (std::numeric_limits<size_type>::max)()) noexcept SM_CLANG_NONBLOCKING {
+        size_type popped = 0;
+        size_type idle = 0;
+
+        //
+        // Stop once every shard in a row came up empty, or the limit is reached.
+        //
+        while (popped < limit && idle < mShardCount) {
+            Shard& shard = mShards[mNextShard];
+            size_type batch = shard.drain(visitor, (std::min)(limit - popped, kDrainBatch));
+            popped += batch;
+            idle = (batch == 0) ? idle + 1 : 0;
+            mNextShard = (mNextShard + 1 == mShardCount) ? 0 : mNextShard + 1;
+        }
+
+        return popped;
+    }
+
+    /**
+     * @brief Try to visit and remove one value.
+     *
+     * Must only be called from the consumer thread.
+     *
+     * @param fn The function to invoke with the value, must not throw.
+     *
+     * @return true if a value was consumed, false if every shard was empty.
+     */
+    template <typename F>
+#if __cpp_concepts >= 201907L
+        requires std::is_nothrow_invocable_v<F&, T&>
+#endif
+    [[nodiscard]]
+    bool tryConsume(F&& fn) noexcept SM_CLANG_NONBLOCKING {
+        for (size_type i = 0; i < mShardCount; i++) {
+            Shard& shard = mShards[mNextShard];
+            mNextShard = (mNextShard + 1 == mShardCount) ? 0 : mNextShard + 1;
+            if (shard.tryConsume(fn)) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    /**
+     * @brief Try to pop one value.
+     *
+     * Must only be called from the consumer thread.
+     * If a value is successfully popped, it is moved into @p value, otherwise @p value is left unchanged.
+     *
+     * @param value The value to pop into.
+     *
+     * @return true if a value was popped, false if every shard was empty.
+     */
+    [[nodiscard]]
+    bool tryPop(T& value) noexcept SM_CLANG_NONBLOCKING
+#if __cpp_concepts >= 201907L
+        requires std::is_nothrow_move_assignable_v<T>
+#endif
+    {
+        return tryConsume([&value](T& underlying) noexcept { value = std::move(underlying); });
+    }
+
+    /**
+     * @brief Get an estimate of the number of items in every shard.
+     *
+     * @warning As this is a lock-free structure the count will be immediately out of date.
+     *
+     * @return The number of items in the queue.
+     */
+    size_type count() const noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+        size_type total = 0;
+        for (size_type i = 0; i < mShardCount; i++) {
+            total += mShards[i].count();
+        }
+
+        return total;
+    }
+
+    /**
+     * @brief Get the combined capacity of every shard.
+     *
+     * @return The maximum number of items the queue can hold.
+     */
+    size_type capacity() const noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+        return (mShardCount == 0) ? 0 : mShards[0].capacity() * mShardCount;
+    }
+
+    /**
+     * @brief Get the number of shards.
+     *
+     * @return The shard count.
+     */
+    size_type shardCount() const noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+        return mShardCount;
+    }
+
+    /**
+     * @brief Get a shard of the queue.
+     *
+     * @param index The index of the shard, must be less than shardCount().
+     *
+     * @return The shard.
+     */
+    Shard& shard(size_type index) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+        return mShards[index];
+    }
+
+    /**
+     * @brief Get the Allocator object used by the queue.
+     *
+     * @return The allocator.
+     */
+    allocator_type getAllocator() const noexcept {
+        return allocator_type(mAllocator);
+    }
+
+    /**
+     * @brief Provided for compatibility with standard containers.
+     *
+     * This is equivalent to `getAllocator()`.
+     *
+     * @return The allocator.
+     */
+    allocator_type get_allocator() const noexcept {
+        return allocator_type(mAllocator);
+    }
+
+    /**
+     * @brief Create a new queue.
+     *
+     * A shard count of about the number of processors suits ProcessorSharding, ThreadSharding needs one shard
+     * per producer thread to avoid sharing.
+     *
+     * @param shardCount The number of shards.
+     * @param shardCapacity The capacity of each shard.
+     * @param allocator The allocator used to allocate the shards and their storage.
+     *
+     * @return The queue if it was created successfully, std::nullopt otherwise.
+     */
+    [[nodiscard]]
+    static std::optional<ShardedRingBuffer> create(size_type shardCount, size_type shardCapacity, Allocator allocator = Allocator{}) noexcept {
+        if (shardCount == 0 || shardCapacity > (std::numeric_limits<size_type>::max)() / shardCount) {
+            return std::nullopt;
+        }
+
+        ShardAllocator shardAllocator{allocator};
+        Shard* shards = shardAllocator.allocate(shardCount);
+        if (shards == nullptr) {
+            return std::nullopt;
+        }
+
+        for (size_type i = 0; i < shardCount; i++) {
+            auto shard = Shard::create(shardCapacity, allocator);
+            if (!shard.has_value()) {
+                std::destroy_n(shards, i);
+                shardAllocator.deallocate(shards, shardCount);
+                return std::nullopt;
+            }
+
+            std::construct_at(&shards[i], std::move(*shard));
+        }
+
+        return ShardedRingBuffer{shards, shardCount, std::move(allocator)};
+    }
+};
+} // namespace sm::concurrent
@@ -0,0 +1,158 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <simcoe/concurrent/annotations.hpp>
+#include <simcoe/concurrent/parking.hpp>
+#include <thread>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86) || defined(_M_ARM64))
+#    include <intrin.h>
+#endif
+
+namespace sm::concurrent {
+/**
+ * @brief Tell the processor that the caller is spinning.
+ *
+ * Issues pause on x86 and yield on arm, which stops a spinning thread from starving
+ * the other hardware thread of an SMT core and saves power while waiting.
+ */
+inline void cpuRelax() noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    _mm_pause();
+#elif defined(_MSC_VER) && defined(_M_ARM64)
+    __yield();
+#elif defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    asm volatile("yield" ::: "memory");
+#else
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+}
+
+/**
+ * @brief How a SpinWait backs off.
+ *
+ * The first @p pauseRounds rounds pause the processor, each round pausing twice as many times
+ * as the last up to @p maxPauses. The next @p yieldRounds rounds yield the thread, after which
+ * the caller should park if it has something to park on. SpinWait::pause only uses @p maxPauses.
+ */
+struct SpinPolicy {
+    uint32_t pauseRounds;
+    uint32_t maxPauses;
+    uint32_t yieldRounds;
+};
+
+/**
+ * @brief Exponential backoff for spin loops.
+ *
+ * Each call site picks a SpinPolicy that suits how long it expects to wait. A loop that
+ * can be woken parks once the policy is exhausted, other loops keep backing off.
+ *
+ * @code{.cpp}
+ * SpinWait spin{{.pauseRounds = 6, .maxPauses = 32, .yieldRounds = 8}};
+ * while (!ready.load()) {
+ *     spin.spinOnce();
+ * }
+ * @endcode
+ */
+class SpinWait {
+    SpinPolicy mPolicy;
+
+    uint32_t mRound{0};
+
+    constexpr void advance() noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+        if (mRound != (std::numeric_limits<uint32_t>::max)()) {
+            mRound += 1;
+        }
+    }
+
+public:
+    constexpr explicit SpinWait(SpinPolicy policy) noexcept
+        : mPolicy(policy) {}
+
+    /**
+     * @brief Pause the processor, twice as long as the last call up to @p maxPauses.
+     *
+     * Never yields, so it can be used from nonblocking code such as compare exchange retries.
+     */
+    void pause() noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+        uint32_t pauses = (std::min)(uint32_t{1} << (std::min)(mRound, 31u), mPolicy.maxPauses);
+        for (uint32_t i = 0; i < pauses; i++) {
+            cpuRelax();
+        }
+
+        advance();
+    }
+
+    /**
+     * @brief Back off once.
+     *
+     * Pauses or yields depending on how many rounds have passed. Once every round is used it keeps
+     * yielding, or pausing for @p maxPauses if the policy does not yield.
+     */
+    void spinOnce() noexcept SM_CLANG_BLOCKING {
+        if (mRound < mPolicy.pauseRounds || mPolicy.yieldRounds == 0) {
+            pause();
+        } else {
+            std::this_thread::yield();
+            advance();
+        }
+    }
+
+    /**
+     * @brief Check if every round of the policy has been used.
+     *
+     * @return true if the caller should park rather than keep spinning.
+     */
+    constexpr bool shouldPark() const noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+        return mRound >= uint64_t{mPolicy.pauseRounds} + mPolicy.yieldRounds;
+    }
+
+    /**
+     * @brief Wait while @p word holds @p expected.
+     *
+     * Spins through the policy and then parks, a thread that changes @p word must unpark the waiter.
+     *
+     * @param word The word to wait on.
+     * @param expected The value to wait on.
+     */
+    void wait(const std::atomic<uint32_t>& word, uint32_t expected) noexcept SM_CLANG_BLOCKING {
+        while (word.load(std::memory_order_acquire) == expected) {
+            if (shouldPark()) {
+                park(word, expected);
+            } else {
+                spinOnce();
+            }
+        }
+    }
+
+    /**
+     * @brief Start backing off from the first round again, used after the loop made progress.
+     */
+    constexpr void reset() noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+        mRound = 0;
+    }
+
+    /**
+     * @brief Get the number of rounds backed off since the last reset.
+     *
+     * @return The round count.
+     */
+    constexpr uint32_t rounds() const noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+        return mRound;
+    }
+};
+
+/**
+ * @brief A spin policy for compare exchange retries, used with SpinWait::pause.
+ *
+ * A failed compare exchange means another thread made progress, so the backoff stays short.
+ */
+inline constexpr SpinPolicy kRetrySpin{.pauseRounds = 4, .maxPauses = 8, .yieldRounds = 0};
+} // namespace sm::concurrent
@@ -0,0 +1,289 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <simcoe/concurrent/annotations.hpp>
+#include <simcoe/concurrent/layout.hpp>
+#include <type_traits>
+
+namespace sm::concurrent {
+/**
+ * @brief A fixed size, single-producer single-consumer, wait free atomic ringbuffer.
+ *
+ * Elements are stored contiguously without the bitmap allocator and index indirection of RingBuffer.
+ * Each side keeps a cached copy of the other side's index and only reloads it when the queue
+ * appears to be full or empty, so in the common case neither side touches the other's cache line.
+ *
+ * @warning Unlike RingBuffer this queue is not reentrant, pushing from a signal handler that
+ *          interrupted a push on the same queue will corrupt it.
+ *
+ * @tparam T The type of elements stored in the ring buffer. Must be MoveAssignable and MoveConstructible.
+ * @tparam Allocator The allocator type used to allocate and deallocate memory for the ring buffer.
+ * @tparam Layout The layout policy, the cached indices are only effective when producer and consumer
+ *                fields are on separate cache lines.
+ *
+ * @cite RigtorpSPSCQueue SPSCQueue
+ */
+template <typename T, typename Allocator = std::allocator<T>, typename Layout = CacheAlignedLayout>
+#if __cpp_concepts >= 201907L
+    requires std::is_nothrow_move_constructible_v<T> && std::is_nothrow_move_assignable_v<T> && std::is_nothrow_destructible_v<T> && std::is_nothrow_default_constructible_v<Allocator>
+#endif
+class SpscRingBuffer {
+public:
+    using size_type = uint32_t;
+    using value_type = T;
+    using allocator_type = Allocator;
+
+private:
+    struct alignas(alignof(T)) Storage {
+        std::byte data[sizeof(T)];
+    };
+
+    using StorageAllocator = std::allocator_traits<Allocator>::template rebind_alloc<Storage>;
+
+    //
+    // Read mostly fields.
+    //
+    [[no_unique_address]] StorageAllocator mAllocator{};
+
+    Storage* mStorage{};
+
+    // The capacity of the ring buffer + 1, one slot is always left empty
+    // to distinguish a full queue from an empty one.
+    size_type mCapacity{};
+
+    //
+    // Fields written by the producer.
+    //
+    alignas(detail::kLayoutAlignment<Layout, std::atomic<size_type>>) std::atomic<size_type> mHead{};
+
+    size_type mCachedTail{};
+
+    //
+    // Fields written by the consumer.
+    //
+    alignas(detail::kLayoutAlignment<Layout, std::atomic<size_type>>) std::atomic<size_type> mTail{};
+
+    size_type mCachedHead{};
+
+    T& getElementAt(size_type index) noexcept SM_CLANG_NONBLOCKING {
+        return *reinterpret_cast<T*>(&mStorage[index]);
+    }
+
+    size_type next(size_type index) const noexcept SM_CLANG_NONBLOCKING {
+        index += 1;
+        return (index == mCapacity) ? 0 : index;
+    }
+
+    void clear() noexcept {
+        if (mStorage != nullptr) {
+            for (size_type i = mTail.load(); i != mHead.load(); i = next(i)) {
+                std::destroy_at(&getElementAt(i));
+            }
+
+            mAllocator.deallocate(mStorage, mCapacity);
+
+            mStorage = nullptr;
+            mCapacity = 0;
+        }
+    }
+
+    constexpr SpscRingBuffer(Storage* storage, size_type capacity, Allocator allocator) noexcept
+        : mAllocator(std::move(allocator))
+        , mStorage(storage)
+        , mCapacity(capacity + 1) {}
+
+public:
+    constexpr SpscRingBuffer() noexcept = default;
+
+    SpscRingBuffer(const SpscRingBuffer& other) = delete;
+    SpscRingBuffer& operator=(const SpscRingBuffer& other) = delete;
+
+    /**
+     * @brief Move construct a ring buffer.
+     *
+     * @note This function is not thread-safe and should only be called when no other threads are accessing the queue.
+     *
+     * @param other The other ring buffer to move from.
+     */
+    constexpr SpscRingBuffer(SpscRingBuffer&& other) noexcept
+        : mAllocator(std::move(other.mAllocator))
+        , mStorage(other.mStorage)
+        , mCapacity(other.mCapacity)
+        , mHead(other.mHead.load())
+        , mCachedTail(other.mCachedTail)
+        , mTail(other.mTail.load())
+        , mCachedHead(other.mCachedHead) {
+        other.mStorage = nullptr;
+        other.mCapacity = 0;
+    }
+
+    /**
+     * @brief Move assign a ring buffer.
+     *
+     * @note This function is not thread-safe and should only be called when no other threads are accessing the queue.
+     *
+     * @param other The other ring buffer to move from.
+     * @return The moved ring buffer.
+     */
+    constexpr SpscRingBuffer& operator=(SpscRingBuffer&& other) noexcept {
+        if (this != &other) {
+            clear();
+
+            mAllocator = std::move(other.mAllocator);
+            mStorage = other.mStorage;
+            mCapacity = other.mCapacity;
+            mHead.store(other.mHead.load());
+            mCachedTail = other.mCachedTail;
+            mTail.store(other.mTail.load());
+            mCachedHead = other.mCachedHead;
+
+            other.mStorage = nullptr;
+            other.mCapacity = 0;
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Destroy the ring buffer.
+     */
+    ~SpscRingBuffer() noexcept {
+        clear();
+    }
+
+    /**
+     * @brief Try to push a value onto the queue.
+     *
+     * Must only be called from the producer thread.
+     * If the value is successfully pushed then @p value is moved from, otherwise it is left unchanged.
+     *
+     * @param value The value to push.
+     *
+     * @return true if the value was pushed, false if the queue was full.
+     */
+    [[nodiscard]]
+    bool tryPush(T& value) noexcept SM_CLANG_NONBLOCKING {
+        auto head = mHead.load(std::memory_order_relaxed);
+        auto nextHead = next(head);
+        if (nextHead == mCachedTail) {
+            mCachedTail = mTail.load(std::memory_order_acquire);
+            if (nextHead == mCachedTail) {
+                return false;
+            }
+        }
+
+        std::construct_at(&getElementAt(head), std::move(value));
+        mHead.store(nextHead, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Try to pop a value from the queue.
+     *
+     * Must only be called from the consumer thread.
+     * If a value is successfully popped, it is moved into @p value, otherwise @p value is left unchanged.
+     *
+     * @param value The value to pop into.
+     *
+     * @return true if a value was popped, false if the queue was empty.
+     */
+    [[nodiscard]]
+    bool tryPop(T& value) noexcept SM_CLANG_NONBLOCKING {
+        auto tail = mTail.load(std::memory_order_relaxed);
+        if (tail == mCachedHead) {
+            mCachedHead = mHead.load(std::memory_order_acquire);
+            if (tail == mCachedHead) {
+                return false;
+            }
+        }
+
+        T& underlying = getElementAt(tail);
+        value = std::move(underlying);
+        std::destroy_at(&underlying);
+
+        mTail.store(next(tail), std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Get an estimate of the number of items in the queue.
+     *
+     * @warning As this is a lock-free structure the count will be immediately out of date.
+     *
+     * @return The number of items in the queue.
+     */
+    size_type count() const noexcept SM_CLANG_NONBLOCKING {
+        auto head = mHead.load();
+        auto tail = mTail.load();
+        return (head >= tail) ? (head - tail) : (mCapacity - tail + head);
+    }
+
+    /**
+     * @brief Get the maximum capacity of the queue.
+     *
+     * @return The maximum number of items the queue can hold.
+     */
+    size_type capacity() const noexcept SM_CLANG_NONBLOCKING {
+        return mCapacity - 1;
+    }
+
+    /**
+     * @brief Get the Allocator object used by the ring buffer.
+     *
+     * @return The allocator.
+     */
+    allocator_type getAllocator() const noexcept {
+        return mAllocator;
+    }
+
+    /**
+     * @brief Provided for compatibility with standard containers.
+     *
+     * This is equivalent to `getAllocator()`.
+     *
+     * @return The allocator.
+     */
+    allocator_type get_allocator() const noexcept {
+        return mAllocator;
+    }
+
+    /**
+     * @brief Get the number of elements allocated for a queue of the given capacity.
+     *
+     * @param capacity The capacity of the queue.
+     *
+     * @return The number of elements.
+     */
+    static constexpr size_t underlyingStorageElementCount(size_type capacity) noexcept {
+        return size_t{capacity} + 1;
+    }
+
+    /**
+     * @brief Create a new queue with the given capacity.
+     *
+     * @param capacity The maximum number of elements the queue can hold.
+     * @param allocator The allocator used to allocate and deallocate the storage.
+     *
+     * @return The ring buffer if it was created successfully, std::nullopt otherwise.
+     */
+    [[nodiscard]]
+    static std::optional<SpscRingBuffer> create(size_type capacity, Allocator allocator = Allocator{}) noexcept {
+        if (capacity == 0 || capacity == (std::numeric_limits<size_type>::max)()) {
+            return std::nullopt;
+        }
+
+        StorageAllocator storageAllocator{allocator};
+        auto storage = storageAllocator.allocate(underlyingStorageElementCount(capacity));
+        if (storage == nullptr) {
+            return std::nullopt;
+        }
+
+        return SpscRingBuffer{storage, capacity, std::move(allocator)};
+    }
+};
+} // namespace sm::concurrent
@@ -0,0 +1,148 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <simcoe/concurrent/annotations.hpp>
+#include <simcoe/concurrent/layout.hpp>
+#include <simcoe/concurrent/spin_wait.hpp>
+
+namespace sm::concurrent {
+namespace detail {
+/**
+ * @brief Get a small index that is stable for the calling thread.
+ *
+ * Indices are handed out round robin as threads first call this function.
+ *
+ * @warning Uses a thread_local, the first call on a thread may allocate and is not safe
+ *          from a signal handler.
+ */
+inline size_t threadIndex() noexcept {
+    static constinit std::atomic<size_t> sNextIndex{0};
+    thread_local size_t tIndex = sNextIndex.fetch_add(1, std::memory_order_relaxed);
+    return tIndex;
+}
+
+/**
+ * @brief Get a hint for spreading the calling thread's writes across stripes.
+ *
+ * Derived from the address of the caller's stack, threads have separate stacks so threads running at the
+ * same time rarely get the same hint. The hint may change with call depth, so it only suits data that is
+ * merged across stripes. Unlike threadIndex it touches no thread_local and is safe from a signal handler.
+ */
+inline size_t stripeHint() noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+    int marker = 0;
+
+    // Stacks are at least tens of kilobytes apart, drop the bits that only change with call depth.
+    uint64_t page = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(&marker)) >> 16;
+    return static_cast<size_t>((page * 0x9E3779B97F4A7C15ull) >> 32);
+}
+} // namespace detail
+
+/**
+ * @brief A point in time copy of a set of counters.
+ *
+ * @tparam Counter The enum of counters, must end with an eCount enumerator.
+ *                 isHighWaterMark(Counter) is found by ADL and selects counters that record a maximum.
+ */
+template <typename Counter>
+struct StatsSnapshot {
+    static constexpr size_t kCount = static_cast<size_t>(Counter::eCount);
+
+    uint64_t values[kCount]{};
+
+    constexpr uint64_t operator[](Counter counter) const noexcept {
+        return values[static_cast<size_t>(counter)];
+    }
+};
+
+/**
+ * @brief Stats policy that records nothing.
+ *
+ * Every operation compiles away and the storage takes no space.
+ */
+struct NoStats {
+    static constexpr bool kEnabled = false;
+
+    template <typename Counter>
+    struct Storage {
+        constexpr void add(Counter, uint64_t = 1) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {}
+        constexpr void max(Counter, uint64_t) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {}
+
+        constexpr StatsSnapshot<Counter> snapshot() const noexcept {
+            return {};
+        }
+    };
+};
+
+/**
+ * @brief Stats policy that records counters in cache line isolated stripes.
+ *
+ * Each update goes to the stripe selected by the caller's stack address, so threads measuring the same
+ * structure rarely write to the same cache line and updates are safe from a signal handler. A snapshot sums counters across every stripe,
+ * high water marks take the largest value of any stripe.
+ *
+ * @tparam Stripes The number of stripes.
+ */
+template <size_t Stripes = 16>
+struct BasicAtomicStats {
+    static_assert(Stripes > 0, "Stripes must be greater than 0");
+
+    static constexpr bool kEnabled = true;
+
+    template <typename Counter>
+    class Storage {
+        static constexpr size_t kCount = static_cast<size_t>(Counter::eCount);
+
+        struct alignas(kCacheLineSize) Stripe {
+            std::atomic<uint64_t> values[kCount]{};
+        };
+
+        Stripe mStripes[Stripes];
+
+        std::atomic<uint64_t>& counterFor(Counter counter) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+            return mStripes[detail::stripeHint() % Stripes].values[static_cast<size_t>(counter)];
+        }
+
+    public:
+        void add(Counter counter, uint64_t value = 1) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+            counterFor(counter).fetch_add(value, std::memory_order_relaxed);
+        }
+
+        void max(Counter counter, uint64_t value) noexcept SM_CLANG_NONBLOCKING SM_CLANG_REENTRANT {
+            auto& current = counterFor(counter);
+            uint64_t previous = current.load(std::memory_order_relaxed);
+            SpinWait spin{kRetrySpin};
+            while (previous < value && !current.compare_exchange_weak(previous, value, std::memory_order_relaxed)) {
+                spin.pause();
+            }
+        }
+
+        /**
+         * @brief Copy every counter.
+         *
+         * @return The counters, updates that race with the snapshot may or may not be included.
+         */
+        StatsSnapshot<Counter> snapshot() const noexcept {
+            StatsSnapshot<Counter> result;
+            for (const Stripe& stripe : mStripes) {
+                for (size_t i = 0; i < kCount; i++) {
+                    uint64_t value = stripe.values[i].load(std::memory_order_relaxed);
+                    if (isHighWaterMark(static_cast<Counter>(i))) {
+                        result.values[i] = (result.values[i] > value) ? result.values[i] : value;
+                    } else {
+                        result.values[i] += value;
+                    }
+                }
+            }
+
+            return result;
+        }
+    };
+};
+
+using AtomicStats = BasicAtomicStats<>;
+
+} // namespace sm::concurrent
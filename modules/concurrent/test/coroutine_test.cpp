@@ -0,0 +1,297 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <csignal>
+#include <coroutine>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include <simcoe/concurrent/mailbox.hpp>
+#include <simcoe/concurrent/ring_buffer.hpp>
+
+#if defined(__linux__)
+#    include <sys/mman.h>
+#    include <unistd.h>
+#endif
+
+namespace {
+// A coroutine that starts immediately and destroys itself when it finishes.
+struct DetachedTask {
+    struct promise_type {
+        DetachedTask get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+// Holds the woken coroutine until the test resumes it, as an event loop would.
+struct DeferredScheduler {
+    std::atomic<void*>* pending;
+
+    void schedule(std::coroutine_handle<> handle) const noexcept {
+        pending->store(handle.address(), std::memory_order_release);
+    }
+};
+
+static_assert(sm::concurrent::CoroutineScheduler<DeferredScheduler>);
+static_assert(sm::concurrent::CoroutineScheduler<sm::concurrent::InlineScheduler>);
+
+bool resumePending(std::atomic<void*>& pending) {
+    void* address = pending.exchange(nullptr, std::memory_order_acquire);
+    if (address == nullptr) {
+        return false;
+    }
+
+    std::coroutine_handle<>::from_address(address).resume();
+    return true;
+}
+
+using Queue = sm::concurrent::RingBuffer<int>;
+using Mailbox = sm::concurrent::AtomicMailbox<int>;
+
+DetachedTask popInto(Queue& queue, std::vector<int>& values, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        values.push_back(co_await queue.pop());
+    }
+}
+
+template <typename Scheduler>
+DetachedTask popInto(Queue& queue, std::vector<int>& values, size_t count, Scheduler scheduler) {
+    for (size_t i = 0; i < count; i++) {
+        values.push_back(co_await queue.pop(scheduler));
+    }
+}
+
+DetachedTask readInto(Mailbox& mailbox, std::vector<int>& values, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        co_await mailbox.next();
+        std::lock_guard guard(mailbox);
+        values.push_back(mailbox.read());
+    }
+}
+} // namespace
+
+TEST(RingBufferCoroutineTest, ReadyDoesNotSuspend) {
+    auto queue = Queue::create(16).value();
+    ASSERT_TRUE(queue.tryEmplace(1));
+    ASSERT_TRUE(queue.tryEmplace(2));
+
+    std::vector<int> values;
+    popInto(queue, values, 2);
+
+    ASSERT_EQ(values, (std::vector<int>{1, 2}));
+}
+
+TEST(RingBufferCoroutineTest, PushResumes) {
+    auto queue = Queue::create(16).value();
+
+    std::vector<int> values;
+    popInto(queue, values, 3);
+    ASSERT_TRUE(values.empty());
+
+    for (int i = 0; i < 3; i++) {
+        ASSERT_TRUE(queue.tryEmplace(i));
+        ASSERT_EQ(values.size(), i + 1);
+        ASSERT_EQ(values.back(), i);
+    }
+
+    // The coroutine has finished, further pushes have no waiter to wake.
+    ASSERT_TRUE(queue.tryEmplace(3));
+    ASSERT_EQ(values.size(), 3);
+}
+
+TEST(RingBufferCoroutineTest, SchedulerDecidesWhereToResume) {
+    auto queue = Queue::create(16).value();
+    std::atomic<void*> pending{nullptr};
+
+    std::vector<int> values;
+    popInto(queue, values, 1, DeferredScheduler{&pending});
+
+    ASSERT_TRUE(queue.tryEmplace(42));
+    ASSERT_TRUE(values.empty());
+    ASSERT_NE(pending.load(), nullptr);
+
+    ASSERT_TRUE(resumePending(pending));
+    ASSERT_EQ(values, (std::vector<int>{42}));
+}
+
+TEST(RingBufferCoroutineTest, ProducerThread) {
+    static constexpr int kCount = 50000;
+
+    auto queue = Queue::create(64).value();
+    std::atomic<void*> pending{nullptr};
+
+    std::vector<int> values;
+    popInto(queue, values, kCount, DeferredScheduler{&pending});
+
+    std::atomic<bool> done{false};
+    std::thread producer([&] {
+        for (int i = 0; i < kCount; i++) {
+            while (!queue.tryEmplace(i)) {
+                std::this_thread::yield();
+            }
+        }
+        done.store(true);
+    });
+
+    while (values.size() < kCount) {
+        if (!resumePending(pending)) {
+            std::this_thread::yield();
+        }
+    }
+
+    producer.join();
+
+    ASSERT_TRUE(done.load());
+    for (int i = 0; i < kCount; i++) {
+        ASSERT_EQ(values[i], i);
+    }
+}
+
+#if defined(__linux__)
+namespace {
+#    if defined(__SANITIZE_THREAD__)
+constexpr bool kThreadSanitizer = true;
+#    elif defined(__has_feature)
+constexpr bool kThreadSanitizer = __has_feature(thread_sanitizer);
+#    else
+constexpr bool kThreadSanitizer = false;
+#    endif
+
+Queue* gStalledQueue = nullptr;
+std::atomic<void*>* gStalledPending = nullptr;
+void* gStalledPage = nullptr;
+bool gResumedEarly = false;
+
+void pushPastStalledTail(int) {
+    // The push that claimed the tail faulted before publishing it, publish the element after it.
+    if (!gStalledQueue->tryEmplace(2) || gStalledPending->load() != nullptr) {
+        gResumedEarly = true;
+    }
+
+    mprotect(gStalledPage, size_t(sysconf(_SC_PAGESIZE)), PROT_READ | PROT_WRITE);
+}
+} // namespace
+
+TEST(RingBufferCoroutineTest, WaitsForTailToPublish) {
+    static constexpr uint32_t kCapacity = 4096;
+
+    if (kThreadSanitizer) {
+        GTEST_SKIP() << "The fault is taken inside the sanitizer's atomic store, which holds a lock the handler needs";
+    }
+
+    size_t page = size_t(sysconf(_SC_PAGESIZE));
+    size_t size = Queue::requiredInPlaceSize(kCapacity);
+    void* mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    ASSERT_NE(mapping, MAP_FAILED);
+
+    std::byte* region = static_cast<std::byte*>(mapping);
+    Queue* queue = Queue::createInPlace(std::span(region, size), kCapacity);
+    ASSERT_NE(queue, nullptr);
+
+    // The element indices are the only part of a fresh queue that is not zero, they start empty.
+    size_t indices = 0;
+    while (indices + sizeof(uint32_t) <= size) {
+        uint32_t word = 0;
+        std::memcpy(&word, region + indices, sizeof(word));
+        if (word == UINT32_MAX) {
+            break;
+        }
+
+        indices += sizeof(uint32_t);
+    }
+
+    // Move the tail to the last index on a page that holds nothing but indices, the next index is on the next page.
+    size_t stalledPage = (indices / page + 2) * page;
+    uint32_t tail = uint32_t((stalledPage + page - indices) / sizeof(uint32_t) - 1);
+    ASSERT_LT(tail + 1, kCapacity);
+    for (uint32_t i = 0; i < tail; i++) {
+        int value = 0;
+        ASSERT_TRUE(queue->tryEmplace(0));
+        ASSERT_TRUE(queue->tryPop(value));
+    }
+
+    std::atomic<void*> pending{nullptr};
+    std::vector<int> values;
+    popInto(*queue, values, 2, DeferredScheduler{&pending});
+
+    gStalledQueue = queue;
+    gStalledPending = &pending;
+    gStalledPage = region + stalledPage;
+    ASSERT_EQ(mprotect(gStalledPage, page, PROT_READ), 0);
+
+    struct sigaction action {};
+    struct sigaction previous {};
+    action.sa_handler = pushPastStalledTail;
+    sigemptyset(&action.sa_mask);
+    ASSERT_EQ(sigaction(SIGSEGV, &action, &previous), 0);
+
+    ASSERT_TRUE(queue->tryEmplace(1));
+    sigaction(SIGSEGV, &previous, nullptr);
+
+    // The push behind the unpublished tail must not resume the consumer, the push that publishes the tail does.
+    ASSERT_FALSE(gResumedEarly);
+    ASSERT_TRUE(resumePending(pending));
+    ASSERT_EQ(values, (std::vector<int>{1, 2}));
+
+    std::destroy_at(queue);
+    munmap(mapping, size);
+}
+#endif
+
+TEST(MailboxCoroutineTest, WaitsForWrite) {
+    Mailbox mailbox;
+
+    std::vector<int> values;
+    readInto(mailbox, values, 2);
+    ASSERT_TRUE(values.empty());
+
+    mailbox.write(1);
+    ASSERT_EQ(values, (std::vector<int>{1}));
+
+    mailbox.write(2);
+    ASSERT_EQ(values, (std::vector<int>{1, 2}));
+}
+
+TEST(MailboxCoroutineTest, MissedWriteIsReady) {
+    Mailbox mailbox;
+    mailbox.write(7);
+
+    std::vector<int> values;
+    readInto(mailbox, values, 1);
+
+    ASSERT_EQ(values, (std::vector<int>{7}));
+}
+
+TEST(MailboxCoroutineTest, WriterThread) {
+    static constexpr int kCount = 10000;
+
+    Mailbox mailbox;
+
+    std::vector<int> values;
+    readInto(mailbox, values, kCount);
+
+    std::thread writer([&] {
+        for (int i = 0; i < kCount; i++) {
+            mailbox.write(i);
+        }
+    });
+
+    writer.join();
+
+    // The writer waits for each read, and the reader resumes on the writer thread, so no write is skipped.
+    ASSERT_EQ(values.size(), kCount);
+    for (int i = 0; i < kCount; i++) {
+        ASSERT_EQ(values[i], i);
+    }
+}
@@ -0,0 +1,162 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <latch>
+#include <thread>
+#include <vector>
+
+#include <simcoe/concurrent/inline_ring_buffer.hpp>
+
+static_assert(sm::concurrent::kIsInlineValue<void*>);
+static_assert(sm::concurrent::kIsInlineValue<uint16_t>);
+static_assert(!sm::concurrent::kIsInlineValue<std::pair<uint64_t, uint64_t>>);
+
+TEST(InlineRingBufferConstructTest, Construct) {
+    auto queue = sm::concurrent::InlineRingBuffer<int*>::create(1024).value();
+    ASSERT_EQ(queue.capacity(), 1024);
+    ASSERT_EQ(queue.count(), 0);
+}
+
+TEST(InlineRingBufferConstructTest, ConstructFail) {
+    ASSERT_FALSE(sm::concurrent::InlineRingBuffer<int*>::create(0).has_value());
+    ASSERT_FALSE((sm::concurrent::InlineRingBuffer<int*, std::allocator<int*>, sm::concurrent::Pow2Capacity>::create(3).has_value()));
+}
+
+TEST(InlineRingBufferConstructTest, Footprint) {
+    ASSERT_EQ(sm::concurrent::InlineRingBuffer<int*>::underlyingStorageElementCount(1024), 1024);
+}
+
+TEST(InlineRingBufferConstructTest, CacheAlignedLayout) {
+    using AlignedRingBuffer = sm::concurrent::InlineRingBuffer<int*, std::allocator<int*>, sm::concurrent::DynamicCapacity, sm::concurrent::CacheAlignedLayout>;
+
+    // Read mostly, producer, consumer, and the consumer's wake state each take a line.
+    static_assert(sizeof(AlignedRingBuffer) == 4 * sm::concurrent::kCacheLineSize);
+
+    auto queue = AlignedRingBuffer::create(16).value();
+    int value = 42;
+    int* result = nullptr;
+    ASSERT_TRUE(queue.tryPush(&value));
+    ASSERT_TRUE(queue.tryPop(result));
+    ASSERT_EQ(result, &value);
+}
+
+class InlineRingBufferSizedTest : public testing::TestWithParam<uint32_t> {
+public:
+    sm::concurrent::InlineRingBuffer<uint64_t> queue;
+
+    void SetUp() override {
+        auto result = sm::concurrent::InlineRingBuffer<uint64_t>::create(GetParam());
+        ASSERT_TRUE(result.has_value());
+        queue = std::move(result.value());
+
+        ASSERT_EQ(queue.capacity(), GetParam());
+        ASSERT_EQ(queue.count(), 0);
+    }
+};
+
+TEST_P(InlineRingBufferSizedTest, PushFull) {
+    for (uint64_t i = 0; i < queue.capacity(); i++) {
+        ASSERT_TRUE(queue.tryPush(i)) << "Failed to push at index " << i;
+    }
+    ASSERT_EQ(queue.count(), queue.capacity());
+    ASSERT_FALSE(queue.tryPush(0));
+}
+
+TEST_P(InlineRingBufferSizedTest, PopEmpty) {
+    uint64_t value = 42;
+    ASSERT_FALSE(queue.tryPop(value));
+    ASSERT_EQ(value, 42);
+}
+
+TEST_P(InlineRingBufferSizedTest, RejectEmptyValue) {
+    ASSERT_FALSE(queue.tryPush(UINT64_MAX));
+    ASSERT_EQ(queue.count(), 0);
+}
+
+TEST_P(InlineRingBufferSizedTest, OrderAcrossLaps) {
+    uint64_t next = 0;
+    uint64_t expected = 0;
+    for (size_t lap = 0; lap < 4; lap++) {
+        for (size_t i = 0; i < queue.capacity(); i++) {
+            ASSERT_TRUE(queue.tryPush(next++));
+        }
+
+        for (size_t i = 0; i < queue.capacity(); i++) {
+            uint64_t value = 0;
+            ASSERT_TRUE(queue.tryPop(value));
+            ASSERT_EQ(value, expected++);
+        }
+    }
+
+    ASSERT_EQ(queue.count(), 0);
+}
+
+TEST_P(InlineRingBufferSizedTest, PushNPopN) {
+    std::vector<uint64_t> values;
+    for (uint64_t i = 0; i < queue.capacity() + 3; i++) {
+        values.push_back(i);
+    }
+
+    ASSERT_EQ(queue.tryPushN(values), queue.capacity());
+    ASSERT_EQ(queue.count(), queue.capacity());
+
+    std::vector<uint64_t> popped(queue.capacity() + 1);
+    ASSERT_EQ(queue.tryPopN(popped), queue.capacity());
+    ASSERT_EQ(queue.count(), 0);
+
+    for (uint64_t i = 0; i < queue.capacity(); i++) {
+        ASSERT_EQ(popped[i], i) << "Unexpected value at index " << i;
+    }
+}
+
+TEST_P(InlineRingBufferSizedTest, PushNStopsAtEmptyValue) {
+    std::vector<uint64_t> values = {1, 2, UINT64_MAX, 4};
+
+    ASSERT_EQ(queue.tryPushN(values), (std::min)(queue.capacity(), 2u));
+}
+
+TEST_P(InlineRingBufferSizedTest, Consume) {
+    ASSERT_TRUE(queue.tryEmplace(uint64_t{7}));
+    ASSERT_TRUE(queue.tryConsume([](uint64_t& value) noexcept { EXPECT_EQ(value, 7); }));
+    ASSERT_FALSE(queue.tryConsume([](uint64_t&) noexcept { FAIL() << "Consumed from an empty queue"; }));
+}
+
+INSTANTIATE_TEST_SUITE_P(InlineRingBufferTests, InlineRingBufferSizedTest, testing::Values(1, 2, 3, 64, 1000));
+
+TEST(InlineRingBufferThreadTest, ThreadSafe) {
+    static constexpr size_t kProducerCount = 8;
+    static constexpr uint64_t kPerProducer = 0x1000;
+
+    auto queue = sm::concurrent::InlineRingBuffer<uint64_t>::create(256).value();
+
+    std::vector<std::jthread> producers;
+    std::latch latch{kProducerCount + 1};
+
+    for (size_t i = 0; i < kProducerCount; i++) {
+        producers.emplace_back([&, i] {
+            latch.arrive_and_wait();
+            for (uint64_t j = 0; j < kPerProducer; j++) {
+                uint64_t value = (i * kPerProducer) + j;
+                while (!queue.tryPush(value)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    std::vector<uint64_t> consumed;
+    consumed.reserve(kProducerCount * kPerProducer);
+
+    latch.arrive_and_wait();
+    while (consumed.size() < kProducerCount * kPerProducer) {
+        uint64_t value = 0;
+        if (queue.popFor(value, std::chrono::milliseconds(100))) {
+            consumed.push_back(value);
+        }
+    }
+
+    std::sort(consumed.begin(), consumed.end());
+    for (uint64_t i = 0; i < consumed.size(); i++) {
+        ASSERT_EQ(consumed[i], i) << "Mismatch at index " << i;
+    }
+}
@@ -0,0 +1,104 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+
+#include <simcoe/concurrent/keyed_limiter.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+class KeyedLimiterTest : public testing::Test {
+public:
+    sm::concurrent::FrameCounter counter;
+    sm::concurrent::FrameClock clock{counter, 1ms};
+};
+
+TEST_F(KeyedLimiterTest, KeysAreIndependent) {
+    auto limiter = std::make_unique<sm::concurrent::KeyedLimiter<64, sm::concurrent::FrameClock>>(3ms, clock);
+
+    for (uint64_t key = 0; key < 8; key++) {
+        ASSERT_TRUE(limiter->isActive(key)) << "Key " << key << " was not activated";
+        ASSERT_FALSE(limiter->isActive(key)) << "Key " << key << " was activated twice";
+    }
+
+    counter.advance(3);
+
+    for (uint64_t key = 0; key < 8; key++) {
+        ASSERT_TRUE(limiter->isActive(key)) << "Key " << key << " was not activated after the interval";
+    }
+}
+
+TEST_F(KeyedLimiterTest, HashedKeys) {
+    auto limiter = std::make_unique<sm::concurrent::KeyedLimiter<64, sm::concurrent::FrameClock>>(1ms, clock);
+
+    ASSERT_TRUE(limiter->isActive(std::string("disk full")));
+    ASSERT_TRUE(limiter->isActive(std::string("network down")));
+    ASSERT_FALSE(limiter->isActive(std::string("disk full")));
+}
+
+TEST_F(KeyedLimiterTest, MoreKeysThanEntries) {
+    auto limiter = std::make_unique<sm::concurrent::KeyedLimiter<16, sm::concurrent::FrameClock>>(100ms, clock);
+
+    // keys that do not fit are mostly limited, but the table keeps working
+    size_t activations = 0;
+    for (uint64_t key = 0; key < 1024; key++) {
+        if (limiter->isActive(key)) {
+            activations += 1;
+        }
+    }
+
+    ASSERT_GE(activations, 16);
+    ASSERT_LT(activations, 1024);
+
+    // once every entry has passed its interval new keys take them over
+    counter.advance(100);
+    ASSERT_TRUE(limiter->isActive(uint64_t{5000}));
+    ASSERT_FALSE(limiter->isActive(uint64_t{5000}));
+}
+
+TEST_F(KeyedLimiterTest, Concurrent) {
+    static constexpr size_t kThreadCount = 8;
+    static constexpr uint64_t kKeyCount = 32;
+
+    sm::concurrent::KeyedLimiter<256, sm::concurrent::FrameClock> limiter{1ms, clock};
+    std::atomic<size_t> activations[kKeyCount]{};
+
+    {
+        std::vector<std::jthread> threads;
+        for (size_t i = 0; i < kThreadCount; i++) {
+            threads.emplace_back([&] {
+                for (size_t round = 0; round < 1000; round++) {
+                    for (uint64_t key = 0; key < kKeyCount; key++) {
+                        if (limiter.isActive(key)) {
+                            activations[key] += 1;
+                        }
+                    }
+                }
+            });
+        }
+    }
+
+    // the clock never advanced, so each key activates exactly once
+    for (uint64_t key = 0; key < kKeyCount; key++) {
+        ASSERT_EQ(activations[key].load(), 1) << "Key " << key;
+    }
+}
+
+TEST(RateLimitedTest, PerCallSite) {
+    int first = 0;
+    int second = 0;
+    for (int i = 0; i < 100; i++) {
+        if (SM_RATE_LIMITED(std::chrono::hours(1))) {
+            first += 1;
+        }
+
+        if (SM_RATE_LIMITED(std::chrono::hours(1))) {
+            second += 1;
+        }
+    }
+
+    ASSERT_EQ(first, 1);
+    ASSERT_EQ(second, 1);
+}
@@ -0,0 +1,187 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <csignal>
+#include <initializer_list>
+#include <thread>
+#include <vector>
+
+#include <simcoe/concurrent/latency_histogram.hpp>
+#include <simcoe/concurrent/mailbox.hpp>
+#include <simcoe/concurrent/ring_buffer.hpp>
+
+using sm::concurrent::HistogramSnapshot;
+using sm::concurrent::LatencyHistogram;
+
+namespace {
+/**
+ * @brief A clock that only moves when the test advances it.
+ */
+struct ManualClock {
+    uint64_t* time;
+
+    uint64_t now() const noexcept {
+        return *time;
+    }
+
+    constexpr uint64_t ticks(std::chrono::nanoseconds interval) const noexcept {
+        return static_cast<uint64_t>(interval.count());
+    }
+};
+} // namespace
+
+TEST(LatencyHistogramTest, BucketsCoverRange) {
+    using Buckets = sm::concurrent::detail::HistogramBuckets<5, 40>;
+
+    // Every bucket starts one past the end of the previous one.
+    for (size_t i = 1; i < Buckets::kCount; i++) {
+        ASSERT_EQ(Buckets::lowest(i), Buckets::highest(i - 1) + 1) << i;
+    }
+
+    ASSERT_EQ(Buckets::highest(Buckets::kCount - 1), Buckets::kMaxValue);
+
+    for (uint64_t value : std::initializer_list<uint64_t>{0, 1, 31, 32, 33, 1000, 123456789, Buckets::kMaxValue}) {
+        size_t index = Buckets::indexOf(value);
+        ASSERT_LE(Buckets::lowest(index), value);
+        ASSERT_GE(Buckets::highest(index), value);
+
+        // The bucket is at most 1/16 of the value wide.
+        ASSERT_LE(Buckets::highest(index) - Buckets::lowest(index), value / 16);
+    }
+
+    ASSERT_EQ(Buckets::indexOf(Buckets::kMaxValue + 1), Buckets::kCount - 1);
+}
+
+TEST(LatencyHistogramTest, Percentiles) {
+    HistogramSnapshot<> snapshot;
+    ASSERT_EQ(snapshot.percentile(0.5), 0);
+    ASSERT_EQ(snapshot.max(), 0);
+
+    for (uint64_t i = 1; i <= 1000; i++) {
+        snapshot.record(i);
+    }
+
+    ASSERT_EQ(snapshot.count(), 1000);
+    ASSERT_DOUBLE_EQ(snapshot.mean(), 500.5);
+    ASSERT_EQ(snapshot.min(), 1);
+
+    auto near = [](uint64_t actual, uint64_t expected) {
+        return actual >= expected && actual <= expected + expected / 16;
+    };
+
+    ASSERT_TRUE(near(snapshot.percentile(0.5), 500)) << snapshot.percentile(0.5);
+    ASSERT_TRUE(near(snapshot.percentile(0.99), 990)) << snapshot.percentile(0.99);
+    ASSERT_TRUE(near(snapshot.max(), 1000)) << snapshot.max();
+    ASSERT_EQ(snapshot.percentile(0.0), 1);
+    ASSERT_EQ(snapshot.percentile(1.0), snapshot.max());
+}
+
+TEST(LatencyHistogramTest, Merge) {
+    HistogramSnapshot<> first;
+    HistogramSnapshot<> second;
+    first.record(10, 3);
+    second.record(10);
+    second.record(5000);
+
+    first.merge(second);
+    ASSERT_EQ(first.count(), 5);
+    ASSERT_EQ(first.countAt(10), 4);
+    ASSERT_EQ(first.countAt(5000), 1);
+    ASSERT_EQ(first.percentile(0.8), 10);
+}
+
+TEST(LatencyHistogramTest, ConcurrentRecord) {
+    static constexpr int kThreads = 4;
+    static constexpr uint64_t kValues = 10000;
+
+    LatencyHistogram histogram;
+
+    {
+        std::vector<std::jthread> threads;
+        for (int t = 0; t < kThreads; t++) {
+            threads.emplace_back([&histogram] {
+                for (uint64_t i = 0; i < kValues; i++) {
+                    histogram.record(i);
+                }
+            });
+        }
+    }
+
+    auto snapshot = histogram.snapshot();
+    ASSERT_EQ(snapshot.count(), kThreads * kValues);
+    ASSERT_EQ(snapshot.countAt(0), kThreads);
+    ASSERT_DOUBLE_EQ(snapshot.mean(), static_cast<double>(kValues - 1) / 2);
+
+    histogram.reset();
+    ASSERT_EQ(histogram.snapshot().count(), 0);
+}
+
+#if defined(__linux__)
+namespace {
+LatencyHistogram* gSignalHistogram = nullptr;
+
+void recordFromSignal(int) {
+    gSignalHistogram->record(7);
+}
+} // namespace
+
+TEST(LatencyHistogramTest, RecordFromHandler) {
+    LatencyHistogram histogram;
+    gSignalHistogram = &histogram;
+
+    auto previous = std::signal(SIGUSR1, recordFromSignal);
+    histogram.record(3);
+    std::raise(SIGUSR1);
+    std::signal(SIGUSR1, previous);
+
+    auto snapshot = histogram.snapshot();
+    ASSERT_EQ(snapshot.count(), 2);
+    ASSERT_EQ(snapshot.countAt(7), 1);
+}
+#endif
+
+TEST(LatencyHistogramTest, RecordQueueResidency) {
+    uint64_t time = 100;
+    LatencyHistogram histogram;
+    sm::concurrent::LatencyRecorder recorder{histogram, ManualClock{&time}};
+
+    auto queue = sm::concurrent::RingBuffer<sm::concurrent::Timestamped<int>>::create(16).value();
+    ASSERT_TRUE(queue.tryEmplace(recorder.stamp(1)));
+    time += 20;
+    ASSERT_TRUE(queue.tryEmplace(recorder.stamp(2)));
+    time += 5;
+
+    sm::concurrent::Timestamped<int> element{};
+    while (queue.tryPop(element)) {
+        recorder.record(element);
+    }
+
+    auto snapshot = histogram.snapshot();
+    ASSERT_EQ(snapshot.count(), 2);
+    ASSERT_EQ(snapshot.countAt(25), 1);
+    ASSERT_EQ(snapshot.countAt(5), 1);
+
+    // A stamp from the future records zero rather than wrapping.
+    recorder.record(time + 10);
+    ASSERT_EQ(histogram.snapshot().countAt(0), 1);
+}
+
+TEST(LatencyHistogramTest, RecordMailboxStaleness) {
+    uint64_t time = 0;
+    LatencyHistogram histogram;
+    sm::concurrent::LatencyRecorder recorder{histogram, ManualClock{&time}};
+
+    sm::concurrent::AtomicMailbox<sm::concurrent::Timestamped<int>> mailbox;
+    mailbox.beginWrite() = recorder.stamp(42);
+    mailbox.commit();
+
+    time += 1000;
+    mailbox.lock();
+    recorder.record(mailbox.read());
+    ASSERT_EQ(mailbox.read().value, 42);
+    mailbox.unlock();
+
+    ASSERT_GE(histogram.snapshot().percentile(0.5), 1000);
+}
@@ -65,3 +65,130 @@ TEST_F(LimitingFlagTest, AtMostEverySingleThread) {
     EXPECT_GE(activations, lower_bound);
     EXPECT_LE(activations, upper_bound);
 }
+
+template <typename Flag>
+int countActivations(Flag& flag, std::chrono::milliseconds duration) {
+    int activations = 0;
+
+    auto end = std::chrono::high_resolution_clock::now() + duration;
+    while (std::chrono::high_resolution_clock::now() < end) {
+        if (flag.isActive()) {
+            activations++;
+        }
+    }
+
+    return activations;
+}
+
+TEST_F(LimitingFlagTest, CoarseMonotonicClock) {
+    auto duration = std::chrono::milliseconds(500);
+    auto interval = std::chrono::milliseconds(20);
+    sm::concurrent::BasicAtMostEvery<sm::concurrent::CoarseMonotonicClock> flag(interval);
+
+    // the coarse clock rounds to the scheduler tick, so the band is wider
+    auto ideal = duration / interval;
+    int activations = countActivations(flag, duration);
+    EXPECT_GE(activations, ideal * 0.6);
+    EXPECT_LE(activations, ideal * 1.2);
+}
+
+TEST_F(LimitingFlagTest, TscClock) {
+    ASSERT_GT(sm::concurrent::TscClock::frequency(), 0);
+
+    auto duration = std::chrono::milliseconds(500);
+    auto interval = std::chrono::milliseconds(10);
+    sm::concurrent::BasicAtMostEvery<sm::concurrent::TscClock> flag(interval);
+
+    auto ideal = duration / interval;
+    int activations = countActivations(flag, duration);
+    EXPECT_GE(activations, ideal * 0.8);
+    EXPECT_LE(activations, ideal * 1.2);
+}
+
+TEST_F(LimitingFlagTest, FrameClock) {
+    using namespace std::chrono_literals;
+
+    sm::concurrent::FrameCounter counter;
+    sm::concurrent::FrameClock clock{counter, 16ms};
+
+    // 40ms rounds up to 3 frames
+    sm::concurrent::BasicAtMostEvery flag(40ms, clock);
+
+    // frame zero is a valid activation time
+    for (int frame = 0; frame < 12; frame++) {
+        ASSERT_EQ(flag.isActive(), frame % 3 == 0) << "Unexpected activation at frame " << frame;
+        ASSERT_FALSE(flag.isActive()) << "Activated twice at frame " << frame;
+        counter.advance();
+    }
+}
+
+TEST_F(LimitingFlagTest, TokenBucketBurst) {
+    using namespace std::chrono_literals;
+
+    sm::concurrent::FrameCounter counter;
+    sm::concurrent::FrameClock clock{counter, 1ms};
+
+    // one token per frame, with bursts of 3
+    sm::concurrent::BasicTokenBucket bucket(1000, 1s, 3, clock);
+
+    for (int i = 0; i < 3; i++) {
+        ASSERT_TRUE(bucket.isActive()) << "Burst ended early at " << i;
+    }
+    ASSERT_FALSE(bucket.isActive());
+
+    counter.advance();
+    ASSERT_TRUE(bucket.isActive());
+    ASSERT_FALSE(bucket.isActive());
+
+    // an idle bucket refills up to the burst size and no further
+    counter.advance(10);
+    for (int i = 0; i < 3; i++) {
+        ASSERT_TRUE(bucket.isActive()) << "Refill ended early at " << i;
+    }
+    ASSERT_FALSE(bucket.isActive());
+}
+
+TEST_F(LimitingFlagTest, TokenBucketWeighted) {
+    using namespace std::chrono_literals;
+
+    sm::concurrent::FrameCounter counter;
+    sm::concurrent::FrameClock clock{counter, 1ms};
+    sm::concurrent::BasicTokenBucket bucket(1000, 1s, 4, clock);
+
+    ASSERT_FALSE(bucket.tryAcquire(5));
+    ASSERT_TRUE(bucket.tryAcquire(3));
+    ASSERT_FALSE(bucket.tryAcquire(2));
+    ASSERT_TRUE(bucket.tryAcquire(1));
+
+    counter.advance(2);
+    ASSERT_TRUE(bucket.tryAcquire(2));
+    ASSERT_FALSE(bucket.tryAcquire(1));
+}
+
+TEST_F(LimitingFlagTest, TokenBucketConcurrent) {
+    std::atomic<int> activations = 0;
+
+    auto duration = std::chrono::milliseconds(500);
+    sm::concurrent::TokenBucket bucket(100, std::chrono::seconds(1), 20);
+
+    auto thread_count = std::clamp(std::thread::hardware_concurrency(), 2u, 8u);
+    auto end = std::chrono::high_resolution_clock::now() + duration;
+
+    {
+        std::vector<std::jthread> threads;
+        for (unsigned int i = 0; i < thread_count; i++) {
+            threads.emplace_back([&]() {
+                while (std::chrono::high_resolution_clock::now() < end) {
+                    if (bucket.isActive()) {
+                        activations++;
+                    }
+                }
+            });
+        }
+    }
+
+    // the initial burst plus the sustained rate over the duration
+    int ideal = 20 + 50;
+    EXPECT_GE(activations.load(), ideal * 0.8);
+    EXPECT_LE(activations.load(), ideal * 1.2);
+}
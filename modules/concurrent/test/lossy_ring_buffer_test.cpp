@@ -0,0 +1,294 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+
+#include <csignal>
+#include <cstddef>
+#include <latch>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include <simcoe/concurrent/lossy_ring_buffer.hpp>
+
+#if defined(__linux__)
+#    include <sys/mman.h>
+#    include <unistd.h>
+#endif
+
+namespace {
+struct Event {
+    uint32_t producer;
+    uint32_t sequence;
+    uint64_t payload[3];
+};
+} // namespace
+
+class LossyRingBufferTest : public testing::TestWithParam<uint32_t> {
+public:
+    sm::concurrent::LossyRingBuffer<Event> queue;
+
+    void SetUp() override {
+        auto result = sm::concurrent::LossyRingBuffer<Event>::create(GetParam());
+        ASSERT_TRUE(result.has_value());
+        queue = std::move(result.value());
+
+        ASSERT_EQ(queue.capacity(), GetParam());
+        ASSERT_EQ(queue.count(), 0);
+        ASSERT_EQ(queue.dropped(), 0);
+    }
+};
+
+TEST_P(LossyRingBufferTest, PushPop) {
+    for (uint32_t i = 0; i < queue.capacity(); i++) {
+        queue.push(Event{0, i, {i, i, i}});
+    }
+    ASSERT_EQ(queue.count(), queue.capacity());
+    ASSERT_EQ(queue.dropped(), 0);
+
+    for (uint32_t i = 0; i < queue.capacity(); i++) {
+        Event event{};
+        ASSERT_TRUE(queue.tryPop(event));
+        ASSERT_EQ(event.sequence, i);
+        ASSERT_EQ(event.payload[2], i);
+    }
+
+    Event event{};
+    ASSERT_FALSE(queue.tryPop(event));
+}
+
+TEST_P(LossyRingBufferTest, OverwriteOldest) {
+    const uint32_t total = queue.capacity() * 3 + 1;
+    for (uint32_t i = 0; i < total; i++) {
+        queue.push(Event{0, i, {}});
+    }
+
+    ASSERT_EQ(queue.dropped(), total - queue.capacity());
+    ASSERT_EQ(queue.count(), queue.capacity());
+
+    // The consumer sees the most recent window.
+    for (uint32_t i = total - queue.capacity(); i < total; i++) {
+        Event event{};
+        ASSERT_TRUE(queue.tryPop(event));
+        ASSERT_EQ(event.sequence, i);
+    }
+
+    Event event{};
+    ASSERT_FALSE(queue.tryPop(event));
+}
+
+TEST_P(LossyRingBufferTest, ConsumedIsNotDropped) {
+    for (uint32_t lap = 0; lap < 4; lap++) {
+        for (uint32_t i = 0; i < queue.capacity(); i++) {
+            queue.push(Event{0, i, {}});
+        }
+
+        size_t popped = queue.drain([](Event&) noexcept {});
+        ASSERT_EQ(popped, queue.capacity());
+    }
+
+    ASSERT_EQ(queue.dropped(), 0);
+}
+
+INSTANTIATE_TEST_SUITE_P(LossyRingBufferTests, LossyRingBufferTest, testing::Values(1, 2, 3, 64, 1000));
+
+namespace {
+struct NoDefault {
+    explicit NoDefault(uint32_t value) noexcept
+        : value(value) {}
+
+    uint32_t value;
+};
+
+static_assert(std::is_trivially_copyable_v<NoDefault> && !std::is_default_constructible_v<NoDefault>);
+} // namespace
+
+TEST(LossyRingBufferTest, DrainWithoutDefaultConstructor) {
+    auto queue = sm::concurrent::LossyRingBuffer<NoDefault>::create(4).value();
+    for (uint32_t i = 0; i < 6; i++) {
+        queue.push(NoDefault{i});
+    }
+
+    std::vector<uint32_t> values;
+    ASSERT_EQ(queue.drain([&](NoDefault& event) noexcept { values.push_back(event.value); }), 4);
+    ASSERT_EQ(values, (std::vector<uint32_t>{2, 3, 4, 5}));
+}
+
+TEST(LossyRingBufferConstructTest, Pow2) {
+    using Queue = sm::concurrent::LossyRingBuffer<int, std::allocator<int>, sm::concurrent::Pow2Capacity>;
+    ASSERT_FALSE(Queue::create(3).has_value());
+    ASSERT_TRUE(Queue::create(4).has_value());
+}
+
+#if defined(__linux__)
+namespace {
+sm::concurrent::LossyRingBuffer<int>* gSignalQueue = nullptr;
+
+void pushFromSignal(int) {
+    gSignalQueue->push(42);
+}
+} // namespace
+
+TEST(LossyRingBufferSignalTest, PushFromHandler) {
+    auto queue = sm::concurrent::LossyRingBuffer<int>::create(2).value();
+    gSignalQueue = &queue;
+
+    auto previous = std::signal(SIGUSR1, pushFromSignal);
+    queue.push(1);
+    queue.push(2);
+    std::raise(SIGUSR1);
+    std::signal(SIGUSR1, previous);
+
+    int value = 0;
+    ASSERT_TRUE(queue.tryPop(value));
+    ASSERT_EQ(value, 2);
+    ASSERT_TRUE(queue.tryPop(value));
+    ASSERT_EQ(value, 42);
+    ASSERT_EQ(queue.dropped(), 1);
+}
+
+namespace {
+// Larger than a page so that the second half of a slot can be protected on its own.
+struct LargeEvent {
+    uint32_t sequence;
+    std::byte payload[8192];
+};
+
+void* gLastAllocation = nullptr;
+
+template <typename T>
+struct PageAllocator {
+    using value_type = T;
+
+    constexpr PageAllocator() noexcept = default;
+
+    template <typename U>
+    constexpr PageAllocator(const PageAllocator<U>&) noexcept {}
+
+    T* allocate(size_t n) {
+        T* memory = static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t{size_t(sysconf(_SC_PAGESIZE))}));
+        gLastAllocation = memory;
+        return memory;
+    }
+
+    void deallocate(T* memory, size_t n) noexcept {
+        ::operator delete(memory, n * sizeof(T), std::align_val_t{size_t(sysconf(_SC_PAGESIZE))});
+    }
+
+    template <typename U>
+    constexpr bool operator==(const PageAllocator<U>&) const noexcept {
+        return true;
+    }
+};
+
+using StalledQueue = sm::concurrent::LossyRingBuffer<LargeEvent, PageAllocator<LargeEvent>>;
+
+StalledQueue* gStalledQueue = nullptr;
+void* gStalledPage = nullptr;
+
+void overtakeStalledPush(int) {
+    // The first push faulted part way through writing the first slot, lap it before it finishes.
+    for (uint32_t i = 1; i <= 6; i++) {
+        gStalledQueue->push(LargeEvent{i, {}});
+    }
+
+    mprotect(gStalledPage, size_t(sysconf(_SC_PAGESIZE)), PROT_READ | PROT_WRITE);
+}
+} // namespace
+
+TEST(LossyRingBufferSignalTest, DroppedWhileWriting) {
+    auto queue = StalledQueue::create(4).value();
+    gStalledQueue = &queue;
+
+    // The first slot starts at the allocation, its sequence is on the first page and its value runs into the second.
+    size_t page = size_t(sysconf(_SC_PAGESIZE));
+    gStalledPage = static_cast<std::byte*>(gLastAllocation) + page;
+    ASSERT_EQ(mprotect(gStalledPage, page, PROT_READ), 0);
+
+    struct sigaction action {};
+    struct sigaction previous {};
+    action.sa_handler = overtakeStalledPush;
+    sigemptyset(&action.sa_mask);
+    ASSERT_EQ(sigaction(SIGSEGV, &action, &previous), 0);
+
+    // Position 4 lands on the first slot while position 0 is still writing it, so its value is dropped.
+    queue.push(LargeEvent{0, {}});
+    sigaction(SIGSEGV, &previous, nullptr);
+
+    // Position 0 was overwritten, 1 and 2 were overwritten by 5 and 6, and 4 was dropped.
+    ASSERT_EQ(queue.dropped(), 4);
+
+    // The dropped position must not hide the values pushed after it.
+    for (uint32_t expected : {3, 5, 6}) {
+        LargeEvent event{};
+        ASSERT_TRUE(queue.tryPop(event)) << "Failed to pop " << expected;
+        ASSERT_EQ(event.sequence, expected);
+    }
+
+    LargeEvent event{};
+    ASSERT_FALSE(queue.tryPop(event));
+}
+#endif
+
+TEST(LossyRingBufferThreadTest, ManyProducers) {
+    static constexpr uint32_t kProducers = 4;
+    static constexpr uint32_t kMessagesPerProducer = 50000;
+
+    auto queue = sm::concurrent::LossyRingBuffer<Event>::create(64).value();
+
+    std::latch start(kProducers + 1);
+    std::atomic<uint32_t> finished{0};
+    std::vector<std::jthread> threads;
+    for (uint32_t p = 0; p < kProducers; p++) {
+        threads.emplace_back([&, p] {
+            start.arrive_and_wait();
+            for (uint32_t i = 0; i < kMessagesPerProducer; i++) {
+                queue.push(Event{p, i + 1, {p, i, uint64_t(p) ^ i}});
+            }
+            finished.fetch_add(1);
+        });
+    }
+
+    // values that survive must be intact and in order for each producer
+    std::vector<uint32_t> last(kProducers, 0);
+    uint64_t popped = 0;
+    bool corrupt = false;
+    bool outOfOrder = false;
+
+    auto visit = [&](const Event& event) {
+        if (event.producer >= kProducers || event.payload[0] != event.producer || event.payload[1] + 1 != event.sequence
+            || event.payload[2] != (uint64_t(event.producer) ^ event.payload[1])) {
+            corrupt = true;
+            return;
+        }
+
+        if (event.sequence <= last[event.producer]) {
+            outOfOrder = true;
+        }
+
+        last[event.producer] = event.sequence;
+        popped += 1;
+    };
+
+    start.arrive_and_wait();
+    while (finished.load() < kProducers) {
+        Event event{};
+        if (queue.tryPop(event)) {
+            visit(event);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+    threads.clear();
+
+    Event event{};
+    while (queue.tryPop(event)) {
+        visit(event);
+    }
+
+    ASSERT_FALSE(corrupt);
+    ASSERT_FALSE(outOfOrder);
+    ASSERT_EQ(popped + queue.dropped(), uint64_t(kProducers) * kMessagesPerProducer);
+}
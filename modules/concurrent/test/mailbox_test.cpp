@@ -2,16 +2,33 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <array>
+#include <chrono>
 #include <latch>
 #include <mutex>
 #include <simcoe/concurrent/mailbox.hpp>
 #include <thread>
+#include <vector>
 
 using namespace std::chrono_literals;
 
 class MailboxTest : public testing::Test {};
 
+TEST_F(MailboxTest, Layout) {
+    // The state, the coroutine waiter, and both slots.
+    static_assert(sizeof(sm::concurrent::AtomicMailbox<int>) == 2 * sizeof(void*) + 4 * sizeof(int));
+
+    using AlignedMailbox = sm::concurrent::AtomicMailbox<int, sm::concurrent::CacheAlignedLayout>;
+    static_assert(sizeof(AlignedMailbox) == 3 * sm::concurrent::kCacheLineSize);
+
+    AlignedMailbox mailbox;
+    mailbox.write(42);
+
+    std::lock_guard guard(mailbox);
+    ASSERT_EQ(mailbox.read(), 42);
+}
+
 TEST_F(MailboxTest, LargeData) {
     static constexpr size_t kArraySize = 0x10000;
     using BigArray = std::array<uint8_t, kArraySize>;
@@ -63,3 +80,200 @@ TEST_F(MailboxTest, LargeData) {
 
     SUCCEED() << "No assertions or torn reads";
 }
+
+TEST_F(MailboxTest, TripleBufferLatest) {
+    sm::concurrent::TripleBufferMailbox<int> mailbox;
+
+    {
+        std::lock_guard guard(mailbox);
+        ASSERT_EQ(mailbox.read(), 0);
+    }
+
+    mailbox.write(1);
+    mailbox.write(2);
+    mailbox.write(3);
+
+    std::lock_guard guard(mailbox);
+    ASSERT_EQ(mailbox.read(), 3);
+}
+
+TEST_F(MailboxTest, TripleBufferWriteWhileLocked) {
+    sm::concurrent::TripleBufferMailbox<int> mailbox;
+    mailbox.write(1);
+
+    mailbox.lock();
+    ASSERT_EQ(mailbox.read(), 1);
+
+    // the writer never waits for the reader, and the locked slot is left alone
+    for (int i = 2; i <= 100; i++) {
+        mailbox.write(i);
+        ASSERT_EQ(mailbox.read(), 1);
+    }
+
+    mailbox.unlock();
+
+    std::lock_guard guard(mailbox);
+    ASSERT_EQ(mailbox.read(), 100);
+}
+
+TEST_F(MailboxTest, TripleBufferLargeData) {
+    static constexpr size_t kArraySize = 0x10000;
+    using BigArray = std::array<uint8_t, kArraySize>;
+    using BigArrayMailbox = sm::concurrent::TripleBufferMailbox<BigArray>;
+
+    auto ptr = std::make_unique<BigArrayMailbox>();
+
+    // publish before the reader starts, the writer never waits so no latch is needed
+    auto initial = std::make_unique<BigArray>();
+    initial->fill(1);
+    ptr->write(*initial);
+
+    {
+        std::jthread reader = std::jthread([ptr = ptr.get()](const std::stop_token& stop) {
+            while (!stop.stop_requested()) {
+                std::lock_guard guard(*ptr);
+
+                const BigArray& data = ptr->read();
+                uint8_t first = data[0];
+                uint8_t last = data[kArraySize - 1];
+
+                ASSERT_NE(first, 0);
+                ASSERT_EQ(first, last);
+            }
+        });
+
+        std::jthread writer = std::jthread([ptr = ptr.get()](const std::stop_token& stop) {
+            uint8_t value = 1;
+            while (!stop.stop_requested()) {
+                BigArray data;
+                uint8_t next = value++;
+                if (next == 0) {
+                    value = 2;
+                    next = 1;
+                }
+
+                data.fill(next);
+
+                ptr->write(data);
+            }
+        });
+
+        std::this_thread::sleep_for(1s);
+    }
+
+    SUCCEED() << "No assertions or torn reads";
+}
+
+TEST_F(MailboxTest, BroadcastVersion) {
+    sm::concurrent::BroadcastMailbox<std::array<uint32_t, 5>> mailbox;
+    ASSERT_EQ(mailbox.version(), 0);
+
+    std::array<uint32_t, 5> value{};
+    ASSERT_EQ(mailbox.read(value), 0);
+
+    mailbox.write({1, 2, 3, 4, 5});
+    ASSERT_EQ(mailbox.version(), 1);
+
+    ASSERT_EQ(mailbox.read(value), 1);
+    ASSERT_EQ(value, (std::array<uint32_t, 5>{1, 2, 3, 4, 5}));
+
+    mailbox.write({6, 7, 8, 9, 10});
+    ASSERT_EQ(mailbox.version(), 2);
+}
+
+TEST_F(MailboxTest, BroadcastManyReaders) {
+    static constexpr size_t kReaderCount = 8;
+    using Snapshot = std::array<uint64_t, 32>;
+
+    sm::concurrent::BroadcastMailbox<Snapshot> mailbox;
+    std::atomic<size_t> mismatches = 0;
+
+    {
+        std::vector<std::jthread> readers;
+        for (size_t i = 0; i < kReaderCount; i++) {
+            readers.emplace_back([&](const std::stop_token& stop) {
+                uint64_t lastVersion = 0;
+                Snapshot snapshot{};
+                while (!stop.stop_requested()) {
+                    if (mailbox.version() == lastVersion) {
+                        continue;
+                    }
+
+                    uint64_t version = mailbox.read(snapshot);
+                    if (version < lastVersion) {
+                        mismatches += 1;
+                    }
+                    lastVersion = version;
+
+                    for (uint64_t element : snapshot) {
+                        if (element != snapshot[0]) {
+                            mismatches += 1;
+                        }
+                    }
+                }
+            });
+        }
+
+        std::jthread writer = std::jthread([&](const std::stop_token& stop) {
+            Snapshot snapshot{};
+            while (!stop.stop_requested()) {
+                snapshot.fill(snapshot[0] + 1);
+                mailbox.write(snapshot);
+            }
+        });
+
+        std::this_thread::sleep_for(1s);
+    }
+
+    ASSERT_EQ(mismatches.load(), 0) << "Torn or out of order reads";
+}
+
+template <typename Mailbox>
+class MailboxInPlaceTest : public testing::Test {};
+
+using InPlaceMailboxes = testing::Types<sm::concurrent::AtomicMailbox<std::vector<int>>, sm::concurrent::TripleBufferMailbox<std::vector<int>>>;
+TYPED_TEST_SUITE(MailboxInPlaceTest, InPlaceMailboxes);
+
+TYPED_TEST(MailboxInPlaceTest, ReusesSlots) {
+    TypeParam mailbox;
+
+    // fill every slot once, after that every slot should already own a large enough buffer
+    for (int i = 0; i < 3; i++) {
+        mailbox.writeInPlace([&](std::vector<int>& frame) noexcept {
+            frame.reserve(1024);
+            frame.assign(16, i);
+        });
+
+        std::lock_guard guard(mailbox);
+        ASSERT_EQ(mailbox.read(), std::vector<int>(16, i));
+    }
+
+    for (int i = 3; i < 10; i++) {
+        std::vector<int>& frame = mailbox.beginWrite();
+        ASSERT_GE(frame.capacity(), 1024) << "Slot was not reused at write " << i;
+        std::fill(frame.begin(), frame.end(), i);
+        mailbox.commit();
+
+        std::lock_guard guard(mailbox);
+        ASSERT_EQ(mailbox.read(), std::vector<int>(16, i));
+    }
+}
+
+TEST_F(MailboxTest, WriterSpinStats) {
+    using Counter = sm::concurrent::MailboxCounter;
+    sm::concurrent::AtomicMailbox<int, sm::concurrent::CompactLayout, sm::concurrent::AtomicStats> mailbox;
+
+    // the second write waits until the reader releases the first
+    mailbox.write(1);
+    std::jthread writer([&] { mailbox.write(2); });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    {
+        std::lock_guard guard(mailbox);
+        ASSERT_EQ(mailbox.read(), 1);
+    }
+
+    writer.join();
+    ASSERT_GT(mailbox.stats()[Counter::eWriterSpins], 0);
+    ASSERT_EQ(sm::concurrent::AtomicMailbox<int>{}.stats()[Counter::eWriterSpins], 0);
+}
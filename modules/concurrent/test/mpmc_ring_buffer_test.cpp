@@ -0,0 +1,145 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <latch>
+#include <string>
+#include <thread>
+#include <vector>
+
+// strings move assignment isnt nonblocking so clang rightly complains
+#if defined(__clang__)
+#    pragma clang diagnostic push
+#    pragma clang diagnostic ignored "-Wfunction-effects"
+#endif
+
+#include <simcoe/concurrent/mpmc_ring_buffer.hpp>
+
+#if defined(__clang__)
+#    pragma clang diagnostic pop
+#endif
+
+class MpmcRingBufferTest : public testing::TestWithParam<uint32_t> {
+public:
+    sm::concurrent::MpmcRingBuffer<std::string> queue;
+
+    void SetUp() override {
+        auto result = sm::concurrent::MpmcRingBuffer<std::string>::create(GetParam());
+        ASSERT_TRUE(result.has_value());
+        queue = std::move(result.value());
+
+        ASSERT_EQ(queue.capacity(), GetParam());
+        ASSERT_EQ(queue.count(), 0);
+    }
+};
+
+TEST_P(MpmcRingBufferTest, PushFull) {
+    for (size_t i = 0; i < queue.capacity(); i++) {
+        std::string value = "Hello, World!";
+        ASSERT_TRUE(queue.tryPush(value)) << "Failed to push at index " << i;
+    }
+    ASSERT_EQ(queue.count(), queue.capacity());
+
+    std::string value = "This should not be pushed";
+    ASSERT_FALSE(queue.tryPush(value));
+    ASSERT_EQ(value, "This should not be pushed");
+}
+
+TEST_P(MpmcRingBufferTest, PopEmpty) {
+    std::string value = "unchanged";
+    ASSERT_FALSE(queue.tryPop(value));
+    ASSERT_EQ(value, "unchanged");
+}
+
+TEST_P(MpmcRingBufferTest, OrderAcrossLaps) {
+    size_t next = 0;
+    size_t expected = 0;
+    for (size_t lap = 0; lap < 4; lap++) {
+        for (size_t i = 0; i < queue.capacity(); i++) {
+            ASSERT_TRUE(queue.tryEmplace(std::to_string(next++)));
+        }
+
+        for (size_t i = 0; i < queue.capacity(); i++) {
+            std::string value;
+            ASSERT_TRUE(queue.tryPop(value));
+            ASSERT_EQ(value, std::to_string(expected++));
+        }
+    }
+
+    ASSERT_EQ(queue.count(), 0);
+}
+
+TEST_P(MpmcRingBufferTest, DestroyWithElements) {
+    for (size_t i = 0; i < queue.capacity(); i++) {
+        ASSERT_TRUE(queue.tryEmplace(std::to_string(i)));
+    }
+
+    SUCCEED() << "Remaining elements are destroyed with the queue";
+}
+
+INSTANTIATE_TEST_SUITE_P(MpmcRingBufferTests, MpmcRingBufferTest, testing::Values(1, 2, 3, 64, 1000));
+
+TEST(MpmcRingBufferConstructTest, Pow2) {
+    using Queue = sm::concurrent::MpmcRingBuffer<int, std::allocator<int>, sm::concurrent::Pow2Capacity>;
+    ASSERT_FALSE(Queue::create(3).has_value());
+    ASSERT_TRUE(Queue::create(4).has_value());
+}
+
+TEST(MpmcRingBufferThreadTest, ManyProducersManyConsumers) {
+    static constexpr size_t kProducers = 4;
+    static constexpr size_t kConsumers = 4;
+    static constexpr size_t kMessagesPerProducer = 20000;
+
+    auto queue = sm::concurrent::MpmcRingBuffer<size_t>::create(64).value();
+
+    std::latch start(kProducers + kConsumers);
+    std::atomic<size_t> consumed{0};
+    std::vector<std::atomic<uint32_t>> seen(kProducers * kMessagesPerProducer);
+    std::atomic<bool> outOfOrder{false};
+
+    std::vector<std::jthread> threads;
+    for (size_t p = 0; p < kProducers; p++) {
+        threads.emplace_back([&, p] {
+            start.arrive_and_wait();
+            for (size_t i = 0; i < kMessagesPerProducer; i++) {
+                size_t value = p * kMessagesPerProducer + i;
+                while (!queue.tryPush(value)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    for (size_t c = 0; c < kConsumers; c++) {
+        threads.emplace_back([&] {
+            // each consumer must see the messages of a single producer in order
+            std::vector<size_t> last(kProducers, 0);
+            start.arrive_and_wait();
+            while (consumed.load() < kProducers * kMessagesPerProducer) {
+                size_t value = 0;
+                if (!queue.tryPop(value)) {
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                size_t producer = value / kMessagesPerProducer;
+                size_t index = value % kMessagesPerProducer + 1;
+                if (index <= last[producer]) {
+                    outOfOrder = true;
+                }
+
+                last[producer] = index;
+                seen[value].fetch_add(1);
+                consumed.fetch_add(1);
+            }
+        });
+    }
+
+    threads.clear();
+
+    ASSERT_FALSE(outOfOrder.load());
+    for (size_t i = 0; i < seen.size(); i++) {
+        ASSERT_EQ(seen[i].load(), 1) << "Message " << i << " was not consumed exactly once";
+    }
+}
@@ -0,0 +1,71 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <simcoe/concurrent/page_allocator.hpp>
+#include <simcoe/concurrent/ring_buffer.hpp>
+#include <type_traits>
+
+// Options must be passed explicitly, a bool or node index never converts to an allocator.
+static_assert(!std::is_convertible_v<bool, sm::concurrent::HugePageAllocator<int>>);
+static_assert(!std::is_convertible_v<int, sm::concurrent::NumaAllocator<int>>);
+static_assert(std::is_nothrow_default_constructible_v<sm::concurrent::HugePageAllocator<int>>);
+static_assert(std::is_nothrow_default_constructible_v<sm::concurrent::NumaAllocator<int>>);
+
+TEST(PageAllocatorTest, AllocatePages) {
+    for (bool hugePages : {false, true}) {
+        sm::concurrent::PageOptions options{.hugePages = hugePages, .prefault = true};
+        constexpr size_t kSize = 3 * 0x1000 + 1;
+
+        auto* memory = static_cast<uint8_t*>(sm::concurrent::allocatePages(kSize, options));
+        ASSERT_NE(memory, nullptr);
+        ASSERT_EQ(reinterpret_cast<uintptr_t>(memory) % 0x1000, 0);
+
+        for (size_t i = 0; i < kSize; i++) {
+            ASSERT_EQ(memory[i], 0);
+            memory[i] = static_cast<uint8_t>(i);
+        }
+
+        sm::concurrent::freePages(memory, kSize, options);
+    }
+
+    ASSERT_EQ(sm::concurrent::allocatePages(0, {}), nullptr);
+}
+
+TEST(PageAllocatorTest, CurrentNode) {
+    ASSERT_GE(sm::concurrent::currentNumaNode(), 0);
+}
+
+TEST(PageAllocatorTest, Rebind) {
+    sm::concurrent::HugePageAllocator<int> allocator{true};
+    sm::concurrent::HugePageAllocator<double> rebound{allocator};
+    ASSERT_TRUE(rebound.options().prefault);
+    ASSERT_TRUE(allocator == rebound);
+
+    sm::concurrent::NumaAllocator<int> numa{0};
+    sm::concurrent::NumaAllocator<double> numaRebound{numa};
+    ASSERT_EQ(numaRebound.options().node, 0);
+    ASSERT_FALSE(numa == sm::concurrent::NumaAllocator<int>{});
+}
+
+template <typename Allocator>
+class PageAllocatorQueueTest : public testing::Test {};
+
+using PageAllocators = testing::Types<sm::concurrent::HugePageAllocator<size_t>, sm::concurrent::NumaAllocator<size_t>>;
+TYPED_TEST_SUITE(PageAllocatorQueueTest, PageAllocators);
+
+TYPED_TEST(PageAllocatorQueueTest, RingBufferStorage) {
+    using Queue = sm::concurrent::RingBuffer<size_t, TypeParam>;
+    Queue queue = Queue::create(1 << 16).value();
+
+    for (size_t i = 0; i < queue.capacity(); i++) {
+        ASSERT_TRUE(queue.tryPush(i));
+    }
+
+    for (size_t i = 0; i < queue.capacity(); i++) {
+        size_t value = 0;
+        ASSERT_TRUE(queue.tryPop(value));
+        ASSERT_EQ(value, i);
+    }
+}
@@ -1,9 +1,17 @@
 #include <gtest/gtest.h>
 
 #include <algorithm>
+#include <csignal>
+#include <cstring>
 #include <latch>
 #include <thread>
 
+#if defined(__linux__)
+#    include <sys/mman.h>
+#    include <sys/wait.h>
+#    include <unistd.h>
+#endif
+
 // strings move assignment isnt nonblocking so clang rightly complains
 // this is fine for tests, but in real code only nonblocking move assignable types
 // should be allowed in the ring buffer
@@ -18,6 +26,8 @@
 #    pragma clang diagnostic pop
 #endif
 
+#include <simcoe/functional/inplace_function.hpp>
+
 template <typename T>
 class TestAllocator {
     std::allocator<T> mInnerAllocator;
@@ -73,20 +83,76 @@ TEST_F(RingBufferConstructTest, ConstructFail) {
     ASSERT_EQ(result.has_value(), false);
 }
 
+template <typename T>
+using Pow2RingBuffer = sm::concurrent::RingBuffer<T, std::allocator<T>, sm::concurrent::Pow2Capacity>;
+
+TEST_F(RingBufferConstructTest, ConstructPow2) {
+    auto queue = Pow2RingBuffer<int>::create(1024);
+    ASSERT_TRUE(queue.has_value());
+    ASSERT_EQ(queue->capacity(), 1024);
+}
+
+TEST_F(RingBufferConstructTest, ConstructPow2Invalid) {
+    ASSERT_FALSE(Pow2RingBuffer<int>::create(0).has_value());
+    ASSERT_FALSE(Pow2RingBuffer<int>::create(1000).has_value());
+}
+
+TEST(RingBufferPow2Test, OrderAcrossLaps) {
+    Pow2RingBuffer<size_t> queue = Pow2RingBuffer<size_t>::create(8).value();
+
+    size_t next = 0;
+    size_t expected = 0;
+    for (size_t lap = 0; lap < 16; lap++) {
+        for (size_t i = 0; i < 5; i++) {
+            size_t value = next++;
+            ASSERT_TRUE(queue.tryPush(value));
+        }
+
+        for (size_t i = 0; i < 5; i++) {
+            size_t value;
+            ASSERT_TRUE(queue.tryPop(value));
+            ASSERT_EQ(value, expected++);
+        }
+    }
+
+    ASSERT_EQ(queue.count(), 0);
+}
+
+TEST_F(RingBufferConstructTest, CacheAlignedLayout) {
+    using AlignedRingBuffer = sm::concurrent::RingBuffer<int, std::allocator<int>, sm::concurrent::DynamicCapacity, sm::concurrent::CacheAlignedLayout>;
+    static_assert(alignof(AlignedRingBuffer) == sm::concurrent::kCacheLineSize);
+    static_assert(sizeof(AlignedRingBuffer) == 4 * sm::concurrent::kCacheLineSize);
+
+    AlignedRingBuffer queue = AlignedRingBuffer::create(16).value();
+    int value = 42;
+    ASSERT_TRUE(queue.tryPush(value));
+    ASSERT_TRUE(queue.tryPop(value));
+    ASSERT_EQ(value, 42);
+}
+
 class RingBufferDetailsTest : public testing::TestWithParam<size_t> {
 public:
     std::unique_ptr<std::atomic<uint64_t>[]> bitset;
+    std::unique_ptr<std::atomic<uint64_t>[]> summary;
 
     void SetUp() override {
         size_t size = getSize();
         bitset = std::make_unique<std::atomic<uint64_t>[]>(size);
         std::uninitialized_fill_n(bitset.get(), size, 0);
+
+        size_t summarySize = sm::concurrent::detail::requiredSummarySize(getCapacity());
+        summary = std::make_unique<std::atomic<uint64_t>[]>(summarySize);
+        std::uninitialized_fill_n(summary.get(), summarySize, 0);
     }
 
     size_t getSize() const {
         return sm::concurrent::detail::requiredBitsetSize(getCapacity());
     }
 
+    std::atomic<uint64_t>* getSummary() const {
+        return (sm::concurrent::detail::requiredSummarySize(getCapacity()) == 0) ? nullptr : summary.get();
+    }
+
     size_t getCapacity() const {
         return GetParam();
     }
@@ -111,6 +177,73 @@ TEST_P(RingBufferDetailsTest, AtomicScanAndSet) {
     ASSERT_EQ(index, (std::numeric_limits<size_t>::max)()) << "Allocated index when full";
 }
 
+TEST_P(RingBufferDetailsTest, AtomicScanAndSetHinted) {
+    std::vector<bool> allocated;
+    allocated.resize(getCapacity(), false);
+
+    for (size_t i = 0; i < getCapacity(); i++) {
+        size_t index = sm::concurrent::detail::atomicScanAndSet(bitset.get(), getSummary(), getCapacity(), i * 7);
+        ASSERT_NE(index, (std::numeric_limits<size_t>::max)()) << "Failed to allocate at iteration " << i;
+
+        ASSERT_FALSE(allocated[index]) << "Allocated index " << index << " twice";
+        allocated[index] = true;
+    }
+
+    size_t index = sm::concurrent::detail::atomicScanAndSet(bitset.get(), getSummary(), getCapacity(), 0);
+    ASSERT_EQ(index, (std::numeric_limits<size_t>::max)()) << "Allocated index when full";
+
+    // releasing a bit from a full word must make it visible to every hint again
+    size_t released = getCapacity() / 2;
+    sm::concurrent::detail::atomicClearBit(bitset.get(), getSummary(), getCapacity(), released);
+
+    for (size_t hint = 0; hint < 3; hint++) {
+        index = sm::concurrent::detail::atomicScanAndSet(bitset.get(), getSummary(), getCapacity(), hint);
+        ASSERT_EQ(index, released);
+        sm::concurrent::detail::atomicClearBit(bitset.get(), getSummary(), getCapacity(), released);
+    }
+}
+
+TEST_P(RingBufferDetailsTest, AtomicScanAndSetStaleSummary) {
+    auto summary = getSummary();
+    if (summary == nullptr) {
+        GTEST_SKIP() << "Capacity has no summary";
+    }
+
+    // a summary that claims every word is full must not cause allocation to fail
+    for (size_t i = 0; i < sm::concurrent::detail::requiredSummarySize(getCapacity()); i++) {
+        summary[i].store(~uint64_t{0});
+    }
+
+    size_t index = sm::concurrent::detail::atomicScanAndSet(bitset.get(), summary, getCapacity(), 0);
+    ASSERT_NE(index, (std::numeric_limits<size_t>::max)());
+}
+
+TEST_P(RingBufferDetailsTest, AtomicScanAndSetMany) {
+    std::vector<bool> allocated;
+    allocated.resize(getCapacity(), false);
+
+    std::vector<size_t> indices;
+    indices.resize(7);
+
+    size_t total = 0;
+    while (total < getCapacity()) {
+        size_t claimed = sm::concurrent::detail::atomicScanAndSetMany(bitset.get(), getCapacity(), indices.data(), indices.size());
+        ASSERT_NE(claimed, 0) << "Failed to allocate after " << total << " bits";
+        ASSERT_EQ(claimed, (std::min)(indices.size(), getCapacity() - total));
+
+        for (size_t i = 0; i < claimed; i++) {
+            ASSERT_LT(indices[i], getCapacity());
+            ASSERT_FALSE(allocated[indices[i]]) << "Allocated index " << indices[i] << " twice";
+            allocated[indices[i]] = true;
+        }
+
+        total += claimed;
+    }
+
+    size_t claimed = sm::concurrent::detail::atomicScanAndSetMany(bitset.get(), getCapacity(), indices.data(), indices.size());
+    ASSERT_EQ(claimed, 0) << "Allocated index when full";
+}
+
 INSTANTIATE_TEST_SUITE_P(RingBufferDetailsTests, RingBufferDetailsTest, testing::Values(1, 2, 4, 8, 16, 32, 64, 65, 128, 256, 512, 1024));
 
 class RingBufferSizedTest : public testing::TestWithParam<size_t> {
@@ -188,6 +321,124 @@ TEST_P(RingBufferSizedTest, PopEmpty) {
     ASSERT_EQ(queue.count(), 0);
 }
 
+TEST_P(RingBufferSizedTest, PushNFull) {
+    std::vector<std::string> values;
+    for (size_t i = 0; i < queue.capacity() + 3; i++) {
+        values.push_back("Hello, World! " + std::to_string(i));
+    }
+
+    ASSERT_EQ(queue.tryPushN(values), queue.capacity());
+    ASSERT_EQ(queue.count(), queue.capacity());
+
+    // values that did not fit are left untouched
+    for (size_t i = queue.capacity(); i < values.size(); i++) {
+        ASSERT_EQ(values[i], "Hello, World! " + std::to_string(i));
+    }
+
+    ASSERT_EQ(queue.tryPushN(values), 0);
+}
+
+TEST_P(RingBufferSizedTest, PopNInOrder) {
+    std::vector<std::string> values;
+    for (size_t i = 0; i < queue.capacity(); i++) {
+        values.push_back("Hello, World! " + std::to_string(i));
+    }
+
+    ASSERT_EQ(queue.tryPushN(values), queue.capacity());
+
+    std::vector<std::string> popped;
+    popped.resize(queue.capacity() + 1);
+    ASSERT_EQ(queue.tryPopN(popped), queue.capacity());
+    ASSERT_EQ(queue.count(), 0);
+
+    for (size_t i = 0; i < queue.capacity(); i++) {
+        ASSERT_EQ(popped[i], "Hello, World! " + std::to_string(i)) << "Unexpected value at index " << i;
+    }
+
+    ASSERT_EQ(queue.tryPopN(popped), 0);
+}
+
+TEST_P(RingBufferSizedTest, DrainLimit) {
+    for (size_t i = 0; i < queue.capacity(); i++) {
+        std::string value = std::to_string(i);
+        ASSERT_TRUE(queue.tryPush(value));
+    }
+
+    size_t limit = (queue.capacity() + 1) / 2;
+    size_t next = 0;
+    auto visitor = [&](std::string& value) noexcept {
+        EXPECT_EQ(value, std::to_string(next));
+        next += 1;
+    };
+
+    ASSERT_EQ(queue.drain(visitor, limit), limit);
+    ASSERT_EQ(queue.count(), queue.capacity() - limit);
+
+    // the freed slots are reusable once drained
+    for (size_t i = 0; i < limit; i++) {
+        std::string value = std::to_string(queue.capacity() + i);
+        ASSERT_TRUE(queue.tryPush(value)) << "Failed to push at index " << i;
+    }
+
+    ASSERT_EQ(queue.drain(visitor), queue.capacity());
+    ASSERT_EQ(next, queue.capacity() + limit);
+    ASSERT_EQ(queue.count(), 0);
+}
+
+TEST_P(RingBufferSizedTest, EmplaceConsumeInOrder) {
+    for (size_t i = 0; i < queue.capacity(); i++) {
+        ASSERT_TRUE(queue.tryEmplace(std::to_string(i))) << "Failed to emplace at index " << i;
+    }
+    ASSERT_EQ(queue.count(), queue.capacity());
+
+    std::string value = "This should not be pushed";
+    ASSERT_FALSE(queue.tryEmplace(std::move(value)));
+    ASSERT_EQ(value, "This should not be pushed");
+
+    for (size_t i = 0; i < queue.capacity(); i++) {
+        bool consumed = queue.tryConsume([&](std::string& value) noexcept {
+            EXPECT_EQ(value, std::to_string(i));
+        });
+        ASSERT_TRUE(consumed) << "Failed to consume at index " << i;
+    }
+
+    ASSERT_EQ(queue.count(), 0);
+    ASSERT_FALSE(queue.tryConsume([](std::string&) noexcept { FAIL() << "Consumed from an empty queue"; }));
+}
+
+TEST_P(RingBufferSizedTest, ResetReuse) {
+    size_t capacity = GetParam();
+    for (size_t round = 0; round < 3; round++) {
+        // leave the head and tail at a different position each round
+        for (size_t i = 0; i < capacity; i++) {
+            std::string value = std::to_string(i);
+            ASSERT_TRUE(queue.tryPush(value));
+        }
+
+        for (size_t i = 0; i < (std::min)(round, capacity); i++) {
+            std::string value;
+            ASSERT_TRUE(queue.tryPop(value));
+        }
+
+        queue.reset();
+        ASSERT_EQ(queue.count(), 0);
+
+        for (size_t i = 0; i < capacity; i++) {
+            std::string value = std::to_string(i * 3);
+            ASSERT_TRUE(queue.tryPush(value));
+        }
+
+        std::string overflow = "overflow";
+        ASSERT_FALSE(queue.tryPush(overflow));
+
+        for (size_t i = 0; i < capacity; i++) {
+            std::string value;
+            ASSERT_TRUE(queue.tryPop(value));
+            ASSERT_EQ(value, std::to_string(i * 3));
+        }
+    }
+}
+
 INSTANTIATE_TEST_SUITE_P(RingBufferTests, RingBufferSizedTest, testing::Values(1, 2, 4, 8, 16, 32, 64, 128, 256, 512, 1024));
 
 template <typename T, size_t N>
@@ -317,6 +568,239 @@ TEST_F(RingBufferThreadTest, ThreadSafe) {
     ASSERT_EQ(consumedCount.load(), producedCount.load());
 }
 
+TEST_F(RingBufferThreadTest, ThreadSafeBatch) {
+    static constexpr size_t kBatchSize = 10;
+
+    std::vector<std::jthread> producers;
+    std::latch latch{kProducerCount + 1};
+
+    std::atomic<size_t> producedCount = 0;
+    std::atomic<size_t> consumedCount = 0;
+
+    for (size_t i = 0; i < kProducerCount; ++i) {
+        producers.emplace_back([&] {
+            latch.arrive_and_wait();
+
+            for (size_t j = 0; j < 100; ++j) {
+                std::array<Element, kBatchSize> values;
+                for (Element& value : values) {
+                    value = nextValue.fetch_add(1);
+                }
+
+                size_t pushed = queue.tryPushN(values);
+                producedCount += pushed;
+                for (size_t k = 0; k < pushed; k++) {
+                    recordProduced(values[k]);
+                }
+            }
+        });
+    }
+
+    auto visitor = [&](Element& value) noexcept {
+        consumedCount += 1;
+        recordConsumed(value);
+    };
+
+    {
+        std::jthread consumer([&](std::stop_token stop) {
+            latch.arrive_and_wait();
+
+            while (!stop.stop_requested()) {
+                (void)queue.drain(visitor, 64);
+            }
+        });
+
+        producers.clear();
+    }
+
+    (void)queue.drain(visitor);
+
+    messageValues.assertEqual();
+
+    ASSERT_NE(producedCount.load(), 0);
+    ASSERT_EQ(consumedCount.load(), producedCount.load());
+    ASSERT_EQ(queue.count(), 0);
+}
+
+TEST_F(RingBufferThreadTest, BlockingPop) {
+    static constexpr size_t kMessageCount = 1000;
+
+    std::vector<std::jthread> producers;
+    std::atomic<size_t> producedCount = 0;
+
+    for (size_t i = 0; i < kProducerCount; ++i) {
+        producers.emplace_back([&] {
+            for (size_t j = 0; j < kMessageCount / kProducerCount; ++j) {
+                Element value = nextValue.fetch_add(1);
+                while (!queue.tryPush(value)) {
+                    std::this_thread::yield();
+                }
+
+                recordProduced(value);
+                producedCount += 1;
+
+                // give the consumer time to park
+                if (j % 16 == 0) {
+                    std::this_thread::sleep_for(std::chrono::microseconds(100));
+                }
+            }
+        });
+    }
+
+    for (size_t i = 0; i < kMessageCount; i++) {
+        Element value;
+        queue.pop(value);
+        recordConsumed(value);
+    }
+
+    producers.clear();
+
+    messageValues.assertEqual();
+    ASSERT_EQ(queue.count(), 0);
+}
+
+/**
+ * @brief A payload that can be neither moved nor copied, and counts how often it is constructed.
+ */
+struct PinnedEvent {
+    static inline int gConstructed = 0;
+    static inline int gDestroyed = 0;
+
+    uint64_t id;
+    std::byte payload[248];
+
+    PinnedEvent(uint64_t id) noexcept
+        : id(id) {
+        gConstructed += 1;
+    }
+
+    ~PinnedEvent() noexcept {
+        gDestroyed += 1;
+    }
+
+    PinnedEvent(const PinnedEvent&) = delete;
+    PinnedEvent& operator=(const PinnedEvent&) = delete;
+};
+
+TEST(RingBufferInPlaceTest, PinnedPayload) {
+    PinnedEvent::gConstructed = 0;
+    PinnedEvent::gDestroyed = 0;
+
+    {
+        auto queue = sm::concurrent::RingBuffer<PinnedEvent>::create(64).value();
+        for (uint64_t i = 0; i < 64; i++) {
+            ASSERT_TRUE(queue.tryEmplace(i));
+        }
+
+        for (uint64_t i = 0; i < 32; i++) {
+            ASSERT_TRUE(queue.tryConsume([&](PinnedEvent& event) noexcept { EXPECT_EQ(event.id, i); }));
+        }
+
+        ASSERT_EQ(PinnedEvent::gConstructed, 64);
+        ASSERT_EQ(PinnedEvent::gDestroyed, 32);
+    }
+
+    // the remaining values are destroyed with the queue
+    ASSERT_EQ(PinnedEvent::gDestroyed, 64);
+}
+
+TEST(RingBufferInPlaceTest, DestroyPartialWord) {
+    PinnedEvent::gConstructed = 0;
+    PinnedEvent::gDestroyed = 0;
+
+    {
+        // the last word of the bitset is only partially used
+        auto queue = sm::concurrent::RingBuffer<PinnedEvent>::create(100).value();
+        for (uint64_t i = 0; i < 100; i++) {
+            ASSERT_TRUE(queue.tryEmplace(i));
+        }
+    }
+
+    ASSERT_EQ(PinnedEvent::gDestroyed, 100);
+}
+
+TEST(RingBufferResetTest, DestroysElements) {
+    PinnedEvent::gConstructed = 0;
+    PinnedEvent::gDestroyed = 0;
+
+    auto queue = sm::concurrent::RingBuffer<PinnedEvent>::create(100).value();
+    for (int round = 0; round < 3; round++) {
+        for (uint64_t i = 0; i < 70; i++) {
+            ASSERT_TRUE(queue.tryEmplace(i));
+        }
+
+        for (uint64_t i = 0; i < 10; i++) {
+            ASSERT_TRUE(queue.tryConsume([](PinnedEvent&) noexcept {}));
+        }
+
+        queue.reset();
+        ASSERT_EQ(queue.count(), 0);
+        ASSERT_EQ(PinnedEvent::gDestroyed, PinnedEvent::gConstructed);
+        ASSERT_FALSE(queue.tryConsume([](PinnedEvent&) noexcept {}));
+    }
+}
+
+TEST(RingBufferFunctionTest, InplaceFunctionElements) {
+    using Callback = sm::functional::InplaceFunction<int() noexcept>;
+
+    auto queue = sm::concurrent::RingBuffer<Callback>::create(16).value();
+    for (int i = 0; i < 16; i++) {
+        Callback callback = [i]() noexcept { return i * 2; };
+        ASSERT_TRUE(queue.tryPush(callback));
+        ASSERT_FALSE(callback);
+    }
+
+    for (int i = 0; i < 16; i++) {
+        Callback callback;
+        ASSERT_TRUE(queue.tryPop(callback));
+        ASSERT_EQ(callback(), i * 2);
+    }
+}
+
+TEST(RingBufferBlockingTest, PopWaitsForPush) {
+    auto queue = sm::concurrent::RingBuffer<size_t>::create(16).value();
+
+    std::jthread producer([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        size_t value = 42;
+        ASSERT_TRUE(queue.tryPush(value));
+    });
+
+    size_t value = 0;
+    queue.pop(value);
+    ASSERT_EQ(value, 42);
+}
+
+TEST(RingBufferBlockingTest, PopForTimeout) {
+    auto queue = sm::concurrent::RingBuffer<size_t>::create(16).value();
+
+    auto timeout = std::chrono::milliseconds(50);
+    auto start = std::chrono::steady_clock::now();
+
+    size_t value = 0;
+    ASSERT_FALSE(queue.popFor(value, timeout));
+    ASSERT_GE(std::chrono::steady_clock::now() - start, timeout);
+
+    value = 42;
+    ASSERT_TRUE(queue.tryPush(value));
+    ASSERT_TRUE(queue.popFor(value, timeout));
+    ASSERT_EQ(value, 42);
+}
+
+TEST(RingBufferBlockingTest, PopUntilWoken) {
+    auto queue = sm::concurrent::RingBuffer<size_t>::create(16).value();
+
+    std::jthread producer([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        size_t value = 42;
+        ASSERT_TRUE(queue.tryPush(value));
+    });
+
+    size_t value = 0;
+    ASSERT_TRUE(queue.popUntil(value, std::chrono::system_clock::now() + std::chrono::seconds(10)));
+    ASSERT_EQ(value, 42);
+}
+
 TEST(RingBufferOrderTest, Order) {
     TestRingBuffer<size_t> queue = TestRingBuffer<size_t>::create(64).value();
 
@@ -332,3 +816,209 @@ TEST(RingBufferOrderTest, Order) {
         ASSERT_EQ(value, i * 10) << "Value at index " << i << " is incorrect";
     }
 }
+
+TEST(RingBufferStatsTest, NoStatsIsFree) {
+    using Counter = sm::concurrent::RingBufferCounter;
+    using StatsQueue = sm::concurrent::RingBuffer<size_t, std::allocator<size_t>, sm::concurrent::DynamicCapacity, sm::concurrent::CompactLayout, sm::concurrent::NoStats>;
+    static_assert(sizeof(StatsQueue) == sizeof(sm::concurrent::RingBuffer<size_t>));
+
+    StatsQueue queue = StatsQueue::create(1).value();
+    size_t value = 0;
+    ASSERT_TRUE(queue.tryPush(value));
+    ASSERT_FALSE(queue.tryPush(value));
+    ASSERT_EQ(queue.stats()[Counter::eCountRollback], 0);
+}
+
+TEST(RingBufferStatsTest, Counters) {
+    using Counter = sm::concurrent::RingBufferCounter;
+    using StatsQueue = sm::concurrent::RingBuffer<size_t, std::allocator<size_t>, sm::concurrent::DynamicCapacity, sm::concurrent::CompactLayout, sm::concurrent::AtomicStats>;
+
+    StatsQueue queue = StatsQueue::create(4).value();
+    for (size_t i = 0; i < 4; i++) {
+        ASSERT_TRUE(queue.tryPush(i));
+    }
+
+    size_t value = 0;
+    ASSERT_FALSE(queue.tryPush(value));
+    ASSERT_EQ(queue.tryPushN(std::span(&value, 1)), 0);
+
+    for (size_t i = 0; i < 4; i++) {
+        ASSERT_TRUE(queue.tryPop(value));
+    }
+
+    ASSERT_FALSE(queue.tryPop(value));
+
+    auto stats = queue.stats();
+    ASSERT_EQ(stats[Counter::eCountRollback], 2);
+    ASSERT_EQ(stats[Counter::eBitmapFull], 0);
+    ASSERT_EQ(stats[Counter::eScanRetries], 0);
+    ASSERT_EQ(stats[Counter::eHighWater], 4);
+    ASSERT_EQ(stats[Counter::ePopEmpty], 1);
+}
+
+TEST(RingBufferStatsTest, ThreadSafe) {
+    using Counter = sm::concurrent::RingBufferCounter;
+    using StatsQueue = sm::concurrent::RingBuffer<size_t, std::allocator<size_t>, sm::concurrent::DynamicCapacity, sm::concurrent::CompactLayout, sm::concurrent::AtomicStats>;
+
+    constexpr size_t kThreads = 4;
+    constexpr size_t kPushes = 1000;
+
+    StatsQueue queue = StatsQueue::create(128).value();
+    std::latch start(kThreads);
+    std::vector<std::jthread> producers;
+    for (size_t t = 0; t < kThreads; t++) {
+        producers.emplace_back([&] {
+            start.arrive_and_wait();
+            for (size_t i = 0; i < kPushes; i++) {
+                size_t value = i;
+                (void)queue.tryPush(value);
+            }
+        });
+    }
+
+    producers.clear();
+
+    //
+    // Every push either succeeded, was rolled back, or found the bitmap full.
+    //
+    auto stats = queue.stats();
+    ASSERT_EQ(queue.count(), 128);
+    ASSERT_EQ(stats[Counter::eHighWater], 128);
+    ASSERT_EQ(stats[Counter::eCountRollback] + stats[Counter::eBitmapFull], kThreads * kPushes - 128);
+}
+
+#if defined(__linux__)
+namespace {
+using SignalStatsQueue = sm::concurrent::RingBuffer<size_t, std::allocator<size_t>, sm::concurrent::DynamicCapacity, sm::concurrent::CompactLayout, sm::concurrent::AtomicStats>;
+
+SignalStatsQueue* gSignalStatsQueue = nullptr;
+
+void pushStatsFromSignal(int) {
+    size_t value = 42;
+    (void)gSignalStatsQueue->tryPush(value);
+}
+} // namespace
+
+TEST(RingBufferStatsTest, PushFromHandler) {
+    using Counter = sm::concurrent::RingBufferCounter;
+
+    SignalStatsQueue queue = SignalStatsQueue::create(1).value();
+    gSignalStatsQueue = &queue;
+
+    // Pushes from a signal handler update the stats without touching thread local state.
+    auto previous = std::signal(SIGUSR1, pushStatsFromSignal);
+    std::raise(SIGUSR1);
+    std::raise(SIGUSR1);
+    std::signal(SIGUSR1, previous);
+
+    auto stats = queue.stats();
+    ASSERT_EQ(queue.count(), 1);
+    ASSERT_EQ(stats[Counter::eHighWater], 1);
+    ASSERT_EQ(stats[Counter::eCountRollback], 1);
+}
+#endif
+
+TEST(RingBufferInPlaceTest, CreateAndAttach) {
+    using Queue = sm::concurrent::RingBuffer<size_t>;
+    constexpr size_t kSize = Queue::requiredInPlaceSize(64);
+
+    alignas(sm::concurrent::kCacheLineSize) std::byte region[kSize];
+    ASSERT_EQ(Queue::createInPlace(std::span(region, kSize - 1), 64), nullptr);
+    ASSERT_EQ(Queue::createInPlace(std::span(region + 1, kSize - 1), 1), nullptr);
+    ASSERT_EQ(Queue::createInPlace(region, 0), nullptr);
+
+    Queue* producer = Queue::createInPlace(region, 64);
+    ASSERT_NE(producer, nullptr);
+    ASSERT_EQ(producer->capacity(), 64);
+
+    Queue* consumer = Queue::attach(region);
+    ASSERT_EQ(consumer, producer);
+    ASSERT_EQ(Queue::attach(std::span(region, kSize - 1)), nullptr);
+
+    for (size_t i = 0; i < 64; i++) {
+        size_t value = i;
+        ASSERT_TRUE(producer->tryPush(value));
+    }
+
+    for (size_t i = 0; i < 64; i++) {
+        size_t value = 0;
+        ASSERT_TRUE(consumer->tryPop(value));
+        ASSERT_EQ(value, i);
+    }
+
+    std::destroy_at(producer);
+}
+
+TEST(RingBufferInPlaceTest, Relocated) {
+    using Queue = sm::concurrent::RingBuffer<size_t>;
+    constexpr size_t kSize = Queue::requiredInPlaceSize(16);
+
+    // a copy of the region at another address is the same queue, as a second mapping would be
+    alignas(sm::concurrent::kCacheLineSize) std::byte first[kSize];
+    alignas(sm::concurrent::kCacheLineSize) std::byte second[kSize];
+
+    Queue* queue = Queue::createInPlace(first, 16);
+    ASSERT_NE(queue, nullptr);
+    size_t value = 42;
+    ASSERT_TRUE(queue->tryPush(value));
+
+    std::memcpy(second, first, kSize);
+    Queue* relocated = Queue::attach(second);
+    ASSERT_NE(relocated, nullptr);
+    ASSERT_EQ(relocated->count(), 1);
+    ASSERT_TRUE(relocated->tryPop(value));
+    ASSERT_EQ(value, 42);
+
+    // the original is untouched by the copy
+    ASSERT_EQ(queue->count(), 1);
+    std::destroy_at(queue);
+}
+
+#if defined(__linux__)
+TEST(RingBufferInPlaceTest, CrossProcess) {
+    using Queue = sm::concurrent::RingBuffer<size_t, std::allocator<size_t>, sm::concurrent::Pow2Capacity>;
+    constexpr size_t kSize = Queue::requiredInPlaceSize(256);
+    constexpr size_t kCount = 10000;
+
+    void* mapping = mmap(nullptr, kSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    ASSERT_NE(mapping, MAP_FAILED);
+    std::span region(static_cast<std::byte*>(mapping), kSize);
+
+    Queue* queue = Queue::createInPlace(region, 256);
+    ASSERT_NE(queue, nullptr);
+
+    pid_t child = fork();
+    ASSERT_NE(child, -1);
+    if (child == 0) {
+        Queue* producer = Queue::attach(region);
+        if (producer == nullptr) {
+            _exit(1);
+        }
+
+        for (size_t i = 0; i < kCount; i++) {
+            size_t value = i;
+            while (!producer->tryPush(value)) {
+                std::this_thread::yield();
+            }
+        }
+
+        _exit(0);
+    }
+
+    for (size_t i = 0; i < kCount; i++) {
+        size_t value = 0;
+        while (!queue->tryPop(value)) {
+            std::this_thread::yield();
+        }
+
+        ASSERT_EQ(value, i);
+    }
+
+    int status = 0;
+    ASSERT_EQ(waitpid(child, &status, 0), child);
+    ASSERT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    std::destroy_at(queue);
+    munmap(mapping, kSize);
+}
+#endif
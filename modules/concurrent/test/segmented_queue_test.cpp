@@ -0,0 +1,292 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <latch>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <simcoe/concurrent/segmented_queue.hpp>
+
+namespace {
+std::atomic<size_t> gAllocations{0};
+std::atomic<size_t> gLive{0};
+std::atomic<size_t> gPeakLive{0};
+
+template <typename T>
+struct CountingAllocator {
+    using value_type = T;
+
+    constexpr CountingAllocator() noexcept = default;
+
+    template <typename U>
+    constexpr CountingAllocator(const CountingAllocator<U>&) noexcept {}
+
+    T* allocate(size_t n) {
+        gAllocations.fetch_add(1);
+        size_t live = gLive.fetch_add(1) + 1;
+        size_t peak = gPeakLive.load();
+        while (peak < live && !gPeakLive.compare_exchange_weak(peak, live)) {
+        }
+
+        return std::allocator<T>{}.allocate(n);
+    }
+
+    void deallocate(T* memory, size_t n) noexcept {
+        gLive.fetch_sub(1);
+        std::allocator<T>{}.deallocate(memory, n);
+    }
+
+    template <typename U>
+    constexpr bool operator==(const CountingAllocator<U>&) const noexcept {
+        return true;
+    }
+};
+} // namespace
+
+class SegmentedQueueTest : public testing::TestWithParam<uint32_t> {
+public:
+    sm::concurrent::SegmentedQueue<std::string> queue;
+
+    void SetUp() override {
+        auto result = sm::concurrent::SegmentedQueue<std::string>::create(GetParam());
+        ASSERT_TRUE(result.has_value());
+        queue = std::move(result.value());
+
+        ASSERT_EQ(queue.segmentCapacity(), GetParam());
+    }
+};
+
+TEST_P(SegmentedQueueTest, PopEmpty) {
+    std::string value = "unchanged";
+    ASSERT_FALSE(queue.tryPop(value));
+    ASSERT_EQ(value, "unchanged");
+}
+
+TEST_P(SegmentedQueueTest, OrderAcrossSegments) {
+    const size_t count = queue.segmentCapacity() * 5 + 1;
+    for (size_t i = 0; i < count; i++) {
+        std::string value = std::to_string(i);
+        ASSERT_TRUE(queue.tryPush(value));
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        std::string value;
+        ASSERT_TRUE(queue.tryPop(value)) << "Failed to pop at index " << i;
+        ASSERT_EQ(value, std::to_string(i));
+    }
+
+    std::string value = "unchanged";
+    ASSERT_FALSE(queue.tryPop(value));
+    ASSERT_EQ(value, "unchanged");
+}
+
+TEST_P(SegmentedQueueTest, DestroyWithElements) {
+    for (size_t i = 0; i < queue.segmentCapacity() * 3 + 1; i++) {
+        ASSERT_TRUE(queue.tryEmplace(std::to_string(i)));
+    }
+
+    // Leave the consumer part way through a segment.
+    std::string value;
+    ASSERT_TRUE(queue.tryPop(value));
+
+    SUCCEED() << "Remaining elements are destroyed with the queue";
+}
+
+INSTANTIATE_TEST_SUITE_P(SegmentedQueueTests, SegmentedQueueTest, testing::Values(1, 2, 3, 64));
+
+TEST(SegmentedQueueConstructTest, Invalid) {
+    ASSERT_FALSE(sm::concurrent::SegmentedQueue<int>::create(0).has_value());
+}
+
+TEST(SegmentedQueueRecycleTest, SteadyStateReusesSegments) {
+    using Queue = sm::concurrent::SegmentedQueue<int, CountingAllocator<int>>;
+    static constexpr uint32_t kSegment = 16;
+
+    {
+        auto queue = Queue::create(kSegment).value();
+
+        // Warm up, this allocates the spare segments.
+        for (int round = 0; round < 4; round++) {
+            for (int i = 0; i < int(kSegment) * 3; i++) {
+                ASSERT_TRUE(queue.tryEmplace(i));
+            }
+
+            int value = 0;
+            while (queue.tryPop(value)) {
+            }
+        }
+
+        size_t before = gAllocations.load();
+        for (int round = 0; round < 100; round++) {
+            for (int i = 0; i < int(kSegment); i++) {
+                ASSERT_TRUE(queue.tryEmplace(i));
+            }
+
+            int value = 0;
+            for (int i = 0; i < int(kSegment); i++) {
+                ASSERT_TRUE(queue.tryPop(value));
+                ASSERT_EQ(value, i);
+            }
+        }
+
+        ASSERT_EQ(gAllocations.load(), before) << "Segments should be recycled instead of allocated";
+        ASSERT_LE(gLive.load(), 4u);
+    }
+
+    ASSERT_EQ(gLive.load(), 0u);
+}
+
+TEST(SegmentedQueueThreadTest, ManyProducers) {
+    static constexpr size_t kProducers = 4;
+    static constexpr size_t kMessagesPerProducer = 20000;
+
+    auto queue = sm::concurrent::SegmentedQueue<size_t>::create(32).value();
+
+    std::latch start(kProducers + 1);
+    std::vector<std::jthread> threads;
+    for (size_t p = 0; p < kProducers; p++) {
+        threads.emplace_back([&, p] {
+            start.arrive_and_wait();
+            for (size_t i = 0; i < kMessagesPerProducer; i++) {
+                ASSERT_TRUE(queue.tryEmplace(p * kMessagesPerProducer + i));
+            }
+        });
+    }
+
+    // each producer's messages must arrive in order
+    std::vector<size_t> last(kProducers, 0);
+    std::vector<uint32_t> seen(kProducers * kMessagesPerProducer);
+    bool outOfOrder = false;
+
+    start.arrive_and_wait();
+    for (size_t consumed = 0; consumed < kProducers * kMessagesPerProducer;) {
+        size_t value = 0;
+        if (!queue.tryPop(value)) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        size_t producer = value / kMessagesPerProducer;
+        size_t index = value % kMessagesPerProducer + 1;
+        if (index <= last[producer]) {
+            outOfOrder = true;
+        }
+
+        last[producer] = index;
+        seen[value] += 1;
+        consumed += 1;
+    }
+
+    threads.clear();
+
+    ASSERT_FALSE(outOfOrder);
+    for (size_t i = 0; i < seen.size(); i++) {
+        ASSERT_EQ(seen[i], 1) << "Message " << i << " was not consumed exactly once";
+    }
+}
+
+namespace {
+/**
+ * @brief Keeps at least one producer inside a push at all times.
+ *
+ * Each push only finishes constructing its element once another push has started, until a single
+ * producer is left, so the pushes of different producers always overlap.
+ */
+struct PushRelay {
+    std::atomic<size_t> entries{0};
+    std::atomic<size_t> producers{0};
+};
+
+struct RelayedValue {
+    size_t value;
+
+    RelayedValue(size_t id, PushRelay& relay) noexcept
+        : value(id) {
+        size_t entry = relay.entries.fetch_add(1) + 1;
+        while (relay.entries.load() == entry && relay.producers.load() > 1) {
+            std::this_thread::yield();
+        }
+    }
+};
+} // namespace
+
+TEST(SegmentedQueueThreadTest, OverlappingProducersRecycleSegments) {
+    using Queue = sm::concurrent::SegmentedQueue<RelayedValue, CountingAllocator<RelayedValue>>;
+    static constexpr size_t kProducers = 4;
+    static constexpr size_t kMessagesPerProducer = 20000;
+    static constexpr uint32_t kSegment = 8;
+
+    // Producers never run far ahead of the consumer, so only reclamation can grow memory.
+    static constexpr size_t kMaxInFlight = kSegment;
+
+    {
+        auto queue = Queue::create(kSegment).value();
+        gPeakLive.store(gLive.load());
+        size_t allocationsBefore = gAllocations.load();
+
+        PushRelay relay;
+        relay.producers.store(kProducers);
+
+        std::atomic<size_t> pushed{0};
+        std::atomic<size_t> popped{0};
+
+        std::latch start(kProducers + 1);
+        std::vector<std::jthread> threads;
+        for (size_t p = 0; p < kProducers; p++) {
+            threads.emplace_back([&, p] {
+                start.arrive_and_wait();
+                for (size_t i = 0; i < kMessagesPerProducer; i++) {
+                    while (pushed.load() - popped.load() >= kMaxInFlight) {
+                        std::this_thread::yield();
+                    }
+
+                    ASSERT_TRUE(queue.tryEmplace(p * kMessagesPerProducer + i, relay));
+                    pushed.fetch_add(1);
+                }
+
+                relay.producers.fetch_sub(1);
+            });
+        }
+
+        std::vector<uint32_t> seen(kProducers * kMessagesPerProducer);
+
+        start.arrive_and_wait();
+        while (popped.load() < kProducers * kMessagesPerProducer) {
+            bool consumed = queue.tryConsume([&](RelayedValue& element) noexcept {
+                seen[element.value] += 1;
+            });
+
+            if (!consumed) {
+                std::this_thread::yield();
+                continue;
+            }
+
+            popped.fetch_add(1);
+        }
+
+        threads.clear();
+
+        for (size_t i = 0; i < seen.size(); i++) {
+            ASSERT_EQ(seen[i], 1) << "Message " << i << " was not consumed exactly once";
+        }
+
+        // Thousands of segments were filled while pushes overlapped, nearly all of them should be recycled.
+        size_t rollovers = kProducers * kMessagesPerProducer / kSegment;
+        size_t allocations = gAllocations.load() - allocationsBefore;
+        EXPECT_LT(allocations, rollovers / 10) << allocations << " allocations for " << rollovers << " segments";
+
+        size_t bound = kMaxInFlight / kSegment + kProducers + 8;
+        EXPECT_LE(gPeakLive.load(), bound);
+
+        // Once producers are idle every retired segment is reused or deallocated.
+        ASSERT_FALSE(queue.tryConsume([](RelayedValue&) noexcept {}));
+        ASSERT_FALSE(queue.tryConsume([](RelayedValue&) noexcept {}));
+        EXPECT_LE(gLive.load(), 4u);
+    }
+
+    ASSERT_EQ(gLive.load(), 0u);
+}
@@ -0,0 +1,165 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+
+#include <latch>
+#include <string>
+#include <thread>
+#include <vector>
+
+// strings move assignment isnt nonblocking so clang rightly complains
+#if defined(__clang__)
+#    pragma clang diagnostic push
+#    pragma clang diagnostic ignored "-Wfunction-effects"
+#endif
+
+#include <simcoe/concurrent/sharded_ring_buffer.hpp>
+
+#if defined(__clang__)
+#    pragma clang diagnostic pop
+#endif
+
+namespace {
+// Pushes to whichever shard the test selects.
+struct ManualSharding {
+    static inline thread_local size_t tShard = 0;
+
+    static size_t select() noexcept {
+        return tShard;
+    }
+};
+
+// Pushes are only marked nonblocking for policies that declare it.
+static_assert(!sm::concurrent::detail::isNonBlockingSharding<sm::concurrent::ThreadSharding>());
+static_assert(sm::concurrent::detail::isNonBlockingSharding<sm::concurrent::ProcessorSharding>());
+static_assert(!sm::concurrent::detail::isNonBlockingSharding<ManualSharding>());
+} // namespace
+
+TEST(ShardedRingBufferConstructTest, Invalid) {
+    ASSERT_FALSE(sm::concurrent::ShardedRingBuffer<int>::create(0, 16).has_value());
+    ASSERT_FALSE(sm::concurrent::ShardedRingBuffer<int>::create(1, 0).has_value());
+}
+
+TEST(ShardedRingBufferTest, PushPop) {
+    auto queue = sm::concurrent::ShardedRingBuffer<std::string>::create(4, 16).value();
+    ASSERT_EQ(queue.shardCount(), 4);
+    ASSERT_EQ(queue.capacity(), 64);
+
+    for (size_t i = 0; i < 16; i++) {
+        ASSERT_TRUE(queue.tryEmplace(std::to_string(i)));
+    }
+
+    std::string value = "This should not be pushed";
+    ASSERT_FALSE(queue.tryPush(value)) << "Only the shard of this thread should be used";
+    ASSERT_EQ(queue.count(), 16);
+
+    for (size_t i = 0; i < 16; i++) {
+        ASSERT_TRUE(queue.tryPop(value));
+        ASSERT_EQ(value, std::to_string(i));
+    }
+
+    ASSERT_FALSE(queue.tryPop(value));
+}
+
+TEST(ShardedRingBufferTest, DrainVisitsEveryShard) {
+    using Queue = sm::concurrent::ShardedRingBuffer<size_t, std::allocator<size_t>, ManualSharding>;
+    auto queue = Queue::create(3, 256).value();
+
+    for (size_t shard = 0; shard < 3; shard++) {
+        ManualSharding::tShard = shard;
+        for (size_t i = 0; i < 200; i++) {
+            ASSERT_TRUE(queue.tryEmplace(shard * 1000 + i));
+        }
+    }
+
+    // A limited drain should take from more than one shard.
+    std::vector<size_t> seen;
+    auto visitor = [&seen](size_t& value) noexcept { seen.push_back(value); };
+    ASSERT_EQ(queue.drain(visitor, 192), 192);
+
+    std::vector<size_t> perShard(3, 0);
+    for (size_t value : seen) {
+        perShard[value / 1000] += 1;
+    }
+
+    ASSERT_EQ(perShard[0], 64);
+    ASSERT_EQ(perShard[1], 64);
+    ASSERT_EQ(perShard[2], 64);
+
+    ASSERT_EQ(queue.drain(visitor), 600 - 192);
+    ASSERT_EQ(queue.count(), 0);
+
+    // Values of each shard keep their order.
+    std::vector<size_t> last(3, 0);
+    for (size_t value : seen) {
+        size_t shard = value / 1000;
+        size_t index = value % 1000 + 1;
+        ASSERT_GT(index, last[shard]);
+        last[shard] = index;
+    }
+}
+
+TEST(ShardedRingBufferTest, ProcessorSharding) {
+    using Queue = sm::concurrent::ShardedRingBuffer<int, std::allocator<int>, sm::concurrent::ProcessorSharding>;
+    size_t processors = std::max(1u, std::thread::hardware_concurrency());
+    auto queue = Queue::create(static_cast<uint32_t>(processors), 64).value();
+
+    ASSERT_LT(sm::concurrent::currentProcessor(), processors);
+    ASSERT_TRUE(queue.tryEmplace(42));
+
+    int value = 0;
+    ASSERT_TRUE(queue.tryPop(value));
+    ASSERT_EQ(value, 42);
+}
+
+TEST(ShardedRingBufferThreadTest, ManyProducers) {
+    static constexpr size_t kProducers = 8;
+    static constexpr size_t kMessagesPerProducer = 20000;
+
+    auto queue = sm::concurrent::ShardedRingBuffer<size_t>::create(4, 256).value();
+
+    std::latch start(kProducers + 1);
+    std::vector<std::jthread> threads;
+    for (size_t p = 0; p < kProducers; p++) {
+        threads.emplace_back([&, p] {
+            start.arrive_and_wait();
+            for (size_t i = 0; i < kMessagesPerProducer; i++) {
+                while (!queue.tryEmplace(p * kMessagesPerProducer + i)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    // each producer's messages must arrive in order
+    std::vector<size_t> last(kProducers, 0);
+    std::vector<uint32_t> seen(kProducers * kMessagesPerProducer);
+    bool outOfOrder = false;
+
+    auto visitor = [&](size_t& value) noexcept {
+        size_t producer = value / kMessagesPerProducer;
+        size_t index = value % kMessagesPerProducer + 1;
+        if (index <= last[producer]) {
+            outOfOrder = true;
+        }
+
+        last[producer] = index;
+        seen[value] += 1;
+    };
+
+    start.arrive_and_wait();
+    for (size_t consumed = 0; consumed < kProducers * kMessagesPerProducer;) {
+        size_t popped = queue.drain(visitor);
+        if (popped == 0) {
+            std::this_thread::yield();
+        }
+        consumed += popped;
+    }
+
+    threads.clear();
+
+    ASSERT_FALSE(outOfOrder);
+    for (size_t i = 0; i < seen.size(); i++) {
+        ASSERT_EQ(seen[i], 1) << "Message " << i << " was not consumed exactly once";
+    }
+}
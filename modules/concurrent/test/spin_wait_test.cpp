@@ -0,0 +1,73 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <simcoe/concurrent/parking.hpp>
+#include <simcoe/concurrent/spin_wait.hpp>
+
+using sm::concurrent::SpinWait;
+
+TEST(SpinWaitTest, RoundsUntilPark) {
+    SpinWait spin{{.pauseRounds = 3, .maxPauses = 4, .yieldRounds = 2}};
+
+    for (uint32_t i = 0; i < 5; i++) {
+        ASSERT_FALSE(spin.shouldPark());
+        ASSERT_EQ(spin.rounds(), i);
+        spin.spinOnce();
+    }
+
+    ASSERT_TRUE(spin.shouldPark());
+
+    // Spinning past the policy keeps backing off.
+    spin.spinOnce();
+    ASSERT_TRUE(spin.shouldPark());
+
+    spin.reset();
+    ASSERT_FALSE(spin.shouldPark());
+    ASSERT_EQ(spin.rounds(), 0);
+}
+
+TEST(SpinWaitTest, PauseCountsRounds) {
+    SpinWait spin{sm::concurrent::kRetrySpin};
+    for (uint32_t i = 0; i < 100; i++) {
+        spin.pause();
+    }
+
+    ASSERT_EQ(spin.rounds(), 100);
+}
+
+TEST(SpinWaitTest, ZeroRoundsParksImmediately) {
+    SpinWait spin{{.pauseRounds = 0, .maxPauses = 0, .yieldRounds = 0}};
+    ASSERT_TRUE(spin.shouldPark());
+}
+
+TEST(SpinWaitTest, WaitReturnsWhenUnchanged) {
+    std::atomic<uint32_t> word{1};
+
+    SpinWait spin{{.pauseRounds = 4, .maxPauses = 8, .yieldRounds = 4}};
+    spin.wait(word, 0);
+
+    ASSERT_EQ(spin.rounds(), 0);
+}
+
+TEST(SpinWaitTest, WaitParksUntilWoken) {
+    std::atomic<uint32_t> word{0};
+
+    std::thread waker([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        word.store(1);
+        sm::concurrent::unparkAll(word);
+    });
+
+    SpinWait spin{{.pauseRounds = 2, .maxPauses = 2, .yieldRounds = 2}};
+    spin.wait(word, 0);
+
+    ASSERT_EQ(word.load(), 1);
+    ASSERT_TRUE(spin.shouldPark());
+
+    waker.join();
+}
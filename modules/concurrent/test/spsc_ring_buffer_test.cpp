@@ -0,0 +1,103 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+
+// strings move assignment isnt nonblocking so clang rightly complains
+#if defined(__clang__)
+#    pragma clang diagnostic push
+#    pragma clang diagnostic ignored "-Wfunction-effects"
+#endif
+
+#include <simcoe/concurrent/spsc_ring_buffer.hpp>
+
+#if defined(__clang__)
+#    pragma clang diagnostic pop
+#endif
+
+class SpscRingBufferTest : public testing::TestWithParam<uint32_t> {
+public:
+    sm::concurrent::SpscRingBuffer<std::string> queue;
+
+    void SetUp() override {
+        auto result = sm::concurrent::SpscRingBuffer<std::string>::create(GetParam());
+        ASSERT_TRUE(result.has_value());
+        queue = std::move(result.value());
+
+        ASSERT_EQ(queue.capacity(), GetParam());
+        ASSERT_EQ(queue.count(), 0);
+    }
+};
+
+TEST_P(SpscRingBufferTest, PushFull) {
+    for (size_t i = 0; i < queue.capacity(); i++) {
+        std::string value = "Hello, World!";
+        ASSERT_TRUE(queue.tryPush(value)) << "Failed to push at index " << i;
+    }
+    ASSERT_EQ(queue.count(), queue.capacity());
+
+    std::string value = "This should not be pushed";
+    ASSERT_FALSE(queue.tryPush(value));
+    ASSERT_EQ(value, "This should not be pushed");
+}
+
+TEST_P(SpscRingBufferTest, PopEmpty) {
+    std::string value;
+    ASSERT_FALSE(queue.tryPop(value));
+}
+
+TEST_P(SpscRingBufferTest, OrderAcrossLaps) {
+    size_t next = 0;
+    size_t expected = 0;
+    for (size_t lap = 0; lap < 4; lap++) {
+        for (size_t i = 0; i < queue.capacity(); i++) {
+            std::string value = std::to_string(next++);
+            ASSERT_TRUE(queue.tryPush(value));
+        }
+
+        for (size_t i = 0; i < queue.capacity(); i++) {
+            std::string value;
+            ASSERT_TRUE(queue.tryPop(value));
+            ASSERT_EQ(value, std::to_string(expected++));
+        }
+    }
+
+    ASSERT_EQ(queue.count(), 0);
+}
+
+TEST_P(SpscRingBufferTest, DestroyWithElements) {
+    for (size_t i = 0; i < queue.capacity(); i++) {
+        std::string value = std::string(64, 'x');
+        ASSERT_TRUE(queue.tryPush(value));
+    }
+
+    SUCCEED() << "Remaining elements are destroyed with the queue";
+}
+
+INSTANTIATE_TEST_SUITE_P(SpscRingBufferTests, SpscRingBufferTest, testing::Values(1, 2, 3, 64, 1000));
+
+TEST(SpscRingBufferThreadTest, InOrder) {
+    static constexpr size_t kMessageCount = 100000;
+
+    auto queue = sm::concurrent::SpscRingBuffer<size_t>::create(64).value();
+
+    std::jthread producer([&] {
+        for (size_t i = 0; i < kMessageCount; i++) {
+            size_t value = i;
+            while (!queue.tryPush(value)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    for (size_t i = 0; i < kMessageCount; i++) {
+        size_t value = 0;
+        while (!queue.tryPop(value)) {
+            std::this_thread::yield();
+        }
+
+        ASSERT_EQ(value, i);
+    }
+}
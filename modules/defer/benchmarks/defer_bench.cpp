@@ -0,0 +1,87 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include <benchmark/benchmark.h>
+
+#include <cstdlib>
+#include <functional>
+#include <simcoe/defer/defer.hpp>
+#include <simcoe/defer/defer_stack.hpp>
+#include <vector>
+
+namespace {
+/**
+ * @brief Cleanup written out by hand at every exit, the baseline for SM_DEFER.
+ */
+void BM_HandWrittenCleanup(benchmark::State& state) {
+    for (auto _ : state) {
+        void* ptr = std::malloc(16);
+        benchmark::DoNotOptimize(ptr);
+        std::free(ptr);
+    }
+}
+
+void BM_Defer(benchmark::State& state) {
+    for (auto _ : state) {
+        void* ptr = std::malloc(16);
+        SM_DEFER {
+            std::free(ptr);
+        };
+        benchmark::DoNotOptimize(ptr);
+    }
+}
+
+#if __cpp_exceptions >= 199711L
+void BM_ErrDefer(benchmark::State& state) {
+    for (auto _ : state) {
+        void* ptr = std::malloc(16);
+        SM_ERRDEFER {
+            std::free(ptr);
+        };
+        benchmark::DoNotOptimize(ptr);
+        std::free(ptr);
+    }
+}
+#endif
+
+/**
+ * @brief Runtime cleanups in a vector of std::function, the baseline for DeferStack.
+ */
+void BM_FunctionVectorCleanup(benchmark::State& state) {
+    for (auto _ : state) {
+        std::vector<std::function<void()>> cleanups;
+        for (int64_t i = 0; i < state.range(0); i++) {
+            void* ptr = std::malloc(16);
+            benchmark::DoNotOptimize(ptr);
+            cleanups.emplace_back([ptr] { std::free(ptr); });
+        }
+
+        for (auto it = cleanups.rbegin(); it != cleanups.rend(); ++it) {
+            (*it)();
+        }
+    }
+}
+
+void BM_DeferStack(benchmark::State& state) {
+    for (auto _ : state) {
+        sm::DeferStack<1024> cleanups;
+        for (int64_t i = 0; i < state.range(0); i++) {
+            void* ptr = std::malloc(16);
+            benchmark::DoNotOptimize(ptr);
+            if (!cleanups.defer([ptr] { std::free(ptr); })) {
+                std::free(ptr);
+            }
+        }
+    }
+}
+} // namespace
+
+BENCHMARK(BM_HandWrittenCleanup);
+BENCHMARK(BM_Defer);
+BENCHMARK(BM_FunctionVectorCleanup)->Arg(1)->Arg(8)->Arg(32);
+BENCHMARK(BM_DeferStack)->Arg(1)->Arg(8)->Arg(32);
+
+#if __cpp_exceptions >= 199711L
+BENCHMARK(BM_ErrDefer);
+#endif
+
+BENCHMARK_MAIN();
@@ -0,0 +1,261 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#if __cpp_exceptions >= 199711L
+#    include <exception>
+#endif // __cpp_exceptions >= 199711L
+
+namespace sm {
+/**
+ * @brief A stack of cleanups registered at runtime, run in reverse order when it is destroyed.
+ *
+ * Covers the cases SM_DEFER cannot, such as releasing a variable number of resources acquired in a loop.
+ * Callables are stored type erased in @p N bytes of inline storage, once that is full they are allocated
+ * from the arena passed to the constructor, so registering a cleanup only allocates when the inline
+ * storage overflows.
+ *
+ * @code{.cpp}
+ * sm::DeferStack<256> cleanup;
+ * for (const char* path : paths) {
+ *     FILE* file = fopen(path, "r");
+ *     if (file == nullptr || !cleanup.defer([file] { fclose(file); })) {
+ *         return false; // every file opened so far is closed here
+ *     }
+ * }
+ *
+ * cleanup.cancel(); // keep the files open
+ * @endcode
+ *
+ * @tparam N The number of bytes of inline storage.
+ */
+template <size_t N = 256>
+class DeferStack {
+    struct Record {
+        Record* previous;
+
+        // Runs the callable if @p run is set and then destroys it.
+        void (*finish)(Record* self, bool run) noexcept;
+
+        // The size of the allocation if the record came from the arena, 0 if it is inline.
+        size_t arenaSize;
+
+        size_t arenaAlignment;
+
+        bool errorOnly;
+    };
+
+    template <typename F>
+    static constexpr size_t kCallableOffset = (sizeof(Record) + alignof(F) - 1) / alignof(F) * alignof(F);
+
+    template <typename F>
+    static constexpr size_t kRecordAlignment = (std::max)(alignof(Record), alignof(F));
+
+    template <typename F>
+    static constexpr size_t kRecordSize = kCallableOffset<F> + sizeof(F);
+
+    template <typename F>
+    static void finishRecord(Record* self, bool run) noexcept {
+        F* fn = std::launder(reinterpret_cast<F*>(reinterpret_cast<std::byte*>(self) + kCallableOffset<F>));
+        if (run) {
+            (*fn)();
+        }
+
+        fn->~F();
+    }
+
+    alignas(std::max_align_t) std::byte mStorage[N];
+
+    size_t mUsed{0};
+
+    Record* mTop{nullptr};
+
+    size_t mCount{0};
+
+    std::pmr::memory_resource* mArena;
+
+#if __cpp_exceptions >= 199711L
+    int mUncaughtExceptions{std::uncaught_exceptions()};
+#endif // __cpp_exceptions >= 199711L
+
+    void* allocateRecord(size_t size, size_t alignment, bool& inArena) noexcept {
+        size_t offset = (mUsed + alignment - 1) / alignment * alignment;
+        if (alignment <= alignof(std::max_align_t) && offset + size <= N) {
+            mUsed = offset + size;
+            inArena = false;
+            return mStorage + offset;
+        }
+
+        if (mArena == nullptr) {
+            return nullptr;
+        }
+
+#if __cpp_exceptions >= 199711L
+        try {
+            inArena = true;
+            return mArena->allocate(size, alignment);
+        } catch (...) {
+            return nullptr;
+        }
+#else
+        inArena = true;
+        return mArena->allocate(size, alignment);
+#endif // __cpp_exceptions >= 199711L
+    }
+
+    template <typename F>
+    bool push(F&& fn, bool errorOnly) noexcept(std::is_nothrow_constructible_v<std::decay_t<F>, F&&>) {
+        using Fn = std::decay_t<F>;
+
+        [[maybe_unused]] size_t used = mUsed;
+        bool inArena = false;
+        void* memory = allocateRecord(kRecordSize<Fn>, kRecordAlignment<Fn>, inArena);
+        if (memory == nullptr) {
+            return false;
+        }
+
+        auto* record = static_cast<Record*>(memory);
+
+        void* callable = static_cast<std::byte*>(memory) + kCallableOffset<Fn>;
+#if __cpp_exceptions >= 199711L
+        if constexpr (std::is_nothrow_constructible_v<Fn, F&&>) {
+            ::new (callable) Fn(std::forward<F>(fn));
+        } else {
+            try {
+                ::new (callable) Fn(std::forward<F>(fn));
+            } catch (...) {
+                if (inArena) {
+                    mArena->deallocate(memory, kRecordSize<Fn>, kRecordAlignment<Fn>);
+                }
+                mUsed = used;
+                throw;
+            }
+        }
+#else
+        ::new (callable) Fn(std::forward<F>(fn));
+#endif // __cpp_exceptions >= 199711L
+
+        ::new (memory) Record{
+            .previous = mTop,
+            .finish = &DeferStack::finishRecord<Fn>,
+            .arenaSize = inArena ? kRecordSize<Fn> : 0,
+            .arenaAlignment = kRecordAlignment<Fn>,
+            .errorOnly = errorOnly,
+        };
+
+        mTop = record;
+        mCount += 1;
+        return true;
+    }
+
+    // Pop every record, running the cleanups if @p run is set and errdefer cleanups only if @p failed is too.
+    void unwind(bool run, bool failed) noexcept {
+        while (mTop != nullptr) {
+            Record* record = mTop;
+            mTop = record->previous;
+            record->finish(record, run && (failed || !record->errorOnly));
+
+            if (record->arenaSize != 0) {
+                mArena->deallocate(record, record->arenaSize, record->arenaAlignment);
+            }
+        }
+
+        mUsed = 0;
+        mCount = 0;
+    }
+
+public:
+    /**
+     * @brief Create an empty defer stack.
+     *
+     * @param arena The memory resource used once the inline storage is full, or null to fail instead.
+     */
+    explicit DeferStack(std::pmr::memory_resource* arena = nullptr) noexcept
+        : mArena(arena) {}
+
+    DeferStack(const DeferStack& other) = delete;
+    DeferStack& operator=(const DeferStack& other) = delete;
+
+    /**
+     * @brief Run every registered cleanup in reverse order of registration.
+     *
+     * Cleanups registered with errdefer only run if the stack is destroyed by an exception.
+     */
+    ~DeferStack() noexcept {
+#if __cpp_exceptions >= 199711L
+        unwind(true, std::uncaught_exceptions() > mUncaughtExceptions);
+#else
+        unwind(true, false);
+#endif // __cpp_exceptions >= 199711L
+    }
+
+    /**
+     * @brief Register a cleanup to run when the stack is destroyed.
+     *
+     * @param fn The cleanup, it runs inside a noexcept destructor so it must not throw.
+     *
+     * @return true if the cleanup was registered, false if the inline storage is full and there is no arena
+     *         or the arena failed to allocate.
+     */
+    template <typename F>
+#if __cpp_concepts >= 201907L
+        requires std::is_invocable_v<std::decay_t<F>&>
+#endif
+    [[nodiscard]]
+    bool defer(F&& fn) noexcept(std::is_nothrow_constructible_v<std::decay_t<F>, F&&>) {
+        return push(std::forward<F>(fn), false);
+    }
+
+#if __cpp_exceptions >= 199711L
+    /**
+     * @brief Register a cleanup to run only if the stack is destroyed by an exception.
+     *
+     * @param fn The cleanup, it runs inside a noexcept destructor so it must not throw.
+     *
+     * @return true if the cleanup was registered, false if it could not be stored.
+     */
+    template <typename F>
+#    if __cpp_concepts >= 201907L
+        requires std::is_invocable_v<std::decay_t<F>&>
+#    endif
+    [[nodiscard]]
+    bool errdefer(F&& fn) noexcept(std::is_nothrow_constructible_v<std::decay_t<F>, F&&>) {
+        return push(std::forward<F>(fn), true);
+    }
+#endif // __cpp_exceptions >= 199711L
+
+    /**
+     * @brief Discard every registered cleanup without running it.
+     *
+     * Used once the work guarded by the stack succeeded and the resources should be kept.
+     */
+    void cancel() noexcept {
+        unwind(false, false);
+    }
+
+    /**
+     * @brief Get the number of registered cleanups.
+     *
+     * @return The cleanup count.
+     */
+    size_t size() const noexcept {
+        return mCount;
+    }
+
+    /**
+     * @brief Check if no cleanups are registered.
+     *
+     * @return true if the stack is empty.
+     */
+    bool empty() const noexcept {
+        return mCount == 0;
+    }
+};
+} // namespace sm
@@ -0,0 +1,170 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <memory>
+#include <memory_resource>
+#include <simcoe/defer/defer_stack.hpp>
+#include <stdexcept>
+#include <vector>
+
+class DeferStackTest : public testing::Test {};
+
+namespace {
+/**
+ * @brief A memory resource that counts live allocations, used to check the arena is only used on overflow.
+ */
+class CountingResource : public std::pmr::memory_resource {
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        allocations += 1;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* ptr, size_t bytes, size_t alignment) override {
+        deallocations += 1;
+        std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+public:
+    int allocations = 0;
+    int deallocations = 0;
+};
+} // namespace
+
+TEST_F(DeferStackTest, RunsInReverseOrder) {
+    std::vector<int> order;
+
+    {
+        sm::DeferStack<> stack;
+        for (int i = 0; i < 4; i++) {
+            ASSERT_TRUE(stack.defer([&order, i] { order.push_back(i); }));
+        }
+
+        EXPECT_EQ(stack.size(), 4u);
+        EXPECT_TRUE(order.empty());
+    }
+
+    EXPECT_EQ(order, (std::vector<int>{3, 2, 1, 0}));
+}
+
+TEST_F(DeferStackTest, Cancel) {
+    int runs = 0;
+    auto counter = std::make_shared<int>(0);
+
+    {
+        sm::DeferStack<> stack;
+        ASSERT_TRUE(stack.defer([&runs, counter] { runs += 1; }));
+        EXPECT_EQ(counter.use_count(), 2);
+
+        stack.cancel();
+        EXPECT_TRUE(stack.empty());
+        EXPECT_EQ(counter.use_count(), 1);
+
+        ASSERT_TRUE(stack.defer([&runs] { runs += 10; }));
+    }
+
+    EXPECT_EQ(runs, 10);
+}
+
+TEST_F(DeferStackTest, FullWithoutArena) {
+    int runs = 0;
+
+    {
+        sm::DeferStack<64> stack;
+        int registered = 0;
+        while (stack.defer([&runs] { runs += 1; })) {
+            registered += 1;
+        }
+
+        EXPECT_GT(registered, 0);
+        EXPECT_EQ(stack.size(), static_cast<size_t>(registered));
+    }
+
+    EXPECT_GT(runs, 0);
+}
+
+TEST_F(DeferStackTest, OverflowUsesArena) {
+    CountingResource arena;
+    std::vector<int> order;
+
+    {
+        sm::DeferStack<64> stack{&arena};
+        for (int i = 0; i < 16; i++) {
+            ASSERT_TRUE(stack.defer([&order, i] { order.push_back(i); }));
+        }
+
+        EXPECT_GT(arena.allocations, 0);
+        EXPECT_LT(arena.allocations, 16);
+    }
+
+    EXPECT_EQ(arena.allocations, arena.deallocations);
+    ASSERT_EQ(order.size(), 16u);
+    for (int i = 0; i < 16; i++) {
+        EXPECT_EQ(order[i], 15 - i);
+    }
+}
+
+TEST_F(DeferStackTest, LargeCallable) {
+    CountingResource arena;
+    std::array<int, 64> values{};
+    values[63] = 7;
+    int result = 0;
+
+    {
+        sm::DeferStack<64> stack{&arena};
+        ASSERT_TRUE(stack.defer([&result, values] { result = values[63]; }));
+        EXPECT_EQ(arena.allocations, 1);
+    }
+
+    EXPECT_EQ(result, 7);
+    EXPECT_EQ(arena.deallocations, 1);
+}
+
+#if __cpp_exceptions >= 199711L
+TEST_F(DeferStackTest, ErrDeferOnlyOnException) {
+    int x = 0;
+
+    {
+        sm::DeferStack<> stack;
+        ASSERT_TRUE(stack.defer([&x] { x += 1; }));
+        ASSERT_TRUE(stack.errdefer([&x] { x += 10; }));
+    }
+
+    EXPECT_EQ(x, 1);
+
+    try {
+        sm::DeferStack<> stack;
+        ASSERT_TRUE(stack.defer([&x] { x += 1; }));
+        ASSERT_TRUE(stack.errdefer([&x] { x += 10; }));
+        throw std::runtime_error("Test");
+    } catch (...) {
+    }
+
+    EXPECT_EQ(x, 12);
+}
+
+TEST_F(DeferStackTest, ErrDeferDuringUnrelatedUnwind) {
+    // A stack created while another exception is in flight only treats a new exception as an error.
+    struct Guard {
+        int& x;
+
+        ~Guard() {
+            sm::DeferStack<> stack;
+            (void)stack.errdefer([this] { x += 10; });
+            (void)stack.defer([this] { x += 1; });
+        }
+    };
+
+    int x = 0;
+    try {
+        Guard guard{x};
+        throw std::runtime_error("Test");
+    } catch (...) {
+    }
+
+    EXPECT_EQ(x, 1);
+}
+#endif
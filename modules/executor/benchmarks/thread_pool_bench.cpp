@@ -0,0 +1,164 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <latch>
+#include <mutex>
+#include <simcoe/executor/parallel_for.hpp>
+#include <simcoe/executor/thread_pool.hpp>
+#include <thread>
+#include <vector>
+
+namespace {
+/**
+ * @brief The baseline, a fixed set of std::threads sharing one mutex protected queue.
+ */
+class MutexPool {
+    std::mutex mMutex;
+    std::condition_variable mReady;
+    std::deque<std::function<void()>> mTasks;
+    bool mStopping = false;
+    std::vector<std::thread> mThreads;
+
+public:
+    explicit MutexPool(uint32_t workerCount) {
+        for (uint32_t i = 0; i < workerCount; i++) {
+            mThreads.emplace_back([this] {
+                while (true) {
+                    std::function<void()> task;
+                    {
+                        std::unique_lock lock(mMutex);
+                        mReady.wait(lock, [this] { return mStopping || !mTasks.empty(); });
+                        if (mTasks.empty()) {
+                            return;
+                        }
+
+                        task = std::move(mTasks.front());
+                        mTasks.pop_front();
+                    }
+
+                    task();
+                }
+            });
+        }
+    }
+
+    ~MutexPool() {
+        {
+            std::lock_guard lock(mMutex);
+            mStopping = true;
+        }
+
+        mReady.notify_all();
+        for (auto& thread : mThreads) {
+            thread.join();
+        }
+    }
+
+    template <typename F>
+    void submit(F&& fn) {
+        {
+            std::lock_guard lock(mMutex);
+            mTasks.emplace_back(std::forward<F>(fn));
+        }
+
+        mReady.notify_one();
+    }
+};
+
+/**
+ * @brief Submit a batch of small tasks from outside the pool and wait for them to finish.
+ */
+template <typename Pool>
+void BM_SubmitBatch(benchmark::State& state) {
+    static constexpr size_t kTasks = 1000;
+
+    Pool pool(static_cast<uint32_t>(state.range(0)));
+    for (auto _ : state) {
+        std::latch done(kTasks);
+        for (size_t i = 0; i < kTasks; i++) {
+            pool.submit([&done]() noexcept { done.count_down(); });
+        }
+
+        done.wait();
+    }
+
+    state.SetItemsProcessed(state.iterations() * kTasks);
+}
+
+/**
+ * @brief A single task fans out into children that are submitted from inside the pool.
+ */
+template <typename Pool>
+void BM_FanOut(benchmark::State& state) {
+    static constexpr size_t kChildren = 1000;
+
+    Pool pool(static_cast<uint32_t>(state.range(0)));
+    for (auto _ : state) {
+        std::latch done(kChildren);
+        pool.submit([&pool, &done]() noexcept {
+            for (size_t i = 0; i < kChildren; i++) {
+                pool.submit([&done]() noexcept { done.count_down(); });
+            }
+        });
+
+        done.wait();
+    }
+
+    state.SetItemsProcessed(state.iterations() * kChildren);
+}
+
+/**
+ * @brief Sum a large range with parallelFor, compared against the same loop on one thread.
+ */
+void BM_ParallelFor(benchmark::State& state) {
+    static constexpr size_t kCount = 1 << 20;
+
+    sm::executor::ThreadPool pool(static_cast<uint32_t>(state.range(0)));
+    std::vector<uint32_t> values(kCount, 1);
+    for (auto _ : state) {
+        std::atomic<uint64_t> total{0};
+        sm::executor::parallelFor(pool, 0, kCount / 1024, [&](size_t block) noexcept {
+            uint64_t sum = 0;
+            for (size_t i = block * 1024; i < (block + 1) * 1024; i++) {
+                sum += values[i];
+            }
+            total.fetch_add(sum, std::memory_order_relaxed);
+        });
+
+        benchmark::DoNotOptimize(total.load());
+    }
+
+    state.SetItemsProcessed(state.iterations() * kCount);
+}
+
+void BM_SerialFor(benchmark::State& state) {
+    static constexpr size_t kCount = 1 << 20;
+
+    std::vector<uint32_t> values(kCount, 1);
+    for (auto _ : state) {
+        uint64_t total = 0;
+        for (size_t i = 0; i < kCount; i++) {
+            total += values[i];
+        }
+
+        benchmark::DoNotOptimize(total);
+    }
+
+    state.SetItemsProcessed(state.iterations() * kCount);
+}
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_SubmitBatch, MutexPool)->ArgName("workers")->Arg(1)->Arg(4)->Arg(16)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_SubmitBatch, sm::executor::ThreadPool)->ArgName("workers")->Arg(1)->Arg(4)->Arg(16)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_FanOut, MutexPool)->ArgName("workers")->Arg(1)->Arg(4)->Arg(16)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_FanOut, sm::executor::ThreadPool)->ArgName("workers")->Arg(1)->Arg(4)->Arg(16)->UseRealTime();
+BENCHMARK(BM_ParallelFor)->ArgName("workers")->Arg(1)->Arg(4)->Arg(16)->UseRealTime();
+BENCHMARK(BM_SerialFor);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,235 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <simcoe/concurrent/parking.hpp>
+#include <simcoe/executor/thread_pool.hpp>
+
+namespace sm::executor::detail {
+// The pool and index of the worker running on this thread.
+inline thread_local const ThreadPool* tCurrentPool = nullptr;
+inline thread_local uint32_t tCurrentWorker = 0;
+
+constexpr uint64_t nextRandom(uint64_t& state) noexcept {
+    // xorshift64
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+} // namespace sm::executor::detail
+
+SM_EXECUTOR_INLINE sm::executor::ThreadPool::ThreadPool(uint32_t workerCount)
+    : mWorkerCount((workerCount == 0) ? (std::max)(std::thread::hardware_concurrency(), 1u) : workerCount)
+    , mInjection(InjectionQueue::create(kInjectionCapacity).value())
+    , mTaskSlots(std::make_unique<detail::TaskSlot[]>(kTaskSlotCount))
+    , mFreeSlots(detail::TaskSlotQueue::create(kTaskSlotCount).value()) {
+    for (uint32_t i = 0; i < kTaskSlotCount; i++) {
+        detail::TaskSlot* slot = &mTaskSlots[i];
+        slot->freeSlots = &mFreeSlots;
+        (void)mFreeSlots.tryPush(slot);
+    }
+
+    mWorkers = std::make_unique<detail::Worker[]>(mWorkerCount);
+    for (uint32_t i = 0; i < mWorkerCount; i++) {
+        mWorkers[i].deque = WorkStealingDeque<Task*>::create().value();
+        mWorkers[i].random = 0x9E3779B97F4A7C15ull * (i + 1);
+    }
+
+    //
+    // Every deque must exist before the first worker starts stealing.
+    //
+    try {
+        for (uint32_t i = 0; i < mWorkerCount; i++) {
+            mWorkers[i].thread = std::thread([this, i] { workerMain(i); });
+        }
+    } catch (...) {
+        stop();
+        throw;
+    }
+}
+
+SM_EXECUTOR_INLINE sm::executor::ThreadPool::~ThreadPool() noexcept {
+    stop();
+}
+
+SM_EXECUTOR_INLINE void sm::executor::ThreadPool::stop() noexcept {
+    mStopping.store(true);
+    mWakeEpoch.fetch_add(1);
+    concurrent::unparkAll(mWakeEpoch);
+
+    for (uint32_t i = 0; i < mWorkerCount; i++) {
+        if (mWorkers[i].thread.joinable()) {
+            mWorkers[i].thread.join();
+        }
+    }
+}
+
+SM_EXECUTOR_INLINE uint32_t sm::executor::ThreadPool::currentWorker() const noexcept {
+    return (detail::tCurrentPool == this) ? detail::tCurrentWorker : mWorkerCount;
+}
+
+SM_EXECUTOR_INLINE void sm::executor::ThreadPool::notify() noexcept {
+    //
+    // Pairs with the fence in workerMain, either the worker sees the new task
+    // after announcing itself or we see the worker and wake it.
+    //
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (mSleepers.load(std::memory_order_relaxed) != 0) {
+        mWakeEpoch.fetch_add(1, std::memory_order_relaxed);
+        concurrent::unparkOne(mWakeEpoch);
+    }
+}
+
+SM_EXECUTOR_INLINE void sm::executor::ThreadPool::schedule(Task* task) noexcept {
+    uint32_t index = currentWorker();
+    if (index != mWorkerCount && mWorkers[index].deque.push(task)) {
+        notify();
+        return;
+    }
+
+    concurrent::SpinWait spin{kInjectionSpin};
+    while (!mInjection.tryPush(task)) {
+        //
+        // The injection queue is full, help drain it rather than wait.
+        //
+        notify();
+        if (tryRunOne()) {
+            spin.reset();
+        } else {
+            spin.spinOnce();
+        }
+    }
+
+    notify();
+}
+
+SM_EXECUTOR_INLINE sm::executor::Task* sm::executor::ThreadPool::takeInjected(detail::Worker* worker) noexcept {
+    if (mInjection.count(std::memory_order_relaxed) == 0) {
+        return nullptr;
+    }
+
+    if (mInjectionBusy.exchange(true, std::memory_order_acquire)) {
+        return nullptr;
+    }
+
+    Task* batch[kInjectionBatch];
+    uint32_t count = mInjection.tryPopN(std::span(batch, (worker != nullptr) ? kInjectionBatch : 1));
+    mInjectionBusy.store(false, std::memory_order_release);
+
+    if (count == 0) {
+        return nullptr;
+    }
+
+    //
+    // Keep the first task and move the rest where other workers can steal them.
+    //
+    for (uint32_t i = 1; i < count; i++) {
+        if (!worker->deque.push(batch[i])) {
+            batch[i]->invoke(batch[i]);
+        }
+    }
+
+    if (count > 1) {
+        notify();
+    }
+
+    return batch[0];
+}
+
+SM_EXECUTOR_INLINE sm::executor::Task* sm::executor::ThreadPool::steal(uint32_t thief, uint64_t& random) noexcept {
+    uint32_t start = static_cast<uint32_t>(detail::nextRandom(random) % mWorkerCount);
+    for (uint32_t i = 0; i < mWorkerCount; i++) {
+        uint32_t victim = (start + i) % mWorkerCount;
+        if (victim == thief) {
+            continue;
+        }
+
+        Task* task = nullptr;
+        if (mWorkers[victim].deque.trySteal(task)) {
+            return task;
+        }
+    }
+
+    return nullptr;
+}
+
+SM_EXECUTOR_INLINE sm::executor::Task* sm::executor::ThreadPool::findTask(uint32_t index) noexcept {
+    detail::Worker& worker = mWorkers[index];
+
+    Task* task = nullptr;
+    if (worker.deque.tryPop(task)) {
+        return task;
+    }
+
+    if ((task = takeInjected(&worker)) != nullptr) {
+        return task;
+    }
+
+    return steal(index, worker.random);
+}
+
+SM_EXECUTOR_INLINE bool sm::executor::ThreadPool::tryRunOne() noexcept {
+    uint32_t index = currentWorker();
+
+    Task* task = nullptr;
+    if (index != mWorkerCount) {
+        task = findTask(index);
+    } else if ((task = takeInjected(nullptr)) == nullptr) {
+        thread_local uint64_t tRandom = 0x2545F4914F6CDD1Dull;
+        task = steal(mWorkerCount, tRandom);
+    }
+
+    if (task == nullptr) {
+        return false;
+    }
+
+    task->invoke(task);
+    return true;
+}
+
+SM_EXECUTOR_INLINE void sm::executor::ThreadPool::workerMain(uint32_t index) noexcept {
+    detail::tCurrentPool = this;
+    detail::tCurrentWorker = index;
+
+    concurrent::SpinWait spin{kIdleSpin};
+    while (true) {
+        if (Task* task = findTask(index)) {
+            task->invoke(task);
+            spin.reset();
+            continue;
+        }
+
+        if (!spin.shouldPark()) {
+            spin.spinOnce();
+            continue;
+        }
+
+        //
+        // Announce that we are about to park and then look for work one last time,
+        // a task submitted after the epoch was read changes it and the park returns immediately.
+        //
+        uint32_t epoch = mWakeEpoch.load();
+        mSleepers.fetch_add(1);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        Task* task = findTask(index);
+        if (task == nullptr) {
+            if (mStopping.load()) {
+                mSleepers.fetch_sub(1);
+                break;
+            }
+
+            concurrent::park(mWakeEpoch, epoch);
+        }
+
+        mSleepers.fetch_sub(1);
+        spin.reset();
+
+        if (task != nullptr) {
+            task->invoke(task);
+        }
+    }
+
+    detail::tCurrentPool = nullptr;
+}
@@ -0,0 +1,27 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#if defined(SM_EXECUTOR_HEADER_ONLY)
+//
+// The implementation is included inline with the headers, nothing is imported or exported.
+//
+#    define SM_EXECUTOR_API
+#    define SM_EXECUTOR_INLINE inline
+#elif defined(SM_EXECUTOR_API_EXPORT)
+#    if defined(_WIN32) || defined(_MSC_VER)
+#        define SM_EXECUTOR_API __declspec(dllexport)
+#    else
+#        define SM_EXECUTOR_API __attribute__((visibility("default")))
+#    endif // defined(_WIN32) || defined(_MSC_VER)
+#else
+#    if defined(_WIN32) || defined(_MSC_VER)
+#        define SM_EXECUTOR_API __declspec(dllimport)
+#    else
+#        define SM_EXECUTOR_API
+#    endif // defined(_WIN32) || defined(_MSC_VER)
+#endif     // SM_EXECUTOR_API_EXPORT
+
+#if !defined(SM_EXECUTOR_INLINE)
+#    define SM_EXECUTOR_INLINE
+#endif
@@ -0,0 +1,171 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <simcoe/concurrent/parking.hpp>
+#include <simcoe/executor/thread_pool.hpp>
+#include <type_traits>
+
+namespace sm::executor {
+namespace detail {
+/**
+ * @brief The state shared by the caller and helpers of a parallelFor.
+ *
+ * Heap allocated and reference counted so that helper tasks which only start after every chunk
+ * has been claimed can still touch it once the caller has returned. The helper tasks are allocated
+ * with the state and handed to ThreadPool::schedule, so starting the helpers cannot fail.
+ */
+template <typename F>
+struct ParallelForState {
+    struct Helper final : Task {
+        ParallelForState* state;
+    };
+
+    std::atomic<size_t> next{0};
+
+    // The number of chunks that have not finished, the caller parks on this word.
+    std::atomic<uint32_t> pending;
+
+    std::atomic<uint32_t> references;
+
+    size_t begin;
+    size_t end;
+    size_t grain;
+    size_t chunks;
+
+    // Only called while a chunk is pending, so it cannot outlive the caller.
+    F* fn;
+
+    uint32_t helperCount;
+
+    static constexpr size_t allocationSize(uint32_t helpers) noexcept {
+        return sizeof(ParallelForState) + sizeof(Helper) * helpers;
+    }
+
+    static void runHelper(Task* self) noexcept {
+        ParallelForState* state = static_cast<Helper*>(self)->state;
+        state->work();
+        state->release();
+    }
+
+    /**
+     * @brief Allocate the state and its helper tasks, the state holds a reference for each helper and the caller.
+     */
+    static ParallelForState* create(size_t begin, size_t end, size_t grain, size_t chunks, uint32_t helpers, F* fn) {
+        static_assert(alignof(Helper) <= alignof(ParallelForState), "Helpers are placed directly after the state");
+
+        void* memory = ::operator new(allocationSize(helpers));
+        auto* state = ::new (memory) ParallelForState{
+            .pending = static_cast<uint32_t>(chunks),
+            .references = helpers + 1,
+            .begin = begin,
+            .end = end,
+            .grain = grain,
+            .chunks = chunks,
+            .fn = fn,
+            .helperCount = helpers,
+        };
+
+        for (uint32_t i = 0; i < helpers; i++) {
+            ::new (static_cast<void*>(state->helper(i))) Helper{{&ParallelForState::runHelper}, state};
+        }
+
+        return state;
+    }
+
+    Helper* helper(uint32_t index) noexcept {
+        return reinterpret_cast<Helper*>(reinterpret_cast<std::byte*>(this) + sizeof(ParallelForState)) + index;
+    }
+
+    void work() noexcept {
+        size_t chunk;
+        while ((chunk = next.fetch_add(1, std::memory_order_relaxed)) < chunks) {
+            size_t first = begin + chunk * grain;
+            size_t last = (std::min)(first + grain, end);
+            for (size_t i = first; i < last; i++) {
+                (*fn)(i);
+            }
+
+            if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                concurrent::unparkAll(pending);
+            }
+        }
+    }
+
+    void release() noexcept {
+        if (references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            size_t size = allocationSize(helperCount);
+            this->~ParallelForState();
+            ::operator delete(static_cast<void*>(this), size);
+        }
+    }
+};
+} // namespace detail
+
+/**
+ * @brief Invoke @p fn for every index in [@p begin, @p end) across the pool.
+ *
+ * The range is split into chunks of @p grain indices that the caller and up to one helper task per
+ * worker claim in turn. The caller works through chunks itself, so it never waits on a task that has
+ * not started and calling parallelFor from inside a task does not deadlock. The only allocation is the
+ * shared state, if it fails nothing has been scheduled.
+ *
+ * @param pool The pool to run helpers on.
+ * @param begin The first index.
+ * @param end One past the last index.
+ * @param fn The function to invoke with each index, must not throw.
+ * @param grain The number of indices in each chunk, 0 picks about four chunks per worker.
+ */
+template <typename F>
+#if __cpp_concepts >= 201907L
+    requires std::is_nothrow_invocable_v<F&, size_t>
+#endif
+void parallelFor(ThreadPool& pool, size_t begin, size_t end, F&& fn, size_t grain = 0) {
+    if (begin >= end) {
+        return;
+    }
+
+    size_t count = end - begin;
+    if (grain == 0) {
+        grain = (std::max)(count / (size_t{pool.workerCount()} * 4), size_t{1});
+    }
+
+    // Keep the chunk count within the pending counter.
+    grain = (std::max)(grain, count / (std::numeric_limits<uint32_t>::max)() + 1);
+
+    size_t chunks = (count + grain - 1) / grain;
+    if (chunks == 1) {
+        for (size_t i = begin; i < end; i++) {
+            fn(i);
+        }
+        return;
+    }
+
+    using State = detail::ParallelForState<std::remove_reference_t<F>>;
+
+    uint32_t helpers = static_cast<uint32_t>((std::min)(chunks - 1, size_t{pool.workerCount()}));
+    State* state = State::create(begin, end, grain, chunks, helpers, &fn);
+
+    for (uint32_t i = 0; i < helpers; i++) {
+        pool.schedule(state->helper(i));
+    }
+
+    state->work();
+
+    //
+    // Every chunk has been claimed, only chunks already running on helpers remain.
+    //
+    uint32_t pending;
+    while ((pending = state->pending.load(std::memory_order_acquire)) != 0) {
+        concurrent::park(state->pending, pending);
+    }
+
+    state->release();
+}
+} // namespace sm::executor
@@ -0,0 +1,247 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <simcoe/concurrent/annotations.hpp>
+#include <simcoe/concurrent/layout.hpp>
+#include <simcoe/concurrent/mpmc_ring_buffer.hpp>
+#include <simcoe/concurrent/ring_buffer.hpp>
+#include <simcoe/concurrent/spin_wait.hpp>
+#include <simcoe/executor/exports.hpp>
+#include <simcoe/executor/work_stealing_deque.hpp>
+#include <simcoe/functional/inplace_function.hpp>
+#include <span>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace sm::executor {
+/**
+ * @brief A unit of work that can be scheduled on a ThreadPool.
+ *
+ * Tasks are intrusive, @p invoke receives the task itself and is responsible for its lifetime.
+ * ThreadPool::submit stores a callable in a task owned by the pool, or wraps it in a heap allocated
+ * task that deletes itself after it runs.
+ */
+struct Task {
+    void (*invoke)(Task* self) noexcept;
+};
+
+/**
+ * @brief The callable stored in a task owned by a ThreadPool, submitting a callable that fits does not allocate.
+ */
+using TaskFunction = functional::InplaceFunction<void() noexcept>;
+
+namespace detail {
+struct TaskSlot;
+
+using TaskSlotQueue = concurrent::MpmcRingBuffer<TaskSlot*>;
+
+/**
+ * @brief A task owned by a ThreadPool, returned to the pool's free slots once it has run.
+ */
+struct TaskSlot final : Task {
+    TaskFunction fn;
+
+    TaskSlotQueue* freeSlots = nullptr;
+
+    TaskSlot() noexcept
+        : Task{&TaskSlot::run} {}
+
+    static void run(Task* self) noexcept {
+        auto* slot = static_cast<TaskSlot*>(self);
+        slot->fn();
+        slot->fn.reset();
+
+        // There is one entry in the queue for every slot, so this never fails.
+        (void)slot->freeSlots->tryPush(slot);
+    }
+};
+
+template <typename F>
+struct FunctionTask final : Task {
+    F fn;
+
+    template <typename U>
+    explicit FunctionTask(U&& function) noexcept(std::is_nothrow_constructible_v<F, U&&>)
+        : Task{&FunctionTask::run}
+        , fn(std::forward<U>(function)) {}
+
+    static void run(Task* self) noexcept {
+        auto* task = static_cast<FunctionTask*>(self);
+        task->fn();
+        delete task;
+    }
+};
+
+struct alignas(concurrent::kCacheLineSize) Worker {
+    WorkStealingDeque<Task*> deque;
+
+    std::thread thread;
+
+    // State of the generator used to pick steal victims, only accessed by the worker.
+    uint64_t random;
+};
+} // namespace detail
+
+/**
+ * @brief A work stealing thread pool.
+ *
+ * Each worker owns a Chase-Lev deque, tasks submitted from a worker are pushed onto its own deque
+ * and other workers steal from the far end of it when they run out of work. Tasks submitted from
+ * other threads go through a RingBuffer injection queue. The ring buffer only supports a single
+ * consumer, so workers take turns draining it with a try lock and move the tasks onto their own
+ * deque where they can be stolen.
+ *
+ * Idle workers back off with a SpinWait for a short while and then park, submitting only pays for a wake when
+ * a worker is parked.
+ *
+ * @code{.cpp}
+ * sm::executor::ThreadPool pool;
+ * pool.submit([]() noexcept { doWork(); });
+ * @endcode
+ */
+class ThreadPool {
+    using InjectionQueue = concurrent::RingBuffer<Task*, std::allocator<Task*>, concurrent::Pow2Capacity, concurrent::CacheAlignedLayout>;
+
+    // The capacity of the injection queue.
+    static constexpr uint32_t kInjectionCapacity = 1024;
+
+    // The number of tasks moved from the injection queue to a worker at once.
+    static constexpr uint32_t kInjectionBatch = 32;
+
+    // The number of tasks owned by the pool that submit stores callables in.
+    static constexpr uint32_t kTaskSlotCount = 1024;
+
+    // How an idle worker backs off between searches for work before parking.
+    static constexpr concurrent::SpinPolicy kIdleSpin{.pauseRounds = 6, .maxPauses = 64, .yieldRounds = 32};
+
+    // How a thread backs off while the injection queue is full and there is no task it can run.
+    static constexpr concurrent::SpinPolicy kInjectionSpin{.pauseRounds = 4, .maxPauses = 32, .yieldRounds = 1};
+
+    //
+    // Read mostly fields.
+    //
+    std::unique_ptr<detail::Worker[]> mWorkers;
+
+    uint32_t mWorkerCount;
+
+    InjectionQueue mInjection;
+
+    std::unique_ptr<detail::TaskSlot[]> mTaskSlots;
+
+    // The slots that are not holding a pending task.
+    detail::TaskSlotQueue mFreeSlots;
+
+    //
+    // Fields written when workers park and wake.
+    //
+    // Set while a worker is consuming the injection queue.
+    alignas(concurrent::kCacheLineSize) std::atomic<bool> mInjectionBusy{false};
+
+    // Incremented to wake parked workers, workers park on this word.
+    alignas(concurrent::kCacheLineSize) std::atomic<uint32_t> mWakeEpoch{0};
+
+    // The number of workers that are about to park or are parked.
+    std::atomic<uint32_t> mSleepers{0};
+
+    std::atomic<bool> mStopping{false};
+
+    SM_EXECUTOR_API SM_EXECUTOR_INLINE void workerMain(uint32_t index) noexcept;
+
+    SM_EXECUTOR_API SM_EXECUTOR_INLINE Task* findTask(uint32_t index) noexcept;
+
+    SM_EXECUTOR_API SM_EXECUTOR_INLINE Task* takeInjected(detail::Worker* worker) noexcept;
+
+    SM_EXECUTOR_API SM_EXECUTOR_INLINE Task* steal(uint32_t thief, uint64_t& random) noexcept;
+
+    SM_EXECUTOR_API SM_EXECUTOR_INLINE void notify() noexcept;
+
+    SM_EXECUTOR_API SM_EXECUTOR_INLINE void stop() noexcept;
+
+    /**
+     * @brief Get the index of the calling worker in this pool.
+     *
+     * @return The index, or the worker count if the caller is not a worker of this pool.
+     */
+    SM_EXECUTOR_API SM_EXECUTOR_INLINE uint32_t currentWorker() const noexcept;
+
+public:
+    /**
+     * @brief Start a thread pool.
+     *
+     * @param workerCount The number of workers, 0 starts one per hardware thread.
+     */
+    SM_EXECUTOR_API SM_EXECUTOR_INLINE explicit ThreadPool(uint32_t workerCount = 0);
+
+    ThreadPool(const ThreadPool& other) = delete;
+    ThreadPool& operator=(const ThreadPool& other) = delete;
+
+    /**
+     * @brief Stop the thread pool.
+     *
+     * Tasks that were submitted before the pool is destroyed still run, no tasks may be submitted
+     * once destruction has started.
+     */
+    SM_EXECUTOR_API SM_EXECUTOR_INLINE ~ThreadPool() noexcept;
+
+    /**
+     * @brief Schedule an intrusive task.
+     *
+     * @param task The task to run, must remain valid until it is invoked.
+     */
+    SM_EXECUTOR_API SM_EXECUTOR_INLINE void schedule(Task* task) noexcept;
+
+    /**
+     * @brief Run a callable on the pool.
+     *
+     * A callable that fits in a TaskFunction is stored in a task owned by the pool and does not allocate,
+     * larger callables, or any callable submitted while every task slot is pending, are heap allocated.
+     *
+     * @param fn The callable to run, invoked once on a worker.
+     */
+    template <typename F>
+#if __cpp_concepts >= 201907L
+        requires std::is_nothrow_invocable_v<std::decay_t<F>&>
+#endif
+    void submit(F&& fn) {
+        using Fn = std::decay_t<F>;
+        if constexpr (TaskFunction::kCanStore<Fn> && std::is_nothrow_constructible_v<Fn, F&&>) {
+            detail::TaskSlot* slot = nullptr;
+            if (mFreeSlots.tryPop(slot)) {
+                slot->fn = std::forward<F>(fn);
+                schedule(slot);
+                return;
+            }
+        }
+
+        schedule(new detail::FunctionTask<Fn>(std::forward<F>(fn)));
+    }
+
+    /**
+     * @brief Run one pending task on the calling thread.
+     *
+     * Workers take from their own deque first, other threads steal from the workers.
+     *
+     * @return true if a task was run, false if no task was found.
+     */
+    SM_EXECUTOR_API SM_EXECUTOR_INLINE bool tryRunOne() noexcept;
+
+    /**
+     * @brief Get the number of workers.
+     *
+     * @return The worker count.
+     */
+    uint32_t workerCount() const noexcept SM_CLANG_NONBLOCKING {
+        return mWorkerCount;
+    }
+};
+} // namespace sm::executor
+
+#if defined(SM_EXECUTOR_HEADER_ONLY)
+#    include <simcoe/executor/detail/thread_pool_impl.hpp>
+#endif
@@ -0,0 +1,341 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <simcoe/concurrent/annotations.hpp>
+#include <simcoe/concurrent/layout.hpp>
+#include <type_traits>
+#include <utility>
+
+namespace sm::executor {
+/**
+ * @brief A Chase-Lev work stealing deque.
+ *
+ * The owning thread pushes and pops at the bottom like a stack, any number of other threads steal from the top.
+ * The owner only synchronizes with thieves when the deque is nearly empty, which keeps pushing and popping
+ * local work cheap. The buffer doubles when it fills, buffers replaced by a resize are kept until the deque
+ * is destroyed because a thief may still be reading from them.
+ *
+ * @tparam T The type of elements stored in the deque, must be trivially copyable and lock free as an atomic,
+ *           such as a pointer to a task.
+ * @tparam Allocator The allocator type used to allocate and deallocate the buffers.
+ *
+ * @cite ChaseLevDeque Dynamic circular work-stealing deque
+ * @cite LeWeakMemoryDeque Correct and efficient work-stealing for weak memory models
+ */
+template <typename T, typename Allocator = std::allocator<T>>
+#if __cpp_concepts >= 201907L
+    requires std::is_trivially_copyable_v<T> && std::atomic<T>::is_always_lock_free && std::is_nothrow_default_constructible_v<Allocator>
+#endif
+class WorkStealingDeque {
+public:
+    using size_type = int64_t;
+    using value_type = T;
+    using allocator_type = Allocator;
+
+private:
+    struct Buffer {
+        std::atomic<T>* elements;
+
+        size_type mask;
+
+        // The buffer this one replaced, kept alive for thieves.
+        Buffer* previous;
+
+        std::atomic<T>& at(size_type index) noexcept SM_CLANG_NONBLOCKING {
+            return elements[index & mask];
+        }
+    };
+
+    using BufferAllocator = std::allocator_traits<Allocator>::template rebind_alloc<Buffer>;
+    using ElementAllocator = std::allocator_traits<Allocator>::template rebind_alloc<std::atomic<T>>;
+
+    //
+    // Read mostly fields.
+    //
+    [[no_unique_address]] Allocator mAllocator{};
+
+    //
+    // Fields written by thieves.
+    //
+    alignas(concurrent::kCacheLineSize) std::atomic<size_type> mTop{};
+
+    //
+    // Fields written by the owner.
+    //
+    alignas(concurrent::kCacheLineSize) std::atomic<size_type> mBottom{};
+
+    std::atomic<Buffer*> mBuffer{};
+
+    Buffer* allocateBuffer(size_type capacity, Buffer* previous) noexcept {
+        BufferAllocator bufferAllocator{mAllocator};
+        ElementAllocator elementAllocator{mAllocator};
+
+        Buffer* buffer = bufferAllocator.allocate(1);
+        if (buffer == nullptr) {
+            return nullptr;
+        }
+
+        std::atomic<T>* elements = elementAllocator.allocate(static_cast<size_t>(capacity));
+        if (elements == nullptr) {
+            bufferAllocator.deallocate(buffer, 1);
+            return nullptr;
+        }
+
+        std::uninitialized_value_construct_n(elements, static_cast<size_t>(capacity));
+        return std::construct_at(buffer, Buffer{elements, capacity - 1, previous});
+    }
+
+    void deallocateBuffers(Buffer* buffer) noexcept {
+        BufferAllocator bufferAllocator{mAllocator};
+        ElementAllocator elementAllocator{mAllocator};
+
+        while (buffer != nullptr) {
+            Buffer* previous = buffer->previous;
+            size_t capacity = static_cast<size_t>(buffer->mask + 1);
+
+            std::destroy_n(buffer->elements, capacity);
+            elementAllocator.deallocate(buffer->elements, capacity);
+            std::destroy_at(buffer);
+            bufferAllocator.deallocate(buffer, 1);
+
+            buffer = previous;
+        }
+    }
+
+    /**
+     * @brief Double the buffer, copying the live elements between @p top and @p bottom.
+     */
+    Buffer* grow(Buffer* buffer, size_type top, size_type bottom) noexcept {
+        Buffer* larger = allocateBuffer((buffer->mask + 1) * 2, buffer);
+        if (larger == nullptr) {
+            return nullptr;
+        }
+
+        for (size_type i = top; i < bottom; i++) {
+            larger->at(i).store(buffer->at(i).load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+
+        mBuffer.store(larger, std::memory_order_release);
+        return larger;
+    }
+
+    // Used by create to allocate the first buffer before the deque exists.
+    explicit WorkStealingDeque(Allocator allocator) noexcept
+        : mAllocator(std::move(allocator)) {}
+
+public:
+    constexpr WorkStealingDeque() noexcept = default;
+
+    WorkStealingDeque(const WorkStealingDeque& other) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque& other) = delete;
+
+    /**
+     * @brief Move construct a deque.
+     *
+     * @note This function is not thread-safe and should only be called when no other threads are accessing the deque.
+     *
+     * @param other The other deque to move from.
+     */
+    WorkStealingDeque(WorkStealingDeque&& other) noexcept
+        : mAllocator(std::move(other.mAllocator))
+        , mTop(other.mTop.exchange(0))
+        , mBottom(other.mBottom.exchange(0))
+        , mBuffer(other.mBuffer.exchange(nullptr)) {}
+
+    /**
+     * @brief Move assign a deque.
+     *
+     * @note This function is not thread-safe and should only be called when no other threads are accessing the deque.
+     *
+     * @param other The other deque to move from.
+     * @return The moved deque.
+     */
+    WorkStealingDeque& operator=(WorkStealingDeque&& other) noexcept {
+        if (this != &other) {
+            deallocateBuffers(mBuffer.load());
+
+            mAllocator = std::move(other.mAllocator);
+            mTop.store(other.mTop.exchange(0));
+            mBottom.store(other.mBottom.exchange(0));
+            mBuffer.store(other.mBuffer.exchange(nullptr));
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Destroy the deque.
+     */
+    ~WorkStealingDeque() noexcept {
+        deallocateBuffers(mBuffer.load());
+    }
+
+    /**
+     * @brief Push a value onto the bottom of the deque.
+     *
+     * Must only be called by the owning thread.
+     *
+     * @param value The value to push.
+     *
+     * @return true if the value was pushed, false if the deque was full and could not grow.
+     */
+    [[nodiscard]]
+    bool push(T value) noexcept {
+        size_type bottom = mBottom.load(std::memory_order_relaxed);
+        size_type top = mTop.load(std::memory_order_acquire);
+        Buffer* buffer = mBuffer.load(std::memory_order_relaxed);
+
+        if (bottom - top > buffer->mask) [[unlikely]] {
+            buffer = grow(buffer, top, bottom);
+            if (buffer == nullptr) {
+                return false;
+            }
+        }
+
+        buffer->at(bottom).store(value, std::memory_order_relaxed);
+        mBottom.store(bottom + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Try to pop the most recently pushed value.
+     *
+     * Must only be called by the owning thread.
+     *
+     * @param value Receives the value if one was popped.
+     *
+     * @return true if a value was popped, false if the deque was empty or a thief took the last value.
+     */
+    [[nodiscard]]
+    bool tryPop(T& value) noexcept SM_CLANG_NONBLOCKING {
+        size_type bottom = mBottom.load(std::memory_order_relaxed) - 1;
+        Buffer* buffer = mBuffer.load(std::memory_order_relaxed);
+        mBottom.store(bottom, std::memory_order_relaxed);
+
+        //
+        // Publishing the smaller bottom before reading top is what stops the owner and a thief
+        // from both taking the last value.
+        //
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        size_type top = mTop.load(std::memory_order_relaxed);
+
+        if (top > bottom) {
+            mBottom.store(bottom + 1, std::memory_order_relaxed);
+            return false;
+        }
+
+        T result = buffer->at(bottom).load(std::memory_order_relaxed);
+        if (top == bottom) {
+            // The last value, race thieves for it.
+            bool won = mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+            mBottom.store(bottom + 1, std::memory_order_relaxed);
+            if (!won) {
+                return false;
+            }
+        }
+
+        value = result;
+        return true;
+    }
+
+    /**
+     * @brief Try to steal the oldest value.
+     *
+     * May be called from any thread.
+     *
+     * @param value Receives the value if one was stolen.
+     *
+     * @return true if a value was stolen, false if the deque was empty or another thread took the value first.
+     */
+    [[nodiscard]]
+    bool trySteal(T& value) noexcept SM_CLANG_NONBLOCKING {
+        size_type top = mTop.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        size_type bottom = mBottom.load(std::memory_order_acquire);
+
+        if (top >= bottom) {
+            return false;
+        }
+
+        Buffer* buffer = mBuffer.load(std::memory_order_acquire);
+        T result = buffer->at(top).load(std::memory_order_relaxed);
+        if (!mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return false;
+        }
+
+        value = result;
+        return true;
+    }
+
+    /**
+     * @brief Get an estimate of the number of values in the deque.
+     *
+     * @warning As this is a lock-free structure the count will be immediately out of date.
+     *
+     * @return The number of values in the deque.
+     */
+    size_type count() const noexcept SM_CLANG_NONBLOCKING {
+        size_type bottom = mBottom.load(std::memory_order_relaxed);
+        size_type top = mTop.load(std::memory_order_relaxed);
+        return (bottom > top) ? bottom - top : 0;
+    }
+
+    /**
+     * @brief Get the number of values the current buffer holds before it grows.
+     *
+     * @return The capacity of the current buffer.
+     */
+    size_type capacity() const noexcept SM_CLANG_NONBLOCKING {
+        return mBuffer.load(std::memory_order_relaxed)->mask + 1;
+    }
+
+    /**
+     * @brief Get the Allocator object used by the deque.
+     *
+     * @return The allocator.
+     */
+    allocator_type getAllocator() const noexcept {
+        return mAllocator;
+    }
+
+    /**
+     * @brief Provided for compatibility with standard containers.
+     *
+     * This is equivalent to `getAllocator()`.
+     *
+     * @return The allocator.
+     */
+    allocator_type get_allocator() const noexcept {
+        return mAllocator;
+    }
+
+    /**
+     * @brief Create a new deque.
+     *
+     * @param capacity The initial capacity, must be a power of 2.
+     * @param allocator The allocator used to allocate and deallocate the buffers.
+     *
+     * @return The deque if it was created successfully, std::nullopt otherwise.
+     */
+    [[nodiscard]]
+    static std::optional<WorkStealingDeque> create(size_type capacity = 64, Allocator allocator = Allocator{}) noexcept {
+        if (capacity <= 0 || (capacity & (capacity - 1)) != 0) {
+            return std::nullopt;
+        }
+
+        WorkStealingDeque deque{std::move(allocator)};
+        Buffer* buffer = deque.allocateBuffer(capacity, nullptr);
+        if (buffer == nullptr) {
+            return std::nullopt;
+        }
+
+        deque.mBuffer.store(buffer);
+        return deque;
+    }
+};
+} // namespace sm::executor
@@ -0,0 +1,209 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <atomic>
+#include <latch>
+#include <thread>
+#include <vector>
+
+#include <simcoe/executor/parallel_for.hpp>
+#include <simcoe/executor/thread_pool.hpp>
+
+class ThreadPoolTest : public testing::TestWithParam<uint32_t> {};
+
+TEST_P(ThreadPoolTest, Submit) {
+    static constexpr size_t kTasks = 10000;
+
+    std::latch done(kTasks);
+    std::atomic<size_t> ran{0};
+    {
+        sm::executor::ThreadPool pool(GetParam());
+        ASSERT_EQ(pool.workerCount(), GetParam());
+
+        for (size_t i = 0; i < kTasks; i++) {
+            pool.submit([&]() noexcept {
+                ran.fetch_add(1);
+                done.count_down();
+            });
+        }
+
+        done.wait();
+    }
+
+    ASSERT_EQ(ran.load(), kTasks);
+}
+
+TEST_P(ThreadPoolTest, DestroyRunsPending) {
+    std::atomic<size_t> ran{0};
+    {
+        sm::executor::ThreadPool pool(GetParam());
+        for (size_t i = 0; i < 5000; i++) {
+            pool.submit([&]() noexcept { ran.fetch_add(1); });
+        }
+    }
+
+    ASSERT_EQ(ran.load(), 5000);
+}
+
+TEST_P(ThreadPoolTest, NestedSubmit) {
+    static constexpr size_t kParents = 100;
+    static constexpr size_t kChildren = 100;
+
+    std::latch done(kParents * kChildren);
+    sm::executor::ThreadPool pool(GetParam());
+    for (size_t i = 0; i < kParents; i++) {
+        pool.submit([&]() noexcept {
+            for (size_t j = 0; j < kChildren; j++) {
+                pool.submit([&]() noexcept { done.count_down(); });
+            }
+        });
+    }
+
+    done.wait();
+}
+
+TEST_P(ThreadPoolTest, ParallelFor) {
+    sm::executor::ThreadPool pool(GetParam());
+
+    std::vector<std::atomic<uint32_t>> hits(100000);
+    sm::executor::parallelFor(pool, 0, hits.size(), [&](size_t i) noexcept { hits[i].fetch_add(1); });
+
+    for (size_t i = 0; i < hits.size(); i++) {
+        ASSERT_EQ(hits[i].load(), 1) << "Index " << i << " was not visited exactly once";
+    }
+}
+
+TEST_P(ThreadPoolTest, NestedParallelFor) {
+    sm::executor::ThreadPool pool(GetParam());
+
+    std::atomic<size_t> total{0};
+    sm::executor::parallelFor(pool, 0, 64, [&](size_t) noexcept {
+        sm::executor::parallelFor(pool, 0, 64, [&](size_t j) noexcept { total.fetch_add(j); }, 4);
+    }, 1);
+
+    ASSERT_EQ(total.load(), 64 * (63 * 64 / 2));
+}
+
+INSTANTIATE_TEST_SUITE_P(ThreadPoolTests, ThreadPoolTest, testing::Values(1, 2, 4));
+
+TEST(ParallelForTest, Empty) {
+    sm::executor::ThreadPool pool(2);
+
+    bool called = false;
+    sm::executor::parallelFor(pool, 10, 10, [&](size_t) noexcept { called = true; });
+    ASSERT_FALSE(called);
+}
+
+TEST(ParallelForTest, HelpersStartAfterReturn) {
+    static constexpr uint32_t kWorkers = 2;
+
+    sm::executor::ThreadPool pool(kWorkers);
+
+    // Keep every worker busy and every task slot pending, so the helpers only start once parallelFor has returned.
+    std::atomic<bool> release{false};
+    std::latch busy(kWorkers);
+    for (uint32_t i = 0; i < kWorkers; i++) {
+        pool.submit([&]() noexcept {
+            busy.count_down();
+            while (!release.load()) {
+                std::this_thread::yield();
+            }
+        });
+    }
+
+    busy.wait();
+    for (size_t i = 0; i < 2000; i++) {
+        pool.submit([]() noexcept {});
+    }
+
+    {
+        std::vector<uint32_t> hits(1000);
+        sm::executor::parallelFor(pool, 0, hits.size(), [&](size_t i) noexcept { hits[i] += 1; });
+
+        for (size_t i = 0; i < hits.size(); i++) {
+            ASSERT_EQ(hits[i], 1) << "Index " << i << " was not visited exactly once";
+        }
+    }
+
+    release.store(true);
+}
+
+TEST(ThreadPoolExternalTest, MoreTasksThanSlots) {
+    static constexpr size_t kTasks = 5000;
+
+    sm::executor::ThreadPool pool(1);
+
+    // Hold the only worker so every task is pending at once, most of them cannot get a slot.
+    std::atomic<bool> release{false};
+    std::latch blocked(1);
+    pool.submit([&]() noexcept {
+        blocked.count_down();
+        while (!release.load()) {
+            std::this_thread::yield();
+        }
+    });
+    blocked.wait();
+
+    std::latch done(kTasks);
+    std::atomic<size_t> ran{0};
+    auto task = [&]() noexcept {
+        ran.fetch_add(1);
+        done.count_down();
+    };
+    static_assert(sm::executor::TaskFunction::kCanStore<decltype(task)>);
+
+    std::thread submitter([&] {
+        for (size_t i = 0; i < kTasks; i++) {
+            pool.submit(task);
+        }
+    });
+
+    // A full injection queue makes the submitter run tasks itself, so this finishes with the worker held.
+    submitter.join();
+    release = true;
+    done.wait();
+
+    ASSERT_EQ(ran.load(), kTasks);
+}
+
+TEST(ThreadPoolExternalTest, LargeTasksRun) {
+    std::latch done(1);
+    sm::executor::ThreadPool pool(1);
+
+    std::array<uint64_t, 16> payload{};
+    payload.back() = 42;
+    static_assert(!sm::executor::TaskFunction::kCanStore<decltype([payload, &done]() noexcept {})>);
+
+    std::atomic<uint64_t> seen{0};
+    pool.submit([payload, &done, &seen]() noexcept {
+        seen = payload.back();
+        done.count_down();
+    });
+
+    done.wait();
+    ASSERT_EQ(seen.load(), 42);
+}
+
+TEST(ThreadPoolExternalTest, TryRunOne) {
+    sm::executor::ThreadPool pool(1);
+
+    // Block the only worker so the task can only be run by this thread.
+    std::atomic<bool> release{false};
+    std::latch blocked(1);
+    pool.submit([&]() noexcept {
+        blocked.count_down();
+        while (!release.load()) {
+            std::this_thread::yield();
+        }
+    });
+    blocked.wait();
+
+    bool ran = false;
+    pool.submit([&]() noexcept { ran = true; });
+    ASSERT_TRUE(pool.tryRunOne());
+    ASSERT_TRUE(ran);
+
+    release = true;
+}
@@ -0,0 +1,128 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <latch>
+#include <thread>
+#include <vector>
+
+#include <simcoe/executor/work_stealing_deque.hpp>
+
+using Deque = sm::executor::WorkStealingDeque<size_t>;
+
+TEST(WorkStealingDequeConstructTest, Pow2) {
+    ASSERT_FALSE(Deque::create(0).has_value());
+    ASSERT_FALSE(Deque::create(3).has_value());
+    ASSERT_TRUE(Deque::create(4).has_value());
+}
+
+TEST(WorkStealingDequeTest, PopIsLifo) {
+    auto deque = Deque::create(4).value();
+    for (size_t i = 0; i < 3; i++) {
+        ASSERT_TRUE(deque.push(i));
+    }
+
+    size_t value = 0;
+    for (size_t i = 3; i > 0; i--) {
+        ASSERT_TRUE(deque.tryPop(value));
+        ASSERT_EQ(value, i - 1);
+    }
+
+    ASSERT_FALSE(deque.tryPop(value));
+}
+
+TEST(WorkStealingDequeTest, StealIsFifo) {
+    auto deque = Deque::create(4).value();
+    for (size_t i = 0; i < 3; i++) {
+        ASSERT_TRUE(deque.push(i));
+    }
+
+    size_t value = 0;
+    for (size_t i = 0; i < 3; i++) {
+        ASSERT_TRUE(deque.trySteal(value));
+        ASSERT_EQ(value, i);
+    }
+
+    ASSERT_FALSE(deque.trySteal(value));
+}
+
+TEST(WorkStealingDequeTest, Grow) {
+    auto deque = Deque::create(2).value();
+
+    // Offset top from zero so the copy has to follow the mask.
+    size_t value = 0;
+    ASSERT_TRUE(deque.push(100));
+    ASSERT_TRUE(deque.trySteal(value));
+
+    for (size_t i = 0; i < 100; i++) {
+        ASSERT_TRUE(deque.push(i));
+    }
+
+    ASSERT_GE(deque.capacity(), 100);
+    ASSERT_EQ(deque.count(), 100);
+
+    for (size_t i = 0; i < 50; i++) {
+        ASSERT_TRUE(deque.trySteal(value));
+        ASSERT_EQ(value, i);
+    }
+
+    for (size_t i = 100; i > 50; i--) {
+        ASSERT_TRUE(deque.tryPop(value));
+        ASSERT_EQ(value, i - 1);
+    }
+
+    ASSERT_EQ(deque.count(), 0);
+}
+
+TEST(WorkStealingDequeThreadTest, OwnerAndThieves) {
+    static constexpr size_t kThieves = 3;
+    static constexpr size_t kValues = 100000;
+
+    auto deque = Deque::create(16).value();
+    std::vector<std::atomic<uint32_t>> seen(kValues);
+    std::atomic<size_t> taken{0};
+    std::latch start(kThieves + 1);
+
+    std::vector<std::jthread> thieves;
+    for (size_t t = 0; t < kThieves; t++) {
+        thieves.emplace_back([&] {
+            start.arrive_and_wait();
+            while (taken.load() < kValues) {
+                size_t value = 0;
+                if (deque.trySteal(value)) {
+                    seen[value].fetch_add(1);
+                    taken.fetch_add(1);
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    start.arrive_and_wait();
+    for (size_t i = 0; i < kValues; i++) {
+        ASSERT_TRUE(deque.push(i));
+
+        // Pop some back so the owner and thieves race for the last value.
+        size_t value = 0;
+        if (i % 3 == 0 && deque.tryPop(value)) {
+            seen[value].fetch_add(1);
+            taken.fetch_add(1);
+        }
+    }
+
+    size_t value = 0;
+    while (taken.load() < kValues) {
+        if (deque.tryPop(value)) {
+            seen[value].fetch_add(1);
+            taken.fetch_add(1);
+        }
+    }
+
+    thieves.clear();
+
+    for (size_t i = 0; i < kValues; i++) {
+        ASSERT_EQ(seen[i].load(), 1) << "Value " << i << " was not taken exactly once";
+    }
+}
@@ -0,0 +1,32 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <simcoe/functional/inplace_function.hpp>
+
+namespace {
+/**
+ * @brief Store, move, and call a callable that captures 40 bytes, as a queued task would.
+ */
+template <typename Function>
+void BM_StoreMoveInvoke(benchmark::State& state) {
+    std::array<uint64_t, 5> capture{1, 2, 3, 4, 5};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(capture);
+        Function function = [capture]() noexcept {
+            benchmark::DoNotOptimize(capture);
+        };
+
+        Function moved = std::move(function);
+        moved();
+    }
+}
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_StoreMoveInvoke, std::function<void()>);
+BENCHMARK_TEMPLATE(BM_StoreMoveInvoke, sm::functional::InplaceFunction<void() noexcept>);
+
+BENCHMARK_MAIN();
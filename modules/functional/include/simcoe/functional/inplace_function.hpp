@@ -0,0 +1,201 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace sm::functional {
+/**
+ * @brief The default inline capacity of an InplaceFunction, in bytes.
+ */
+inline constexpr size_t kInplaceFunctionCapacity = 48;
+
+namespace detail {
+template <bool Noexcept, typename R, typename... Args>
+struct InplaceVTable {
+    R (*invoke)(void* storage, Args&&... args) noexcept(Noexcept);
+
+    // Move construct the callable into the destination and destroy the source.
+    void (*relocate)(void* destination, void* source) noexcept;
+
+    void (*destroy)(void* storage) noexcept;
+};
+
+template <typename F, bool Noexcept, typename R, typename... Args>
+inline constexpr InplaceVTable<Noexcept, R, Args...> kInplaceVTable = {
+    .invoke = [](void* storage, Args&&... args) noexcept(Noexcept) -> R {
+        return std::invoke(*static_cast<F*>(storage), std::forward<Args>(args)...);
+    },
+    .relocate = [](void* destination, void* source) noexcept {
+        F* callable = static_cast<F*>(source);
+        ::new (destination) F(std::move(*callable));
+        callable->~F();
+    },
+    .destroy = [](void* storage) noexcept {
+        static_cast<F*>(storage)->~F();
+    },
+};
+} // namespace detail
+
+template <typename Signature, size_t Capacity = kInplaceFunctionCapacity, size_t Alignment = alignof(std::max_align_t)>
+class InplaceFunction;
+
+/**
+ * @brief A move only function wrapper that stores its callable inline and never allocates.
+ *
+ * The callable is stored in a buffer of @p Capacity bytes inside the wrapper, a callable that does not fit
+ * or needs stricter alignment than @p Alignment fails to compile rather than falling back to the heap.
+ * Moving a wrapper moves the callable, which must be nothrow move constructible, so the wrapper itself is
+ * always nothrow move constructible and can be stored in the queues of the concurrent module.
+ *
+ * @code{.cpp}
+ * sm::functional::InplaceFunction<void() noexcept> task = [buffer = std::move(buffer)]() noexcept {
+ *     process(buffer);
+ * };
+ *
+ * task();
+ * @endcode
+ *
+ * @tparam R The return type.
+ * @tparam Args The argument types.
+ * @tparam Noexcept Whether the signature is noexcept, only nothrow invocable callables are accepted if it is.
+ * @tparam Capacity The size of the inline buffer in bytes.
+ * @tparam Alignment The alignment of the inline buffer.
+ */
+template <typename R, typename... Args, bool Noexcept, size_t Capacity, size_t Alignment>
+class InplaceFunction<R(Args...) noexcept(Noexcept), Capacity, Alignment> {
+    using VTable = detail::InplaceVTable<Noexcept, R, Args...>;
+
+    template <typename F>
+    static constexpr bool kInvocable = Noexcept ? std::is_nothrow_invocable_r_v<R, F&, Args...> : std::is_invocable_r_v<R, F&, Args...>;
+
+    alignas(Alignment) std::byte mStorage[(Capacity > 0) ? Capacity : 1];
+
+    const VTable* mVTable{nullptr};
+
+public:
+    /**
+     * @brief Check if a callable type can be stored without exceeding the inline buffer.
+     *
+     * @tparam F The callable type.
+     */
+    template <typename F>
+    static constexpr bool kCanStore = sizeof(F) <= Capacity && alignof(F) <= Alignment && std::is_nothrow_move_constructible_v<F>;
+
+    constexpr InplaceFunction() noexcept = default;
+
+    constexpr InplaceFunction(std::nullptr_t) noexcept {}
+
+    /**
+     * @brief Store a callable.
+     *
+     * @param fn The callable to store, must fit in the inline buffer and be nothrow move constructible.
+     */
+    template <typename F>
+#if __cpp_concepts >= 201907L
+        requires(!std::is_same_v<std::remove_cvref_t<F>, InplaceFunction>) && kInvocable<std::decay_t<F>>
+#endif
+    InplaceFunction(F&& fn) noexcept(std::is_nothrow_constructible_v<std::decay_t<F>, F&&>) {
+        using Fn = std::decay_t<F>;
+        static_assert(sizeof(Fn) <= Capacity, "the callable does not fit in the inline buffer, increase the capacity or capture less");
+        static_assert(alignof(Fn) <= Alignment, "the callable needs stricter alignment than the inline buffer provides");
+        static_assert(std::is_nothrow_move_constructible_v<Fn>, "the callable must be nothrow move constructible");
+
+        ::new (static_cast<void*>(mStorage)) Fn(std::forward<F>(fn));
+        mVTable = &detail::kInplaceVTable<Fn, Noexcept, R, Args...>;
+    }
+
+    InplaceFunction(const InplaceFunction& other) = delete;
+    InplaceFunction& operator=(const InplaceFunction& other) = delete;
+
+    /**
+     * @brief Move construct a function, leaving @p other empty.
+     *
+     * @param other The function to move from.
+     */
+    InplaceFunction(InplaceFunction&& other) noexcept {
+        if (other.mVTable != nullptr) {
+            other.mVTable->relocate(mStorage, other.mStorage);
+            mVTable = std::exchange(other.mVTable, nullptr);
+        }
+    }
+
+    /**
+     * @brief Move assign a function, leaving @p other empty.
+     *
+     * @param other The function to move from.
+     * @return This function.
+     */
+    InplaceFunction& operator=(InplaceFunction&& other) noexcept {
+        if (this != &other) {
+            reset();
+            if (other.mVTable != nullptr) {
+                other.mVTable->relocate(mStorage, other.mStorage);
+                mVTable = std::exchange(other.mVTable, nullptr);
+            }
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Replace the stored callable.
+     *
+     * @param fn The callable to store.
+     * @return This function.
+     */
+    template <typename F>
+#if __cpp_concepts >= 201907L
+        requires(!std::is_same_v<std::remove_cvref_t<F>, InplaceFunction>) && kInvocable<std::decay_t<F>>
+#endif
+    InplaceFunction& operator=(F&& fn) noexcept(std::is_nothrow_constructible_v<std::decay_t<F>, F&&>) {
+        return *this = InplaceFunction(std::forward<F>(fn));
+    }
+
+    InplaceFunction& operator=(std::nullptr_t) noexcept {
+        reset();
+        return *this;
+    }
+
+    ~InplaceFunction() noexcept {
+        reset();
+    }
+
+    /**
+     * @brief Destroy the stored callable, leaving the function empty.
+     */
+    void reset() noexcept {
+        if (mVTable != nullptr) {
+            std::exchange(mVTable, nullptr)->destroy(mStorage);
+        }
+    }
+
+    /**
+     * @brief Invoke the stored callable.
+     *
+     * @pre The function is not empty.
+     *
+     * @param args The arguments to forward to the callable.
+     * @return The result of the callable.
+     */
+    R operator()(Args... args) noexcept(Noexcept) {
+        return mVTable->invoke(mStorage, std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Check if the function holds a callable.
+     *
+     * @return true if the function is not empty.
+     */
+    explicit operator bool() const noexcept {
+        return mVTable != nullptr;
+    }
+
+    friend bool operator==(const InplaceFunction& function, std::nullptr_t) noexcept {
+        return function.mVTable == nullptr;
+    }
+};
+} // namespace sm::functional
@@ -0,0 +1,136 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <memory>
+#include <string>
+#include <type_traits>
+
+#include <simcoe/functional/inplace_function.hpp>
+
+using sm::functional::InplaceFunction;
+
+namespace {
+struct Counted {
+    int* alive;
+
+    explicit Counted(int* counter) noexcept
+        : alive(counter) {
+        *alive += 1;
+    }
+
+    Counted(Counted&& other) noexcept
+        : alive(other.alive) {
+        *alive += 1;
+    }
+
+    ~Counted() noexcept {
+        *alive -= 1;
+    }
+
+    int operator()() const noexcept { return 1; }
+};
+
+int twice(int value) {
+    return value * 2;
+}
+} // namespace
+
+static_assert(std::is_nothrow_move_constructible_v<InplaceFunction<void()>>);
+static_assert(std::is_nothrow_move_assignable_v<InplaceFunction<void()>>);
+static_assert(std::is_nothrow_destructible_v<InplaceFunction<void()>>);
+static_assert(!std::is_copy_constructible_v<InplaceFunction<void()>>);
+static_assert(std::is_nothrow_invocable_v<InplaceFunction<void() noexcept>&>);
+static_assert(!std::is_nothrow_invocable_v<InplaceFunction<void()>&>);
+
+using Small = InplaceFunction<void(), 16>;
+static_assert(Small::kCanStore<std::array<char, 16>>);
+static_assert(!Small::kCanStore<std::array<char, 17>>);
+
+// Callables that may throw do not match a noexcept signature.
+static_assert(!std::is_constructible_v<InplaceFunction<void() noexcept>, void (*)()>);
+static_assert(std::is_constructible_v<InplaceFunction<void() noexcept>, void (*)() noexcept>);
+
+TEST(InplaceFunctionTest, Empty) {
+    InplaceFunction<void()> function;
+    ASSERT_FALSE(function);
+    ASSERT_TRUE(function == nullptr);
+
+    InplaceFunction<void()> null = nullptr;
+    ASSERT_FALSE(null);
+}
+
+TEST(InplaceFunctionTest, Invoke) {
+    int calls = 0;
+    InplaceFunction<void() noexcept> function = [&calls]() noexcept { calls += 1; };
+    ASSERT_TRUE(function);
+
+    function();
+    function();
+    ASSERT_EQ(calls, 2);
+}
+
+TEST(InplaceFunctionTest, ArgumentsAndResult) {
+    InplaceFunction<int(int)> function = twice;
+    ASSERT_EQ(function(21), 42);
+
+    InplaceFunction<std::string(std::string, const std::string&)> concat = [](std::string lhs, const std::string& rhs) {
+        return lhs + rhs;
+    };
+    ASSERT_EQ(concat("hello ", "world"), "hello world");
+}
+
+TEST(InplaceFunctionTest, MoveOnlyCapture) {
+    auto value = std::make_unique<int>(7);
+    InplaceFunction<int()> function = [value = std::move(value)] { return *value; };
+    ASSERT_EQ(function(), 7);
+
+    InplaceFunction<int()> moved = std::move(function);
+    ASSERT_FALSE(function);
+    ASSERT_EQ(moved(), 7);
+}
+
+TEST(InplaceFunctionTest, Lifetime) {
+    int alive = 0;
+
+    {
+        InplaceFunction<int() noexcept> function = Counted{&alive};
+        ASSERT_EQ(alive, 1);
+
+        InplaceFunction<int() noexcept> moved = std::move(function);
+        ASSERT_EQ(alive, 1);
+        ASSERT_EQ(moved(), 1);
+
+        moved = nullptr;
+        ASSERT_EQ(alive, 0);
+
+        moved = Counted{&alive};
+        ASSERT_EQ(alive, 1);
+
+        function = std::move(moved);
+        ASSERT_EQ(alive, 1);
+        ASSERT_FALSE(moved);
+    }
+
+    ASSERT_EQ(alive, 0);
+}
+
+TEST(InplaceFunctionTest, Reassign) {
+    InplaceFunction<int()> function = [] { return 1; };
+    ASSERT_EQ(function(), 1);
+
+    function = [] { return 2; };
+    ASSERT_EQ(function(), 2);
+
+    function.reset();
+    ASSERT_FALSE(function);
+}
+
+TEST(InplaceFunctionTest, FullCapacity) {
+    std::array<char, sm::functional::kInplaceFunctionCapacity> bytes{};
+    bytes.back() = 'x';
+
+    InplaceFunction<char()> function = [bytes] { return bytes.back(); };
+    ASSERT_EQ(function(), 'x');
+}